@@ -4,41 +4,86 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../code/app_config.c \
 ../code/app_init.c \
 ../code/app_process.c \
 ../code/ble_bass.c \
 ../code/ble_custom.c \
 ../code/ble_std.c \
 ../code/calibration.c \
+../code/eddystone_tlm.c \
+../code/eddystone_tlm_frame.c \
+../code/flash_kv.c \
+../code/flash_kv_port.c \
+../code/history.c \
+../code/history_download.c \
 ../code/i2c.c \
-../code/nct375.c 
+../code/job_schedule.c \
+../code/nct375.c \
+../code/pad_policy.c \
+../code/pad_policy_table.c \
+../code/periph_retention.c \
+../code/retained_state.c \
+../code/sample_wake.c \
+../code/sensor_power.c \
+../code/wake_profile.c 
 
 S_UPPER_SRCS += \
 ../code/wakeup_asm.S 
 
 OBJS += \
+./code/app_config.o \
 ./code/app_init.o \
 ./code/app_process.o \
 ./code/ble_bass.o \
 ./code/ble_custom.o \
 ./code/ble_std.o \
 ./code/calibration.o \
+./code/eddystone_tlm.o \
+./code/eddystone_tlm_frame.o \
+./code/flash_kv.o \
+./code/flash_kv_port.o \
+./code/history.o \
+./code/history_download.o \
 ./code/i2c.o \
+./code/job_schedule.o \
 ./code/nct375.o \
+./code/pad_policy.o \
+./code/pad_policy_table.o \
+./code/periph_retention.o \
+./code/retained_state.o \
+./code/sample_wake.o \
+./code/sensor_power.o \
+./code/wake_profile.o \
 ./code/wakeup_asm.o 
 
 S_UPPER_DEPS += \
 ./code/wakeup_asm.d 
 
 C_DEPS += \
+./code/app_config.d \
 ./code/app_init.d \
 ./code/app_process.d \
 ./code/ble_bass.d \
 ./code/ble_custom.d \
 ./code/ble_std.d \
 ./code/calibration.d \
+./code/eddystone_tlm.d \
+./code/eddystone_tlm_frame.d \
+./code/flash_kv.d \
+./code/flash_kv_port.d \
+./code/history.d \
+./code/history_download.d \
 ./code/i2c.d \
-./code/nct375.d 
+./code/job_schedule.d \
+./code/nct375.d \
+./code/pad_policy.d \
+./code/pad_policy_table.d \
+./code/periph_retention.d \
+./code/retained_state.d \
+./code/sample_wake.d \
+./code/sensor_power.d \
+./code/wake_profile.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -16,34 +16,37 @@
 
 #include "include/app.h"
 
-#ifdef ONE_SHOT_MODE
-	OneShotMode_t OneShotMode[2] = {NCT375_ONEShot_StartSample,  NCT375_ONEShot_ReadSample};
-	volatile int seq = 0;
-#endif
-
 int main() {
 
 	App_Initialize();
 
 	/* Power NCT375 */
-#ifdef ONE_SHOT_MODE
+#if (SENSOR_POWER_GATING)
+	/* Power-on defaults, the supply is switched by the sequencer (see
+	 * sensor_power.h) */
+#elif defined(ONE_SHOT_MODE)
     NCT375_ONEShot_ModeOn();
 #else
     NCT375_PowerUp();
+#ifdef ALARM_MODE
+    NCT375_Alarm_Configure();
+#endif
 #endif
 
-	/* Turn LED on */
-	Sys_DIO_Config(LED_DIO, DIO_MODE_GPIO_OUT_1);
-
-	/* Disable DIO4 and DIO5 to avoid current consumption on VDDO */
-	Sys_DIO_Config(4, DIO_MODE_DISABLE | DIO_NO_PULL);
-	Sys_DIO_Config(5, DIO_MODE_DISABLE | DIO_NO_PULL);
+	/* Apply the wake state of the pads (LED, unused DIOs, see
+	 * pad_policy.h) */
+	Pad_Policy_Wake();
 
-	/* Wait for 3 seconds to allow re-flashing directly after pressing RESET */
-	Sys_Delay_ProgramROM(3 * SystemCoreClock);
+	/* Wait for 3 seconds to allow re-flashing directly after pressing RESET;
+	 * not needed when resuming from the retained state (RECOVERY_DIO can
+	 * still be used to pause the program) */
+	if (!retained_state_warm) {
+		Sys_Delay_ProgramROM(3 * SystemCoreClock);
+	}
 
-	/* If the source clock is RC oscillator, measure and update its period */
-	if (RTC_CLK_SRC == RTC_CLK_SRC_RC_OSC) {
+	/* If the source clock is RC oscillator, measure and update its period
+	 * unless the period measured before the reset has been resumed */
+	if (RTC_CLK_SRC == RTC_CLK_SRC_RC_OSC && !RETAINED_RC_PERIOD_VALID()) {
 		/* Start period counter to start period measurement */
 		AUDIOSINK_CTRL->PERIOD_CNT_START_ALIAS = 1;
 
@@ -59,65 +62,65 @@ int main() {
 /* ----------------------------------------------------------------------------
  * Function      : Main_Loop(void)
  * ----------------------------------------------------------------------------
- * Description   : - Run the kernel scheduler
- *                 - Update the battery voltage when applicable
- *                 - Update custom service data when applicable
+ * Description   : - Restore the I2C interface and start the asynchronous
+ *                   jobs, if not done while waiting for BLE to wake up
+ *                 - Run the periodic jobs selected for this wake-up (sensor,
+ *                   battery, RC calibration, custom service data and
+ *                   advertising update)
+ *                 - Run the kernel scheduler
  *                 - Attempt to go to sleep mode if possible
  * Inputs        : None
  * Outputs       : None
  * Assumptions   : None
  * ------------------------------------------------------------------------- */
 void Main_Loop(void) {
+	bool idle;
+
 	Sys_Watchdog_Refresh();
 
-	if ((cs_env.sentSuccess == 1) && (app_env.sleep_cycles % 20 == 0)) {
-		cs_env.sentSuccess = 0;
-		cs_env.tx_value_changed = 1;
-	}
 	(app_env.sleep_cycles)++;
+	ble_env.adv_count++;
 
-	if (ble_env.adv_count % 10 == 0) {
-		/* Configure ADC channel 0 to measure VBAT/2 */
-		Sys_ADC_Set_Config(
-				ADC_VBAT_DIV2_NORMAL | ADC_CONTINUOUS | ADC_PRESCALE_6400);
-		Sys_ADC_InputSelectConfig(0,
-				(ADC_NEG_INPUT_GND | ADC_POS_INPUT_VBAT_DIV2));
-
-		/* Wait for ADC to measure voltage */
-		Sys_Delay_ProgramROM(8*6500);
-		/* Read the battery level and update the average value */
-		Measure_Battery_Level();
+	/* Start the asynchronous jobs of this wake-up, unless this has been
+	 * done during the BLE wake-up wait, and sleep until all of them
+	 * have completed */
+	if (!app_env.jobs_started) {
+		App_Jobs_Begin();
 	}
-	ble_env.adv_count++;
-	ble_env.i2c_tx_buffer[0] = 0x00;
-
-	/* Configure I2C Interface */
-	I2C_Master_Init(0x80U);
-	Sys_I2C_DIOConfig(DIO_6X_DRIVE | DIO_LPF_ENABLE | DIO_STRONG_PULL_UP,
-			I2C_SCL_DIO_NUM, I2C_SDA_DIO_NUM);
-#ifdef ONE_SHOT_MODE
-	OneShotMode[seq]();
-	seq=(seq+1)%2;
-	NCT375_I2C_Delay();
-#else
-	I2C_WriteRead(0x48, ble_env.i2c_tx_buffer, 1, ble_env.i2c_rx_buffer, 2,
-			NCT375_Received_Temperature);
+	app_env.jobs_started = false;
+	App_Jobs_Join();
+	WAKE_PROFILE_MARK(WAKE_PHASE_JOBS_ASYNC);
+
+	Job_Schedule_Finish(&app_jobs, app_env.jobs_due);
+#if (SENSOR_POWER_GATING)
+	/* Switch the sensor supply for the coming sleep period */
+	Sensor_Power_Sequence();
 #endif
-	Advertising_Update();
+	WAKE_PROFILE_MARK(WAKE_PHASE_JOBS_SYNC);
 
-	Sys_DIO_Config(LED_DIO, DIO_MODE_GPIO_OUT_0);
 	while (true) {
 		Kernel_Schedule();
 
 		Sys_Watchdog_Refresh();
 
-		Sys_DIO_Config(LED_DIO, DIO_MODE_GPIO_OUT_0);
+		/* Wake up the sampling lead time before the next event only if it
+		 * is an advertising event */
+		App_Sample_Lead_Update();
+
+		/* Put the pads in their sleep state only if no kernel event is
+		 * pending (the stack does not sleep otherwise), and back in their
+		 * wake state if the system did not go to sleep */
+		WAKE_PROFILE_MARK(WAKE_PHASE_SCHEDULE);
 		GLOBAL_INT_DISABLE();
+		idle = ke_sleep_check();
+		if (idle) {
+			Pad_Policy_Sleep();
+		}
 		BLE_Power_Mode_Enter(&sleep_mode_env, POWER_MODE_SLEEP);
 		GLOBAL_INT_RESTORE();
-
-		/* Turn LED on */
-		Sys_DIO_Config(LED_DIO, DIO_MODE_GPIO_OUT_1);
+		if (idle) {
+			Pad_Policy_Wake();
+		}
 	}
 
 	/* Wait for an interrupt before executing the scheduler again */
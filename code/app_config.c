@@ -0,0 +1,203 @@
+/* ----------------------------------------------------------------------------
+ * app_config.c
+ * - Runtime configuration of the advertising and sampling parameters
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+struct app_config_tag app_config;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint16_t App_Config_Wakes(uint16_t period)
+ * ----------------------------------------------------------------------------
+ * Description   : Convert a period into a number of advertising wake-ups
+ * Inputs        : - period     - Period in s
+ * Outputs       : return value - Period in wake-ups, at least 1
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint16_t App_Config_Wakes(uint16_t period)
+{
+    uint32_t wakes = (uint32_t)period * 1000 / app_config.adv_interval;
+
+    if (wakes == 0)
+    {
+        return 1;
+    }
+
+    return (wakes < UINT16_MAX) ? (uint16_t)wakes : UINT16_MAX;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void App_Config_Defaults(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Load the build defaults
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void App_Config_Defaults(void)
+{
+    _Static_assert(APP_CONFIG_ADV_INTERVAL_DFLT >=
+                   APP_CONFIG_ADV_INTERVAL_MIN &&
+                   APP_CONFIG_ADV_INTERVAL_DFLT <=
+                   APP_CONFIG_ADV_INTERVAL_MAX,
+                   "default advertising interval out of range");
+    _Static_assert(APP_CONFIG_TX_POWER_DFLT >=
+                   APP_CONFIG_TX_POWER_MIN &&
+                   APP_CONFIG_TX_POWER_DFLT <=
+                   APP_CONFIG_TX_POWER_MAX,
+                   "default RF output power out of range");
+    _Static_assert(APP_CONFIG_SAMPLE_PERIOD_DFLT >=
+                   APP_CONFIG_SAMPLE_PERIOD_MIN &&
+                   APP_CONFIG_SAMPLE_PERIOD_DFLT <=
+                   APP_CONFIG_SAMPLE_PERIOD_MAX,
+                   "default sampling period out of range");
+    _Static_assert(APP_CONFIG_BATT_PERIOD_DFLT >=
+                   APP_CONFIG_BATT_PERIOD_MIN &&
+                   APP_CONFIG_BATT_PERIOD_DFLT <=
+                   APP_CONFIG_BATT_PERIOD_MAX,
+                   "default battery measurement period out of range");
+
+    app_config.adv_interval = APP_CONFIG_ADV_INTERVAL_DFLT;
+    app_config.tx_power = APP_CONFIG_TX_POWER_DFLT;
+    app_config.sample_period = APP_CONFIG_SAMPLE_PERIOD_DFLT;
+    app_config.batt_period = APP_CONFIG_BATT_PERIOD_DFLT;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool App_Config_Validate(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Check a restored configuration against the ranges accepted
+ *                 by App_Config_Command, and load the build defaults if a
+ *                 parameter is out of range
+ * Inputs        : None
+ * Outputs       : return value - false if the defaults have been loaded
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+bool App_Config_Validate(void)
+{
+    /* A zero advertising interval would also divide by zero in
+     * App_Config_Wakes */
+    if (app_config.adv_interval >= APP_CONFIG_ADV_INTERVAL_MIN &&
+        app_config.adv_interval <= APP_CONFIG_ADV_INTERVAL_MAX &&
+        app_config.tx_power >= APP_CONFIG_TX_POWER_MIN &&
+        app_config.tx_power <= APP_CONFIG_TX_POWER_MAX &&
+        app_config.sample_period >= APP_CONFIG_SAMPLE_PERIOD_MIN &&
+        app_config.sample_period <= APP_CONFIG_SAMPLE_PERIOD_MAX &&
+        app_config.batt_period >= APP_CONFIG_BATT_PERIOD_MIN &&
+        app_config.batt_period <= APP_CONFIG_BATT_PERIOD_MAX)
+    {
+        return true;
+    }
+
+    App_Config_Defaults();
+
+    return false;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void App_Config_Apply(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Apply the configuration: advertising interval (advertising
+ *                 is restarted only if the interval changes), RF output power
+ *                 and periods of the sensor and battery jobs
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The job scheduler has been initialized
+ * ------------------------------------------------------------------------- */
+void App_Config_Apply(void)
+{
+    Advertising_Set_Interval(APP_CONFIG_ADV_INT());
+    Sys_RFFE_SetTXPower(app_config.tx_power);
+
+#if (SAMPLE_WAKE)
+    Sample_Wake_Configure();
+#else
+    Job_Schedule_Set_Period(&app_jobs, Sensor_Job,
+                            App_Config_Wakes(app_config.sample_period));
+#endif
+    Job_Schedule_Set_Period(&app_jobs, Battery_Measure_Start,
+                            App_Config_Wakes(app_config.batt_period));
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t App_Config_Command(const uint8_t *value,
+ *                                           uint16_t length)
+ * ----------------------------------------------------------------------------
+ * Description   : Handle a write to the RX value: set a parameter or restore
+ *                 the defaults, then apply and retain the configuration
+ * Inputs        : - value      - Value written
+ *                 - length     - Length of the value
+ * Outputs       : return value - ATT status of the write
+ * Assumptions   : Values that are not configuration commands are accepted
+ *                 and ignored
+ * ------------------------------------------------------------------------- */
+uint8_t App_Config_Command(const uint8_t *value, uint16_t length)
+{
+    uint16_t val;
+
+    if (length == 1 && value[0] == APP_CONFIG_CMD_DEFAULTS)
+    {
+        App_Config_Defaults();
+    }
+    else if (length == 4 && value[0] == APP_CONFIG_CMD_SET)
+    {
+        val = (uint16_t)(value[2] | value[3] << 8);
+        switch (value[1])
+        {
+            case APP_CONFIG_ADV_INTERVAL:
+            {
+                if (val < APP_CONFIG_ADV_INTERVAL_MIN ||
+                    val > APP_CONFIG_ADV_INTERVAL_MAX)
+                {
+                    return APP_CONFIG_ERR_OUT_OF_RANGE;
+                }
+                app_config.adv_interval = val;
+            }
+            break;
+            case APP_CONFIG_TX_POWER:
+            {
+                if ((int16_t)val < APP_CONFIG_TX_POWER_MIN ||
+                    (int16_t)val > APP_CONFIG_TX_POWER_MAX)
+                {
+                    return APP_CONFIG_ERR_OUT_OF_RANGE;
+                }
+                app_config.tx_power = (int8_t)val;
+            }
+            break;
+            case APP_CONFIG_SAMPLE_PERIOD:
+            {
+                if (val < APP_CONFIG_SAMPLE_PERIOD_MIN ||
+                    val > APP_CONFIG_SAMPLE_PERIOD_MAX)
+                {
+                    return APP_CONFIG_ERR_OUT_OF_RANGE;
+                }
+                app_config.sample_period = val;
+            }
+            break;
+            case APP_CONFIG_BATT_PERIOD:
+            {
+                if (val < APP_CONFIG_BATT_PERIOD_MIN ||
+                    val > APP_CONFIG_BATT_PERIOD_MAX)
+                {
+                    return APP_CONFIG_ERR_OUT_OF_RANGE;
+                }
+                app_config.batt_period = val;
+            }
+            break;
+            default:
+            {
+                return APP_CONFIG_ERR_UNKNOWN;
+            }
+        }
+    }
+    else
+    {
+        return GAP_ERR_NO_ERROR;
+    }
+
+    App_Config_Apply();
+    Retained_State_Save();
+
+    return GAP_ERR_NO_ERROR;
+}
@@ -159,15 +159,17 @@ void App_Initialize(void) {
 	ADC_POS_INPUT_VBAT_DIV2));
 
 	/* Customized parameters for the LLD SLEEP module
-	 * respect to OSC wake-up timings in us */
+	 * respect to OSC wake-up timings in us; the sampling lead time is added
+	 * by App_Sample_Lead_Update once advertising */
 	desired_lld_sleep_params.twosc = TWOSC;
 	BLE_LLD_Sleep_Params_Set(desired_lld_sleep_params);
 
 	/* Initialize the baseband and BLE stack */
 	BLE_Initialize();
 
-	/* Set radio output power of RF */
-	Sys_RFFE_SetTXPower(RF_TX_POWER_LEVEL);
+	/* Resume the TLM counters and last readings after a watchdog or soft
+	 * reset */
+	Retained_State_Load();
 
 	/* Trim RC oscillator to 3 MHz (required by Sys_PowerModes_Wakeup) */
 	Sys_Clocks_OscRCCalibratedConfig(3000);
@@ -181,6 +183,15 @@ void App_Initialize(void) {
 	/* Initialize environment */
 	App_Env_Initialize();
 
+	/* Apply the runtime configuration: advertising interval, radio output
+	 * power and job periods */
+	App_Config_Apply();
+
+#if (WAKE_PROFILE)
+	/* Start the wake-window profiler */
+	Wake_Profile_Initialize();
+#endif
+
 #ifdef VOLTAGES_CALIB_VERIFY
 
 	/* Hold here to verify calibrated voltages */
@@ -216,12 +227,24 @@ void App_Env_Initialize(void) {
 	NVIC_SetPriority(I2C_IRQn, 2);
 
 	/* Configure the DIOs for I2C */
-	Sys_I2C_DIOConfig(DIO_6X_DRIVE | DIO_LPF_ENABLE | DIO_STRONG_PULL_UP,
-			I2C_SCL_DIO_NUM, I2C_SDA_DIO_NUM);
+	Sys_I2C_DIOConfig(I2C_DIO_CFG, I2C_SCL_DIO_NUM, I2C_SDA_DIO_NUM);
+	I2C_Recovery_Config(I2C_SCL_DIO_NUM, I2C_SDA_DIO_NUM, I2C_DIO_CFG);
+
+	/* Keep the I2C configuration to restore it after wake-up */
+	Periph_Retention_Save();
+
+	/* Configure the DIO used as ground and power pins for the sensor and
+	 * power it; with SENSOR_POWER_GATING the supply is then switched by the
+	 * sequencer */
+	Sensor_Power_Initialize();
+
+#if (HISTORY_ENABLE)
+	/* Keep the temperature history across warm resets */
+	History_Initialize(retained_state_warm);
+#endif
 
-	/* Configure the DIO used as ground and power pins for the SI7042 */
-	Sys_DIO_Config(I2C_GND_DIO_NUM, DIO_MODE_GPIO_OUT_0);
-	Sys_DIO_Config(I2C_PWR_DIO_NUM, DIO_MODE_GPIO_OUT_1);
+	/* Initialize the periodic job scheduler */
+	App_Jobs_Initialize();
 
 	/* Initialize the custom service environment */
 	CustomService_Env_Initialize();
@@ -59,6 +59,67 @@ const struct ke_state_handler appm_default_handler
 /* Defines a place holder for all task instance's state */
 ke_state_t appm_state[APP_IDX_MAX];
 
+/* Periodic jobs, see job_schedule.h */
+/* Index of the sensor job in app_job_list, without sample wake-ups */
+#define APP_JOB_SENSOR                  0
+
+static const struct job_desc app_job_list[] =
+{
+    /* start, pending, period, slack, offset, cost_us */
+#if (SAMPLE_WAKE)
+    /* Sensor sampled from RTC alarm wake-ups, see sample_wake.h */
+#else
+    { Sensor_Job, &nct375.busy, 1, 0, 0, JOB_SENSOR_COST },
+#endif
+    { Battery_Measure_Start, &app_env.batt_meas_pending,
+      JOB_BATTERY_PERIOD, JOB_BATTERY_SLACK, JOB_BATTERY_PERIOD - 1,
+      JOB_BATTERY_COST },
+#if (RC_OSC_UPDATE)
+    { RC_Calibration_Job, NULL, JOB_RC_CALIB_PERIOD, JOB_RC_CALIB_SLACK, 0,
+      JOB_RC_CALIB_COST },
+#endif
+    { Notification_Job, NULL, JOB_NOTIFICATION_PERIOD, JOB_NOTIFICATION_SLACK,
+      JOB_NOTIFICATION_PERIOD - 1, JOB_NOTIFICATION_COST },
+#ifdef ALARM_MODE
+    { Alarm_Process, NULL, 1, 0, 0, JOB_ALARM_COST },
+#endif
+    { Advertising_Job, NULL, 1, 0, 0, JOB_ADVERTISING_COST },
+#if (HISTORY_ENABLE)
+    { History_Job, NULL, 1, 0, 0, JOB_HISTORY_COST },
+#endif
+    { Retained_State_Persist, NULL, 1, 0, 0, JOB_PERSIST_COST }
+};
+
+/* Periodic job scheduler */
+struct job_schedule_tag app_jobs;
+
+/* Asynchronous job latencies */
+struct app_jobs_stats_tag app_jobs_stats;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void RCCLK_Period_Apply(uint32_t rc_period)
+ * ----------------------------------------------------------------------------
+ * Description   : Update the RC clock period used by the BLE stack from an
+ *                 averaged period measurement, and keep the measurement in the
+ *                 retained state
+ * Inputs        : - rc_period  - Averaged Audiosink period count
+ * Outputs       : None
+ * Assumptions   : The Audiosink block has been configured
+ * ------------------------------------------------------------------------- */
+static void RCCLK_Period_Apply(uint32_t rc_period)
+{
+    uint32_t rc_freq;
+
+    /* Calculate RC oscillator frequency */
+    rc_freq = (SystemCoreClock * (AUDIOSINK->CFG + 1)
+               + (rc_period >> 1)) / rc_period;
+
+    /* Update RCCLK period value */
+    RTCCLK_Period_Value_Set((float) 1000000.0 / rc_freq);
+
+    retained_state.rc_period = rc_period;
+}
+
 /* ----------------------------------------------------------------------------
  * Function      : void Sleep_Mode_Configure(
                            struct sleep_mode_env_tag *sleep_mode_env)
@@ -74,8 +135,19 @@ void Sleep_Mode_Configure(struct sleep_mode_env_tag *sleep_mode_env)
 {
     struct sleep_mode_init_env_tag sleep_mode_init_env;
 
-    /* Set the clock source for RTC */
-    sleep_mode_init_env.rtc_ctrl = RTC_CLK_SRC;
+    /* Set the clock source for RTC; the RTC is enabled in both cases, as
+     * its counter timestamps the asynchronous job completions
+     * (App_Jobs_Elapsed) */
+#if (SAMPLE_WAKE)
+    /* Raise the RTC alarm at the configured sample period */
+    Sample_Wake_Configure();
+    sleep_mode_init_env.rtc_ctrl = RTC_CLK_SRC | RTC_ALARM_ZERO | RTC_ENABLE;
+#else
+    /* No alarm; the counter only wraps once per start value */
+    ACS_RTC_CFG->START_VALUE = APP_JOBS_RTC_START_VALUE;
+    sleep_mode_init_env.rtc_ctrl = RTC_CLK_SRC | RTC_ALARM_DISABLE |
+                                   RTC_ENABLE;
+#endif
 
     /* if RTC clock source is XTAL 32 kHz oscillator */
     if (RTC_CLK_SRC == RTC_CLK_SRC_XTAL32K)
@@ -114,20 +186,32 @@ void Sleep_Mode_Configure(struct sleep_mode_env_tag *sleep_mode_env)
 
         LowPowerClock_Source_Set(1);
 
-        /* In us, for typical RCOSC until measurement is obtained. */
-        RTCCLK_Period_Value_Set(RCCLK_PERIOD_VALUE);
-
         /* Set-up the Audiosink block for frequency measurement */
         Sys_Audiosink_ResetCounters();
         Sys_Audiosink_InputClock(0, AUDIOSINK_CLK_SRC_STANDBYCLK);
         Sys_Audiosink_Config(AUDIO_SINK_PERIODS_16, 0, 0);
 
-        /* Enable interrupts */
-        NVIC_ClearPendingIRQ(AUDIOSINK_PERIOD_IRQn);
-        NVIC_EnableIRQ(AUDIOSINK_PERIOD_IRQn);
+        if (RETAINED_RC_PERIOD_VALID())
+        {
+            /* Resume the period measured before the reset instead of
+             * averaging RCCLK_FREQUENCY_SAMPLES measurements again */
+#if (RC_OSC_UPDATE)
+            rc_period_prev = (retained_state.rc_period - 0.5) * 100;
+#endif
+            RCCLK_Period_Apply(retained_state.rc_period);
+        }
+        else
+        {
+            /* In us, for typical RCOSC until measurement is obtained. */
+            RTCCLK_Period_Value_Set(RCCLK_PERIOD_VALUE);
+
+            /* Enable interrupts */
+            NVIC_ClearPendingIRQ(AUDIOSINK_PERIOD_IRQn);
+            NVIC_EnableIRQ(AUDIOSINK_PERIOD_IRQn);
 
-        /* Start period counter to start period measurement */
-        AUDIOSINK_CTRL->PERIOD_CNT_START_ALIAS = 1;
+            /* Start period counter to start period measurement */
+            AUDIOSINK_CTRL->PERIOD_CNT_START_ALIAS = 1;
+        }
     }
     /* else: if RTC clock source is external oscillator */
     else
@@ -149,12 +233,19 @@ void Sleep_Mode_Configure(struct sleep_mode_env_tag *sleep_mode_env)
      *    WAKEUP_WAKEUP_PAD_[RISING | FALLING],
      *    WAKEUP_DIO*_[RISING | FALLING],
      *    WAKEUP_DIO*_[ENABLE | DISABLE] */
+#ifdef ALARM_MODE
+    /* Wake up on the NCT375 OS/ALERT output */
+    sleep_mode_init_env.wakeup_cfg = WAKEUP_DELAY_32          |
+                                     WAKEUP_WAKEUP_PAD_RISING |
+                                     NCT375_ALERT_WAKEUP_CFG;
+#else
     sleep_mode_init_env.wakeup_cfg = WAKEUP_DELAY_32          |
                                      WAKEUP_WAKEUP_PAD_RISING |
                                      WAKEUP_DIO3_DISABLE      |
                                      WAKEUP_DIO2_DISABLE      |
                                      WAKEUP_DIO1_DISABLE      |
                                      WAKEUP_DIO0_DISABLE;
+#endif
 
     /* Set wake-up control/status registers, use
      *    PADS_RETENTION_[ENABLE | DISABLE],
@@ -241,6 +332,9 @@ void Sleep_Mode_Configure(struct sleep_mode_env_tag *sleep_mode_env)
  * ------------------------------------------------------------------------- */
 void Wakeup_From_Sleep_Application(void)
 {
+    /* Restart the cycle counter used by the wake-window profiler */
+    WAKE_PROFILE_START();
+
     /* Execute steps required to wake-up the system from sleep mode */
 #ifdef APP_SLEEP_2MBPS_SUPPORT
     Sys_PowerModes_Wakeup_2Mbps();
@@ -248,6 +342,15 @@ void Wakeup_From_Sleep_Application(void)
     Sys_PowerModes_Wakeup();
 #endif
 
+#if (SAMPLE_WAKE)
+    /* Sensor sampling only if the baseband timer has not expired; the
+     * sample of a wake-up caused by both is skipped */
+    if (SAMPLE_WAKE_RTC_ONLY())
+    {
+        Sample_Wake_Process();
+    }
+#endif
+
     /* The system is awake from this point, continue application from flash */
     Continue_Application();
 }
@@ -263,13 +366,13 @@ void Wakeup_From_Sleep_Application(void)
  * ------------------------------------------------------------------------- */
 void Continue_Application(void)
 {
+    WAKE_PROFILE_BEGIN();
+
     /* Lower drive strength (required when VDDO > 2.7)*/
     DIO->PAD_CFG = PAD_LOW_DRIVE;
 
-    /* Turn LED on */
-    Sys_DIO_Config(LED_DIO, DIO_MODE_GPIO_OUT_1);
-
-    /* Turn off pad retention */
+    /* Apply the wake state of the pads, then turn off pad retention */
+    Pad_Policy_Wake();
     ACS_WAKEUP_CTRL->PADS_RETENTION_EN_BYTE = PADS_RETENTION_DISABLE_BYTE;
 
     /* Configure clock dividers */
@@ -287,6 +390,12 @@ void Continue_Application(void)
      * due to an early ACS wake-up condition (e.g. PAD, RTC) */
     BBIF->CTRL = BB_CLK_ENABLE | BBCLK_DIVIDER_VALUE | BB_WAKEUP;
 
+#if (EARLY_WORK)
+    /* Start the sensor read and battery measurement of this wake-up; their
+     * interrupts are processed in the wait loop below */
+    App_Jobs_Begin();
+#endif
+
     /* Mask all interrupts */
     __disable_irq();
     while (!(BLE_Is_Awake()))
@@ -296,28 +405,22 @@ void Continue_Application(void)
         /* Process interrupt */
         __enable_irq();
         __disable_irq();
+#if (EARLY_WORK)
+        App_Jobs_Poll();
+#endif
+    }
+    WAKE_PROFILE_MARK(WAKE_PHASE_BLE_WAIT);
+#if (EARLY_WORK)
+    if (Job_Schedule_Pending(&app_jobs, app_env.jobs_due) == NULL)
+    {
+        WAKE_PROFILE_OVERLAPPED();
     }
+#endif
 
-    /* Update RCOSC period every 100 cycles of advertisement and sleep.
-     * 100 cycles = approximately 4.5s with a connection interval of 20ms */
+    /* Count the cycles of advertisement and sleep since the last RCOSC
+     * period update (the update itself is a periodic job) */
 #if (RC_OSC_UPDATE)
     loop_cnt++;
-    sample_cnt = RCCLK_FREQUENCY_SAMPLES - 1;
-
-    if (loop_cnt == RC_OSC_UPDATE_INTERVAL)
-    {
-        /* Set-up the Audiosink block for frequency measurement */
-        Sys_Audiosink_ResetCounters();
-        Sys_Audiosink_InputClock(0, AUDIOSINK_CLK_SRC_STANDBYCLK);
-        Sys_Audiosink_Config(AUDIO_SINK_PERIODS_16, 0, 0);
-
-        /* Enable interrupts */
-        NVIC_ClearPendingIRQ(AUDIOSINK_PERIOD_IRQn);
-        NVIC_EnableIRQ(AUDIOSINK_PERIOD_IRQn);
-
-        /* Start period counter to start period measurement */
-        AUDIOSINK_CTRL->PERIOD_CNT_START_ALIAS = 1;
-    }
 #endif
 
     /* Stop masking interrupts */
@@ -345,10 +448,476 @@ void Measure_Battery_Level(void)
     uint16_t level;
 
     /* Calculate the battery level */
-    level = ADC->DATA_TRIM_CH[0];
-    ble_env.batt_lvl = 2*level;
+    level = 2*ADC->DATA_TRIM_CH[0];
+
+    /* Average the battery level (exponential moving average, weight 1/4 of
+     * the new measurement); the first measurement is used as it is */
+    if (ble_env.batt_lvl == 0)
+    {
+        ble_env.batt_lvl = level;
+    }
+    else
+    {
+        ble_env.batt_lvl = (3 * ble_env.batt_lvl + level + 2) / 4;
+    }
 }
 
+/* ----------------------------------------------------------------------------
+ * Function      : void Battery_Measure_Start(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Start an asynchronous VBAT/2 measurement on ADC channel 0.
+ *                 The sample is handed to Measure_Battery_Level from
+ *                 ADC_BATMON_IRQHandler, which also disables the ADC again.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Battery_Measure_Start(void)
+{
+    app_env.batt_meas_pending = true;
+
+    /* Configure ADC channel 0 to measure VBAT/2 */
+    Sys_ADC_Set_Config(ADC_VBAT_DIV2_NORMAL | ADC_CONTINUOUS |
+                       ADC_PRESCALE_6400);
+    Sys_ADC_InputSelectConfig(0, (ADC_NEG_INPUT_GND |
+                                  ADC_POS_INPUT_VBAT_DIV2));
+
+    /* Interrupt once a sample of channel 0 is ready */
+    Sys_ADC_Clear_BATMONStatus();
+    Sys_ADC_Set_BATMONIntConfig(INT_EBL_ADC | ADC_INT_CH0 |
+                                INT_DIS_BATMON_ALARM);
+    NVIC_ClearPendingIRQ(ADC_BATMON_IRQn);
+    NVIC_EnableIRQ(ADC_BATMON_IRQn);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void ADC_BATMON_IRQHandler(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Read the battery level once the ADC sample of channel 0 is
+ *                 ready and put the ADC back into its low power state
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Battery_Measure_Start has been called
+ * ------------------------------------------------------------------------- */
+void ADC_BATMON_IRQHandler(void)
+{
+    /* Read the battery level */
+    Measure_Battery_Level();
+
+    /* Disable the ADC and its interrupt until the next measurement */
+    Sys_ADC_Set_Config(ADC_VBAT_DIV2_NORMAL | ADC_DISABLE |
+                       ADC_PRESCALE_6400);
+    Sys_ADC_Set_BATMONIntConfig(INT_DIS_ADC | INT_DIS_BATMON_ALARM);
+    Sys_ADC_Clear_BATMONStatus();
+    NVIC_DisableIRQ(ADC_BATMON_IRQn);
+
+    app_env.batt_meas_pending = false;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void App_Wait_For_Completion(volatile bool *pending)
+ * ----------------------------------------------------------------------------
+ * Description   : Wait with the core in WFI until an interrupt handler
+ *                 clears the given flag
+ * Inputs        : - pending    - Flag cleared on completion of the operation
+ * Outputs       : None
+ * Assumptions   : The flag is cleared from an interrupt handler
+ * ------------------------------------------------------------------------- */
+void App_Wait_For_Completion(volatile bool *pending)
+{
+    /* Mask interrupts so that a completion between the check and WFI is not
+     * missed; a pending interrupt still wakes up the core */
+    __disable_irq();
+    while (*pending)
+    {
+        SYS_WAIT_FOR_INTERRUPT;
+
+        /* Process interrupt */
+        __enable_irq();
+        __disable_irq();
+    }
+    __enable_irq();
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Alarm_Process(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Check the NCT375 OS/ALERT output. When it becomes active
+ *                 (temperature above TOS), advertise at ALARM_ADV_INT for
+ *                 ALARM_BURST_COUNT advertising events, then return to the
+ *                 nominal advertising interval.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Called once per wake-up; the OS/ALERT output is active low
+ * ------------------------------------------------------------------------- */
+void Alarm_Process(void)
+{
+    bool active = (DIO_DATA->ALIAS[NCT375_ALERT_DIO] == 0);
+
+    if (active && !app_env.alarm_active)
+    {
+        app_env.alarm_burst = ALARM_BURST_COUNT;
+        Advertising_Set_Interval(ALARM_ADV_INT);
+    }
+    else if (app_env.alarm_burst > 0)
+    {
+        app_env.alarm_burst--;
+        if (app_env.alarm_burst == 0)
+        {
+            Advertising_Set_Interval(APP_CONFIG_ADV_INT());
+        }
+    }
+    app_env.alarm_active = active;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void App_Jobs_Initialize(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Initialize the periodic job scheduler with the application
+ *                 job list
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void App_Jobs_Initialize(void)
+{
+    /* The due job mask of the scheduler holds JOB_SCHEDULE_MAX jobs; with
+     * RC_OSC_UPDATE and ALARM_MODE the table is already at this limit */
+    _Static_assert(sizeof(app_job_list) / sizeof(app_job_list[0]) <=
+                   JOB_SCHEDULE_MAX, "app_job_list exceeds JOB_SCHEDULE_MAX");
+
+    Job_Schedule_Initialize(&app_jobs, app_job_list,
+                            sizeof(app_job_list) / sizeof(app_job_list[0]));
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void App_Jobs_Begin(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Restore the I2C interface, select the periodic jobs of
+ *                 this wake-up and start the asynchronous ones
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Called once per wake-up, before Main_Loop waits for the
+ *                 asynchronous jobs; the jobs started here do not use the
+ *                 BLE stack
+ * ------------------------------------------------------------------------- */
+void App_Jobs_Begin(void)
+{
+    /* Configure I2C Interface */
+#if (PERIPH_RETENTION)
+    Periph_Retention_Restore();
+#else
+    I2C_Master_Init(0x80U);
+    Sys_I2C_DIOConfig(I2C_DIO_CFG, I2C_SCL_DIO_NUM, I2C_SDA_DIO_NUM);
+#endif
+    WAKE_PROFILE_MARK(WAKE_PHASE_PERIPH);
+
+    app_env.jobs_due = Job_Schedule_Select(&app_jobs);
+    app_jobs_stats.start = Sys_RTC_Value();
+    app_jobs_stats.done = 0;
+    Job_Schedule_Start(&app_jobs, app_env.jobs_due);
+    app_env.jobs_started = true;
+    WAKE_PROFILE_MARK(WAKE_PHASE_JOBS_START);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint16_t App_Jobs_Elapsed(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Time elapsed since the jobs of the wake-up were started
+ * Inputs        : None
+ * Outputs       : return value - Elapsed time in us, saturated
+ * Assumptions   : App_Jobs_Begin has been called; the RTC is enabled by
+ *                 Sleep_Mode_Configure and has not been reloaded more than
+ *                 once since
+ * ------------------------------------------------------------------------- */
+uint16_t App_Jobs_Elapsed(void)
+{
+    uint32_t now = Sys_RTC_Value();
+    uint32_t ticks;
+
+    /* The RTC counts down from its start value (ACS_RTC_CFG), then reloads
+     * it */
+    if (now <= app_jobs_stats.start)
+    {
+        ticks = app_jobs_stats.start - now;
+    }
+    else
+    {
+        ticks = app_jobs_stats.start + (ACS_RTC_CFG->START_VALUE - now) + 1;
+    }
+
+    if (ticks > (uint32_t)UINT16_MAX * APP_JOBS_RTC_CLK_HZ / 1000000)
+    {
+        return UINT16_MAX;
+    }
+
+    return (uint16_t)(ticks * 1000000 / APP_JOBS_RTC_CLK_HZ);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void App_Jobs_Poll(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Record the latency of the asynchronous jobs that have
+ *                 completed since the last call
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : App_Jobs_Begin has been called; called after each
+ *                 interrupt while the jobs are pending
+ * ------------------------------------------------------------------------- */
+void App_Jobs_Poll(void)
+{
+    uint8_t done;
+    uint16_t latency;
+    uint8_t i;
+
+    done = Job_Schedule_Completed(&app_jobs, app_env.jobs_due) &
+           ~app_jobs_stats.done;
+    if (done == 0)
+    {
+        return;
+    }
+
+    latency = App_Jobs_Elapsed();
+
+    for (i = 0; i < JOB_SCHEDULE_MAX; i++)
+    {
+        if (done & (1U << i))
+        {
+            app_jobs_stats.latency[i] = latency;
+        }
+    }
+    app_jobs_stats.done |= done;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void App_Jobs_Join(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Wait with the core in WFI until all the asynchronous jobs
+ *                 of the wake-up have completed and update the critical
+ *                 path counters
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : App_Jobs_Begin has been called
+ * ------------------------------------------------------------------------- */
+void App_Jobs_Join(void)
+{
+    uint16_t critical = 0;
+    uint16_t serial = 0;
+    uint8_t i;
+
+    /* Mask interrupts so that a completion between the check and WFI is not
+     * missed; a pending interrupt still wakes up the core */
+    __disable_irq();
+    App_Jobs_Poll();
+    while (Job_Schedule_Pending(&app_jobs, app_env.jobs_due) != NULL)
+    {
+        SYS_WAIT_FOR_INTERRUPT;
+
+        /* Process interrupt */
+        __enable_irq();
+        __disable_irq();
+        App_Jobs_Poll();
+    }
+    __enable_irq();
+
+    if (app_jobs_stats.done == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < JOB_SCHEDULE_MAX; i++)
+    {
+        if (app_jobs_stats.done & (1U << i))
+        {
+            if (app_jobs_stats.latency[i] > critical)
+            {
+                critical = app_jobs_stats.latency[i];
+            }
+            serial = (serial + app_jobs_stats.latency[i] > UINT16_MAX) ?
+                     UINT16_MAX : serial + app_jobs_stats.latency[i];
+        }
+    }
+
+    app_jobs_stats.wakes++;
+    app_jobs_stats.critical = critical;
+    app_jobs_stats.serial = serial;
+    app_jobs_stats.critical_sum += critical;
+    app_jobs_stats.serial_sum += serial;
+    if (critical > app_jobs_stats.critical_max)
+    {
+        app_jobs_stats.critical_max = critical;
+    }
+#if !(SAMPLE_WAKE)
+    if ((app_jobs_stats.done & (1U << APP_JOB_SENSOR)) &&
+        app_jobs_stats.latency[APP_JOB_SENSOR] > app_jobs_stats.sensor_max)
+    {
+        app_jobs_stats.sensor_max = app_jobs_stats.latency[APP_JOB_SENSOR];
+    }
+#endif
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void App_Sample_Lead_Update(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Set the wake-up lead of the LLD sleep parameters: the
+ *                 longest sensor job latency measured plus a margin while
+ *                 advertising, none otherwise (see APP_SAMPLE_LEAD)
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Called before each sleep attempt
+ * ------------------------------------------------------------------------- */
+void App_Sample_Lead_Update(void)
+{
+#if (APP_SAMPLE_LEAD) && !(SAMPLE_WAKE)
+    struct lld_sleep_params_t lld_sleep_params;
+    uint16_t lead = 0;
+
+    if (ble_env.state == APPM_ADVERTISING)
+    {
+        lead = (app_jobs_stats.sensor_max > APP_SAMPLE_LEAD_MAX_US) ?
+               APP_SAMPLE_LEAD_MAX_US : app_jobs_stats.sensor_max;
+        lead += APP_SAMPLE_LEAD_MARGIN_US;
+    }
+
+    if (lead != app_jobs_stats.lead)
+    {
+        lld_sleep_params.twosc = TWOSC + lead;
+        BLE_LLD_Sleep_Params_Set(lld_sleep_params);
+        app_jobs_stats.lead = lead;
+    }
+#endif
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Sensor_Job(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Start the NCT375 transaction(s) of this wake-up;
+ *                 nct375.busy is cleared once they have completed
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The I2C interface is configured
+ * ------------------------------------------------------------------------- */
+void Sensor_Job(void)
+{
+#if (SENSOR_POWER_GATING)
+    /* Read the first conversion of the sensor powered up before this
+     * wake-up */
+    NCT375_Temperature_Read();
+#elif defined(ONE_SHOT_PIPELINED)
+    /* Read the conversion triggered on the previous wake and trigger the
+     * next one */
+    NCT375_ONEShot_Pipeline();
+#elif defined(ONE_SHOT_MODE)
+    /* Trigger a conversion or read the previous one */
+    NCT375_ONEShot_Process();
+#else
+    /* Read the last conversion */
+    NCT375_Temperature_Read();
+#endif
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void RC_Calibration_Job(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Start an RC oscillator period measurement; the RCCLK period
+ *                 is updated from AUDIOSINK_PERIOD_IRQHandler
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The RC oscillator is the RTC clock source
+ * ------------------------------------------------------------------------- */
+void RC_Calibration_Job(void)
+{
+    sample_cnt = RCCLK_FREQUENCY_SAMPLES - 1;
+
+    /* Set-up the Audiosink block for frequency measurement */
+    Sys_Audiosink_ResetCounters();
+    Sys_Audiosink_InputClock(0, AUDIOSINK_CLK_SRC_STANDBYCLK);
+    Sys_Audiosink_Config(AUDIO_SINK_PERIODS_16, 0, 0);
+
+    /* Enable interrupts */
+    NVIC_ClearPendingIRQ(AUDIOSINK_PERIOD_IRQn);
+    NVIC_EnableIRQ(AUDIOSINK_PERIOD_IRQn);
+
+    /* Start period counter to start period measurement */
+    AUDIOSINK_CTRL->PERIOD_CNT_START_ALIAS = 1;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Notification_Job(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Notify a new custom service TX value when connected; the
+ *                 TX value is left to the bulk history download while it runs
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Notification_Job(void)
+{
+#if (HISTORY_ENABLE)
+    if (history_download.active)
+    {
+        return;
+    }
+#endif
+
+    if (ble_env.state == APPM_CONNECTED &&
+        cs_env.tx_cccd_value == ATT_CCC_START_NTF)
+    {
+        cs_env.val_notif = Emulate_CS_Val_Notif_Change(cs_env.val_notif);
+        memset(cs_env.tx_value, cs_env.val_notif, CS_TX_VALUE_MAX_LENGTH);
+        CustomService_Notify(ble_env.conidx, CS_IDX_TX_VALUE_VAL,
+                             cs_env.tx_value, CS_TX_VALUE_MAX_LENGTH,
+                             CS_NTF_SRC_APP, NULL);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Advertising_Job(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Update the advertising data with the readings of this
+ *                 wake-up, count late commits and keep the readings in the
+ *                 retained state
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Advertising_Job(void)
+{
+    Advertising_Update();
+
+    /* The update is committed to the baseband from Kernel_Schedule, right
+     * after the synchronous jobs; it is in time for this wake-up's
+     * advertising event if it precedes it */
+    app_jobs_stats.commit = App_Jobs_Elapsed();
+    if (ble_env.state == APPM_ADVERTISING &&
+        app_jobs_stats.commit > TWOSC + app_jobs_stats.lead)
+    {
+        app_jobs_stats.late++;
+    }
+
+    Retained_State_Save();
+}
+
+#if (HISTORY_ENABLE)
+/* ----------------------------------------------------------------------------
+ * Function      : void History_Job(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Append the temperature to the history if a new sample has
+ *                 been read since the last call
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void History_Job(void)
+{
+    if (nct375.samples != history.samples)
+    {
+        history.samples = nct375.samples;
+        History_Append(ble_env.adv_time, ble_env.temperature);
+    }
+}
+#endif
+
 /* ----------------------------------------------------------------------------
  * Function      : uint8_t Emulate_CS_Val_Notif_Change(uint8_t val_notif)
  * ----------------------------------------------------------------------------
@@ -408,7 +977,6 @@ int Msg_Handler(ke_msg_id_t const msg_id, void *param,
 void AUDIOSINK_PERIOD_IRQHandler(void)
 {
     /* Parameters for RC oscillator period measurements */
-    uint32_t rc_freq;
     uint32_t rc_period_new = 0;
 
 #if (RC_OSC_UPDATE)
@@ -466,12 +1034,7 @@ void AUDIOSINK_PERIOD_IRQHandler(void)
             rc_period_new /= 100;
         }
 
-        /* Calculate RC oscillator frequency */
-        rc_freq = (SystemCoreClock * (AUDIOSINK->CFG + 1)
-                   + (rc_period_new >> 1)) / rc_period_new;
-
-        /* Update RCCLK period value */
-        RTCCLK_Period_Value_Set((float) 1000000.0 / rc_freq);
+        RCCLK_Period_Apply(rc_period_new);
 
         /* Reset sampleCounter and loop_cnt */
         sample_cnt = 0;
@@ -38,7 +38,22 @@ void CustomService_Env_Initialize(void)
     cs_env.tx_cccd_value = ATT_CCC_START_NTF;
     cs_env.rx_cccd_value = 0;
     cs_env.val_notif = 0;
-    cs_env.sentSuccess = 1;
+    CustomService_Queue_Reset();
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void CustomService_Queue_Reset(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Reset the notification window and counters for a new
+ *                 connection
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void CustomService_Queue_Reset(void)
+{
+    memset(&cs_env.ntf, 0, sizeof(cs_env.ntf));
+    cs_env.ntf.stats.window = CS_NTF_WINDOW_INIT;
 }
 
 /* ----------------------------------------------------------------------------
@@ -74,7 +89,7 @@ void CustomService_ServiceAdd(void)
         [CS_IDX_TX_VALUE_CHAR]     = ATT_DECL_CHAR(),
         [CS_IDX_TX_VALUE_VAL]      = ATT_DECL_CHAR_UUID_128(CS_CHARACTERISTIC_TX_UUID,
                                      PERM(RD,ENABLE) | PERM(NTF,ENABLE),
-                                     CS_TX_VALUE_MAX_LENGTH),
+                                     CS_TX_NTF_MAX_LENGTH),
         [CS_IDX_TX_VALUE_CCC]      = ATT_DECL_CHAR_CCC(),
         [CS_IDX_TX_VALUE_USR_DSCP] = ATT_DECL_CHAR_USER_DESC( CS_USER_DESCRIPTION_MAX_LENGTH ),
 
@@ -85,6 +100,20 @@ void CustomService_ServiceAdd(void)
                                      CS_RX_VALUE_MAX_LENGTH),
         [CS_IDX_RX_VALUE_CCC]      = ATT_DECL_CHAR_CCC(),
         [CS_IDX_RX_VALUE_USR_DSCP] = ATT_DECL_CHAR_USER_DESC( CS_USER_DESCRIPTION_MAX_LENGTH ),
+
+        /* Notification statistics Characteristic */
+        [CS_IDX_STATS_VALUE_CHAR]     = ATT_DECL_CHAR(),
+        [CS_IDX_STATS_VALUE_VAL]      = ATT_DECL_CHAR_UUID_128(CS_CHARACTERISTIC_STATS_UUID,
+                                        PERM(RD, ENABLE),
+                                        sizeof(struct cs_ntf_stats)),
+        [CS_IDX_STATS_VALUE_USR_DSCP] = ATT_DECL_CHAR_USER_DESC( CS_USER_DESCRIPTION_MAX_LENGTH ),
+
+        /* Configuration read-back Characteristic */
+        [CS_IDX_CONFIG_VALUE_CHAR]     = ATT_DECL_CHAR(),
+        [CS_IDX_CONFIG_VALUE_VAL]      = ATT_DECL_CHAR_UUID_128(CS_CHARACTERISTIC_CONFIG_UUID,
+                                         PERM(RD, ENABLE),
+                                         sizeof(struct app_config_tag)),
+        [CS_IDX_CONFIG_VALUE_USR_DSCP] = ATT_DECL_CHAR_USER_DESC( CS_USER_DESCRIPTION_MAX_LENGTH ),
     };
 
     /* Fill the add custom service message */
@@ -223,6 +252,30 @@ int GATTC_ReadReqInd(ke_msg_id_t const msg_id,
                 valptr = (uint8_t *) CS_TX_CHARACTERISTIC_NAME;
             }
             break;
+            case CS_IDX_STATS_VALUE_VAL:
+            {
+                length = sizeof(struct cs_ntf_stats);
+                valptr = (uint8_t *) &cs_env.ntf.stats;
+            }
+            break;
+            case CS_IDX_STATS_VALUE_USR_DSCP:
+            {
+                length = strlen(CS_STATS_CHARACTERISTIC_NAME);
+                valptr = (uint8_t *) CS_STATS_CHARACTERISTIC_NAME;
+            }
+            break;
+            case CS_IDX_CONFIG_VALUE_VAL:
+            {
+                length = sizeof(struct app_config_tag);
+                valptr = (uint8_t *) &app_config;
+            }
+            break;
+            case CS_IDX_CONFIG_VALUE_USR_DSCP:
+            {
+                length = strlen(CS_CONFIG_CHARACTERISTIC_NAME);
+                valptr = (uint8_t *) CS_CONFIG_CHARACTERISTIC_NAME;
+            }
+            break;
             default:
             {
                 status = ATT_ERR_READ_NOT_PERMITTED;
@@ -310,8 +363,24 @@ int GATTC_WriteReqInd(ke_msg_id_t const msg_id,
         {
             case CS_IDX_RX_VALUE_VAL:
             {
-                valptr = (uint8_t *) &cs_env.rx_value;
-                cs_env.rx_value_changed = 1;
+                /* The write can be longer than the value with a large
+                 * ATT MTU */
+                if (param->length > CS_RX_VALUE_MAX_LENGTH)
+                {
+                    status = ATT_ERR_INVALID_ATTRIBUTE_VAL_LEN;
+                }
+                else
+                {
+                    /* Configuration commands are range-checked, the result
+                     * is the status of the write */
+                    status = App_Config_Command(param->value, param->length);
+                }
+
+                if (status == GAP_ERR_NO_ERROR)
+                {
+                    valptr = (uint8_t *) &cs_env.rx_value;
+                    cs_env.rx_value_changed = 1;
+                }
             }
             break;
             case CS_IDX_RX_VALUE_CCC:
@@ -343,23 +412,37 @@ int GATTC_WriteReqInd(ke_msg_id_t const msg_id,
     /* Send the message */
     ke_msg_send(cfm);
 
+#if (HISTORY_ENABLE)
+    /* Bulk history download commands; the stream follows the write
+     * confirmation */
+    if (status == GAP_ERR_NO_ERROR && attnum == CS_IDX_RX_VALUE_VAL)
+    {
+        History_Download_Command(ble_env.conidx, cs_env.rx_value,
+                                 param->length);
+    }
+#endif
+
     return(KE_MSG_CONSUMED);
 }
 
 /* ----------------------------------------------------------------------------
  * Function      : void CustomService_SendNotification(uint8_t conidx,
- *                               uint8_t attidx, uint8_t *value, uint8_t length)
+ *                               uint8_t attidx, uint8_t *value,
+ *                               uint16_t length, uint16_t seq_num)
  * ----------------------------------------------------------------------------
  * Description   : Send a notification to the client device
  * Inputs        : - conidx       - connection index
  *                 - attidx       - index to attributes in the service
  *                 - value        - pointer to value
- *                 - length       - length of value
+ *                 - length       - length of value, at most the ATT MTU - 3
+ *                 - seq_num      - sequence number returned with the
+ *                                  GATTC_CMP_EVT of the notification
  * Outputs       : None
  * Assumptions   : None
  * ------------------------------------------------------------------------- */
 void CustomService_SendNotification(uint8_t conidx, uint8_t attidx,
-                                    uint8_t *value, uint8_t length)
+                                    uint8_t *value, uint16_t length,
+                                    uint16_t seq_num)
 {
     struct gattc_send_evt_cmd *cmd;
     uint16_t handle = (attidx + cs_env.start_hdl + 1);
@@ -373,13 +456,158 @@ void CustomService_SendNotification(uint8_t conidx, uint8_t attidx,
     cmd->handle = handle;
     cmd->length = length;
     cmd->operation = GATTC_NOTIFY;
-    cmd->seq_num = 0;
+    cmd->seq_num = seq_num;
     memcpy(cmd->value, value, length);
 
     /* Send the message */
     ke_msg_send(cmd);
 }
 
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t CustomService_Credits(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Get the number of notifications that can be queued
+ * Inputs        : None
+ * Outputs       : return value - Free places in the notification window
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint8_t CustomService_Credits(void)
+{
+    if (cs_env.ntf.stats.in_flight >= cs_env.ntf.stats.window)
+    {
+        return 0;
+    }
+
+    return (cs_env.ntf.stats.window - cs_env.ntf.stats.in_flight);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool CustomService_Notify(uint8_t conidx, uint8_t attidx,
+ *                                           uint8_t *value, uint16_t length,
+ *                                           uint8_t src, uint16_t *seq_num)
+ * ----------------------------------------------------------------------------
+ * Description   : Send a notification if the notification window allows it;
+ *                 its completion is reported to the sender from GATTC_CmpEvt
+ * Inputs        : - conidx       - connection index
+ *                 - attidx       - index to attributes in the service
+ *                 - value        - pointer to value
+ *                 - length       - length of value, at most the ATT MTU - 3
+ *                 - src          - sender (enum cs_ntf_src)
+ * Outputs       : - seq_num      - sequence number of the notification, can
+ *                                  be NULL
+ *                 return value   - false if the window is full
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+bool CustomService_Notify(uint8_t conidx, uint8_t attidx, uint8_t *value,
+                          uint16_t length, uint8_t src, uint16_t *seq_num)
+{
+    struct cs_ntf_queue_tag *ntf = &cs_env.ntf;
+
+    if (CustomService_Credits() == 0)
+    {
+        ntf->stats.refused++;
+        return false;
+    }
+
+    ntf->src[ntf->seq_num % CS_NTF_WINDOW_MAX] = src;
+    if (seq_num != NULL)
+    {
+        *seq_num = ntf->seq_num;
+    }
+    CustomService_SendNotification(conidx, attidx, value, length,
+                                   ntf->seq_num);
+    ntf->seq_num++;
+
+    ntf->stats.sent++;
+    ntf->stats.bytes += length;
+    ntf->stats.in_flight++;
+    if (ntf->stats.in_flight > ntf->stats.depth_max)
+    {
+        ntf->stats.depth_max = ntf->stats.in_flight;
+    }
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void CustomService_Notify_Complete(uint16_t seq_num,
+ *                                                          uint8_t status)
+ * ----------------------------------------------------------------------------
+ * Description   : Release the window place of a completed notification, adapt
+ *                 the window and report the completion to the sender
+ * Inputs        : - seq_num      - sequence number of the notification
+ *                 - status       - status of the notification
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void CustomService_Notify_Complete(uint16_t seq_num, uint8_t status)
+{
+    struct cs_ntf_queue_tag *ntf = &cs_env.ntf;
+
+    if (ntf->stats.in_flight == 0)
+    {
+        /* Completion of a previous connection */
+        return;
+    }
+    ntf->stats.in_flight--;
+
+    /* Notifications complete in the order they were sent */
+    if (seq_num != ntf->seq_num_done)
+    {
+        ntf->stats.out_of_order++;
+    }
+    ntf->seq_num_done = seq_num + 1;
+
+    if (status == GAP_ERR_NO_ERROR)
+    {
+        ntf->stats.completed++;
+        if (ntf->stats.window < CS_NTF_WINDOW_MAX &&
+            ++ntf->increase >= ntf->stats.window)
+        {
+            ntf->stats.window++;
+            ntf->increase = 0;
+        }
+    }
+    else
+    {
+        ntf->stats.errors++;
+        if (status == GAP_ERR_INSUFF_RESOURCES)
+        {
+            /* Out of buffers: back off */
+            ntf->stats.backoffs++;
+            ntf->increase = 0;
+            if (ntf->stats.window > 1)
+            {
+                ntf->stats.window /= 2;
+            }
+        }
+    }
+
+    switch (ntf->src[seq_num % CS_NTF_WINDOW_MAX])
+    {
+#if (HISTORY_ENABLE)
+        case CS_NTF_SRC_DOWNLOAD:
+        {
+            History_Download_Sent(seq_num, status);
+        }
+        break;
+#endif
+        default:
+        {
+            if (status == GAP_ERR_NO_ERROR)
+            {
+                cs_env.cnt_notifc++;
+            }
+
+#if (HISTORY_ENABLE)
+            /* Give the released window place to the download */
+            History_Download_Continue();
+#endif
+        }
+        break;
+    }
+}
+
 /* ----------------------------------------------------------------------------
  * Function      : int GATTC_CmpEvt(ke_msg_id_t const msg_id,
  *                                  struct gattc_cmp_evt
@@ -403,15 +631,7 @@ int GATTC_CmpEvt(ke_msg_id_t const msg_id,
 {
     if (param->operation == GATTC_NOTIFY)
     {
-        if (param->status == GAP_ERR_NO_ERROR)
-        {
-            cs_env.sentSuccess = 1;
-        }
-
-        if (param->status == GAP_ERR_DISCONNECTED)
-        {
-            cs_env.sentSuccess = 1;
-        }
+        CustomService_Notify_Complete(param->seq_num, param->status);
     }
 
     return(KE_MSG_CONSUMED);
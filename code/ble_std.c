@@ -105,7 +105,8 @@ void BLE_Initialize(void) {
 	/* Initialize task state */
 	ble_env.state = APPM_INIT;
 	ble_env.adv_count = 0;
-	ble_env.temperature = 0;
+	ble_env.temperature = NCT375_TEMP_INVALID;
+	ble_env.adv_interval = APP_ADV_INT_MIN;
 	memset(ble_env.i2c_tx_buffer, 0, 8);
 
 	/* Set Bluetooth device type and address: depending on the device address
@@ -192,10 +193,6 @@ bool Service_Add(void) {
  * Assumptions   : None
  * ------------------------------------------------------------------------- */
 void Advertising_Start(void) {
-	uint8_t device_name_length;
-	uint8_t device_name_avail_space;
-	uint8_t company_id[APP_COMPANY_ID_DATA_LEN] = APP_COMPANY_ID_DATA;
-
 	/* Prepare the GAPM_START_ADVERTISE_CMD message */
 	struct gapm_start_advertise_cmd *cmd;
 
@@ -207,8 +204,8 @@ void Advertising_Start(void) {
 		cmd->op.addr_src = GAPM_STATIC_ADDR;
 		cmd->channel_map = APP_ADV_CHMAP;
 
-		cmd->intv_min = APP_ADV_INT_MIN;
-		cmd->intv_max = APP_ADV_INT_MAX;
+		cmd->intv_min = ble_env.adv_interval;
+		cmd->intv_max = ble_env.adv_interval;
 
 #if (APP_ADV_CONNECTABILITY_MODE == ADV_CONNECTABLE_MODE)
 		cmd->op.code = GAPM_ADV_UNDIRECT;
@@ -233,66 +230,23 @@ void Advertising_Start(void) {
 		cmd->info.host.scan_rsp_data_len = 0;
 #endif
 
-		/* Set the scan response data */
-		cmd->info.host.scan_rsp_data_len = 0;
-		device_name_avail_space = (ADV_DATA_LEN - 3) - 2;
-		if (device_name_avail_space > 0) {
-			/* Add as much of the device name as possible */
-			device_name_length = strlen(APP_DFLT_DEVICE_NAME);
-			if (device_name_length > 0) {
-				/* Check available space */
-				device_name_length = co_min(device_name_length,
-						device_name_avail_space);
-				cmd->info.host.scan_rsp_data[cmd->info.host.scan_rsp_data_len] =
-						device_name_length + 1;
-				/* Fill device name flag */
-				cmd->info.host.scan_rsp_data[cmd->info.host.scan_rsp_data_len
-						+ 1] = '\x09';
-				/* Copy device name */
-				memcpy(
-						&cmd->info.host.scan_rsp_data[cmd->info.host.scan_rsp_data_len
-								+ 2],
-						APP_DFLT_DEVICE_NAME, device_name_length);
-				/* Update scan response data length */
-				cmd->info.host.scan_rsp_data_len += (device_name_length + 2);
-			}
-			/* If there is still space, add the company ID */
-			if (((ADV_DATA_LEN - 3) - cmd->info.host.scan_rsp_data_len - 2) >=
-			APP_COMPANY_ID_DATA_LEN) {
-				memcpy(
-						&cmd->info.host.scan_rsp_data[cmd->info.host.scan_rsp_data_len],
-						company_id, APP_COMPANY_ID_DATA_LEN);
-				cmd->info.host.scan_rsp_data_len += APP_COMPANY_ID_DATA_LEN;
-			}
+		/* Set the advertising data and scan response; the counters are
+		 * kept if advertising is restarted with a new interval */
+		if (ble_env.adv_count == 0) {
+			ble_env.adv_count = 1;
+			// Update Advertising Time
+			//advertisement interval for given mode (units of 625us)
+			ble_env.adv_time = ble_env.adv_interval / 160;
+			ble_env.adv_time_rem = ble_env.adv_interval % 160;
 		}
+		Advertising_Data_Encode();
 
-		// Set TLM Frame
-		uint8_t msgbuf[] = { 0x03,  // Length of Service List
-				0x03,  // Param: Service List
-				0xAA, 0xFE,  // Eddystone ID
-				0x11,  // Length of Service Data ==> needs to be adjusted!
-				0x16,  // Service Data
-				0xAA, 0xFE,  // Eddystone ID
-				0x20,  // TLM flag
-				0x00,  // TLM version
-				0x00, 0x11,  // Battery voltage
-				0x50, 0x00,  // Beacon temperature
-				0x00, 0x00, 0x00, 0x00, // Advertising PDU count
-				0x00, 0x00, 0x00, 0x00  // Time since reboot
-				};
-
-		msgbuf[17] = 0x01;  //ble_env.adv_count;
-		ble_env.adv_count = 1;
-		// Update Advertising Time
-		//advertisement interval for given mode (units of 625us)
-		ble_env.adv_time = (ble_env.adv_count * APP_ADV_INT_MIN * 0.625) / 100;
-		memcpy(&msgbuf[18], ((char*) &ble_env.adv_time) + 3, 1);
-		memcpy(&msgbuf[19], ((char*) &ble_env.adv_time) + 2, 1);
-		memcpy(&msgbuf[20], ((char*) &ble_env.adv_time) + 1, 1);
-		memcpy(&msgbuf[21], ((char*) &ble_env.adv_time), 1);
-
-		memcpy(&cmd->info.host.adv_data[0], msgbuf, 22);
-		cmd->info.host.adv_data_len = 22;
+		memcpy(&cmd->info.host.adv_data[0], eddystone_tlm.adv_data,
+				EDDYSTONE_TLM_ADV_DATA_LEN);
+		cmd->info.host.adv_data_len = EDDYSTONE_TLM_ADV_DATA_LEN;
+		memcpy(&cmd->info.host.scan_rsp_data[0], eddystone_tlm_scan_rsp_data,
+				eddystone_tlm_scan_rsp_data_len);
+		cmd->info.host.scan_rsp_data_len = eddystone_tlm_scan_rsp_data_len;
 
 		/* Send the message */
 		ke_msg_send(cmd);
@@ -303,96 +257,75 @@ void Advertising_Start(void) {
 }
 
 void Advertising_Update() {
-
-	uint8_t device_name_length;
-	uint8_t device_name_avail_space;
-	uint8_t company_id[APP_COMPANY_ID_DATA_LEN] = APP_COMPANY_ID_DATA;
-
-	/* Prepare the GAPM_START_ADVERTISE_CMD message */
-	struct gapm_update_advertise_data_cmd *cmd = cmd = KE_MSG_ALLOC(
-			GAPM_UPDATE_ADVERTISE_DATA_CMD, TASK_GAPM, TASK_APP,
+	struct gapm_update_advertise_data_cmd *cmd;
+	uint16_t elapsed;
+
+	// Update Advertising Time (0.1 s = 160 * 625us); the remainder is
+	// carried over, so that intervals that are not a multiple of 100 ms
+	// do not make the time drift
+	elapsed = ble_env.adv_time_rem + ble_env.adv_interval;
+	ble_env.adv_time += elapsed / 160;
+	ble_env.adv_time_rem = elapsed % 160;
+	Advertising_Data_Encode();
+
+	/* Prepare the GAPM_UPDATE_ADVERTISE_DATA_CMD message */
+	cmd = KE_MSG_ALLOC(GAPM_UPDATE_ADVERTISE_DATA_CMD, TASK_GAPM, TASK_APP,
 			gapm_update_advertise_data_cmd);
 	cmd->operation = GAPM_UPDATE_ADVERTISE_DATA;
 
-	/* Set the scan response data */
-	cmd->scan_rsp_data_len = 0;
-	device_name_avail_space = (ADV_DATA_LEN - 3) - 2;
-	if (device_name_avail_space > 0) {
-		/* Add as much of the device name as possible */
-		device_name_length = strlen(APP_DFLT_DEVICE_NAME);
-		if (device_name_length > 0) {
-			/* Check available space */
-			device_name_length = co_min(device_name_length,
-					device_name_avail_space);
-			cmd->scan_rsp_data[cmd->scan_rsp_data_len] = device_name_length + 1;
-			/* Fill device name flag */
-			cmd->scan_rsp_data[cmd->scan_rsp_data_len + 1] = '\x09';
-			/* Copy device name */
-			memcpy(&cmd->scan_rsp_data[cmd->scan_rsp_data_len + 2],
-			APP_DFLT_DEVICE_NAME, device_name_length);
-			/* Update scan response data length */
-			cmd->scan_rsp_data_len += (device_name_length + 2);
-		}
-		/* If there is still space, add the company ID */
-		if (((ADV_DATA_LEN - 3) - cmd->scan_rsp_data_len - 2) >=
-		APP_COMPANY_ID_DATA_LEN) {
-			memcpy(&cmd->scan_rsp_data[cmd->scan_rsp_data_len], company_id,
-			APP_COMPANY_ID_DATA_LEN);
-			cmd->scan_rsp_data_len += APP_COMPANY_ID_DATA_LEN;
-		}
-	}
-
-	// Set TLM Frame
-	uint8_t msgbuf[] = {
-			0x03,  // Length of Service List
-			0x03,  // Param: Service List
-			0xAA, 0xFE,  // Eddystone ID
-			0x11,  // Length of Service Data ==> needs to be adjusted!
-			0x16,  // Service Data
-			0xAA, 0xFE,  // Eddystone ID
-			0x20,  // TLM flag
-			0x00,  // TLM version
-			0x00, 0x11,  // Battery voltage
-			0x50, 0x00,  // Beacon temperature
-			0x00, 0x00, 0x00, 0x00, // Advertising PDU count
-			0x00, 0x00, 0x00, 0x00  // Time since reboot
-			};
-
-	// Update Temperature Value
-	uint8_t temp1 = ble_env.temperature / 10000;
-	uint32_t temp2_long = ((ble_env.temperature % 10000)*256)/10000;
-	uint8_t temp2 = temp2_long;
-
-	memcpy(&msgbuf[12], ((char*) &temp1), 1);
-	memcpy(&msgbuf[13], ((char*) &temp2), 1);
-
-	// Update Battery Voltage
-	uint32_t battery_long = ble_env.batt_lvl;
-	battery_long = battery_long*2000 / 16384;
-	uint16_t battery = battery_long;
+	memcpy(&cmd->adv_data[0], eddystone_tlm.adv_data,
+			EDDYSTONE_TLM_ADV_DATA_LEN);
+	cmd->adv_data_len = EDDYSTONE_TLM_ADV_DATA_LEN;
+	memcpy(&cmd->scan_rsp_data[0], eddystone_tlm_scan_rsp_data,
+			eddystone_tlm_scan_rsp_data_len);
+	cmd->scan_rsp_data_len = eddystone_tlm_scan_rsp_data_len;
 
-	memcpy(&msgbuf[10], ((char*) &battery) + 1, 1);
-	memcpy(&msgbuf[11], ((char*) &battery), 1);
+	/* Send the message */
+	ke_msg_send(cmd);
+}
 
-	// Update Advertising Count
+/* ----------------------------------------------------------------------------
+ * Function      : void Advertising_Set_Interval(uint16_t interval)
+ * ----------------------------------------------------------------------------
+ * Description   : Change the advertising interval. Advertising is cancelled
+ *                 and restarted with the new interval from GAPM_CmpEvt.
+ * Inputs        : - interval   - Advertising interval (units of 625us)
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Advertising_Set_Interval(uint16_t interval) {
+	struct gapm_cancel_cmd *cmd;
 
-	memcpy(&msgbuf[14], ((char*) &ble_env.adv_count) + 3, 1);
-	memcpy(&msgbuf[15], ((char*) &ble_env.adv_count) + 2, 1);
-	memcpy(&msgbuf[16], ((char*) &ble_env.adv_count) + 1, 1);
-	memcpy(&msgbuf[17], ((char*) &ble_env.adv_count), 1);
+	if (ble_env.adv_interval == interval) {
+		return;
+	}
+	ble_env.adv_interval = interval;
 
-	// Update Advertising Time
-	ble_env.adv_time = (ble_env.adv_count * CFG_ADV_INTERVAL_MS) / 100;
-	memcpy(&msgbuf[18], ((char*) &ble_env.adv_time) + 3, 1);
-	memcpy(&msgbuf[19], ((char*) &ble_env.adv_time) + 2, 1);
-	memcpy(&msgbuf[20], ((char*) &ble_env.adv_time) + 1, 1);
-	memcpy(&msgbuf[21], ((char*) &ble_env.adv_time), 1);
+	if (ble_env.state == APPM_ADVERTISING) {
+		cmd = KE_MSG_ALLOC(GAPM_CANCEL_CMD, TASK_GAPM, TASK_APP,
+				gapm_cancel_cmd);
+		cmd->operation = GAPM_CANCEL;
+		ke_msg_send(cmd);
+	}
+}
 
-	memcpy(&cmd->adv_data[0], msgbuf, 22);
-	cmd->adv_data_len = 22;
+/* ----------------------------------------------------------------------------
+ * Function      : void Advertising_Data_Encode(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Patch the battery voltage, temperature, advertising count
+ *                 and time since power-up into the Eddystone TLM frame
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Advertising_Data_Encode(void) {
+	// Battery Voltage (mV)
+	uint32_t battery_long = ble_env.batt_lvl;
+	battery_long = battery_long*2000 / 16384;
 
-	/* Send the message */
-	ke_msg_send(cmd);
+	// Temperature Value is already in the 8.8 fixed-point format
+	Eddystone_TLM_Encode(battery_long, (uint16_t) ble_env.temperature,
+			ble_env.adv_count, ble_env.adv_time);
 }
 
 /* ----------------------------------------------------------------------------
@@ -457,8 +390,7 @@ int GAPM_CmpEvt(ke_msg_id_t const msg_id, struct gapm_cmp_evt const *param,
 	struct gapm_set_dev_config_cmd* cmd;
 
 	switch (param->operation) {
-	/* A reset has occurred, configure the device and
-	 * start a kernel timer for the application */
+	/* A reset has occurred, configure the device */
 	case (GAPM_RESET): {
 		if (param->status == GAP_ERR_NO_ERROR) {
 			/* Set the device configuration */
@@ -469,10 +401,6 @@ int GAPM_CmpEvt(ke_msg_id_t const msg_id, struct gapm_cmp_evt const *param,
 
 			/* Send message */
 			ke_msg_send(cmd);
-
-			/* Start a timer to be used as a periodic tick timer for
-			 * application */
-			ke_timer_set(APP_TEST_TIMER, TASK_APP, TIMER_200MS_SETTING);
 		}
 	}
 		break;
@@ -494,6 +422,17 @@ int GAPM_CmpEvt(ke_msg_id_t const msg_id, struct gapm_cmp_evt const *param,
 	}
 		break;
 
+		/* Advertising cancelled by Advertising_Set_Interval, restart it
+		 * with the new interval */
+	case (GAPM_ADV_NON_CONN):
+	case (GAPM_ADV_UNDIRECT): {
+		if (param->status == GAP_ERR_CANCELED) {
+			ble_env.state = APPM_READY;
+			Advertising_Start();
+		}
+	}
+		break;
+
 	default: {
 		/* No action required for other operations */
 	}
@@ -626,6 +565,10 @@ int GAPC_ConnectionReqInd(ke_msg_id_t const msg_id,
 		ke_msg_send(cfm);
 
 		BLE_SetServiceState(true, ble_env.conidx);
+
+		/* Request a larger ATT MTU and data length for bulk transfers */
+		BLE_Link_Configure(ble_env.conidx);
+		CustomService_Queue_Reset();
 	} else {
 		Advertising_Start();
 	}
@@ -680,6 +623,9 @@ int GAPC_DisconnectInd(ke_msg_id_t const msg_id,
 	ble_env.state = APPM_READY;
 
 	BLE_SetServiceState(false, ble_env.conidx);
+#if (HISTORY_ENABLE)
+	History_Download_Stop();
+#endif
 
 	Advertising_Start();
 
@@ -739,6 +685,90 @@ int GAPC_ParamUpdateReqInd(ke_msg_id_t const msg_id,
 	return (KE_MSG_CONSUMED);
 }
 
+/* ----------------------------------------------------------------------------
+ * Function      : void BLE_Link_Configure(uint8_t conidx)
+ * ----------------------------------------------------------------------------
+ * Description   : Start the ATT MTU exchange (up to MTU_MAX) and request the
+ *                 LE data length extension (TX_OCT_MAX) on a new connection;
+ *                 the results are reported by GATTC_MTU_CHANGED_IND and
+ *                 GAPC_LE_PKT_SIZE_IND
+ * Inputs        : conidx    - Connection index
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void BLE_Link_Configure(uint8_t conidx) {
+	struct gattc_exc_mtu_cmd *mtu_cmd;
+	struct gapc_set_le_pkt_size_cmd *pkt_cmd;
+
+	/* Default values until the peer has answered */
+	ble_env.mtu = ATT_DEFAULT_MTU;
+	ble_env.max_tx_octets = BLE_MIN_OCTETS;
+
+	mtu_cmd = KE_MSG_ALLOC(GATTC_EXC_MTU_CMD, KE_BUILD_ID(TASK_GATTC, conidx),
+			TASK_APP, gattc_exc_mtu_cmd);
+	mtu_cmd->operation = GATTC_MTU_EXCH;
+	mtu_cmd->seq_num = 0;
+	ke_msg_send(mtu_cmd);
+
+	pkt_cmd = KE_MSG_ALLOC(GAPC_SET_LE_PKT_SIZE_CMD,
+			KE_BUILD_ID(TASK_GAPC, conidx), TASK_APP,
+			gapc_set_le_pkt_size_cmd);
+	pkt_cmd->operation = GAPC_SET_LE_PKT_SIZE;
+	pkt_cmd->tx_octets = TX_OCT_MAX;
+	pkt_cmd->tx_time = TX_TIME_MAX;
+	ke_msg_send(pkt_cmd);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : int GATTC_MtuChangedInd(ke_msg_id_t const msg_id,
+ *                                         struct gattc_mtu_changed_ind
+ *                                         const *param,
+ *                                         ke_task_id_t const dest_id,
+ *                                         ke_task_id_t const src_id)
+ * ----------------------------------------------------------------------------
+ * Description   : Save the ATT MTU negotiated with the peer
+ * Inputs        : - msg_id     - Kernel message ID number
+ *                 - param      - Message parameters in format of
+ *                                struct gattc_mtu_changed_ind
+ *                 - dest_id    - Destination task ID number
+ *                 - src_id     - Source task ID number
+ * Outputs       : return value - Indicate if the message was consumed;
+ *                                compare with KE_MSG_CONSUMED
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+int GATTC_MtuChangedInd(ke_msg_id_t const msg_id,
+		struct gattc_mtu_changed_ind const *param, ke_task_id_t const dest_id,
+		ke_task_id_t const src_id) {
+	ble_env.mtu = param->mtu;
+
+	return (KE_MSG_CONSUMED);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : int GAPC_LePktSizeInd(ke_msg_id_t const msg_id,
+ *                                       struct gapc_le_pkt_size_ind
+ *                                       const *param,
+ *                                       ke_task_id_t const dest_id,
+ *                                       ke_task_id_t const src_id)
+ * ----------------------------------------------------------------------------
+ * Description   : Save the LE data length negotiated with the peer
+ * Inputs        : - msg_id     - Kernel message ID number
+ *                 - param      - Message parameters in format of
+ *                                struct gapc_le_pkt_size_ind
+ *                 - dest_id    - Destination task ID number
+ *                 - src_id     - Source task ID number
+ * Outputs       : return value - Indicate if the message was consumed;
+ *                                compare with KE_MSG_CONSUMED
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+int GAPC_LePktSizeInd(ke_msg_id_t const msg_id,
+		struct gapc_le_pkt_size_ind const *param, ke_task_id_t const dest_id,
+		ke_task_id_t const src_id) {
+	ble_env.max_tx_octets = param->max_tx_octets;
+
+	return (KE_MSG_CONSUMED);
+}
+
 /* ----------------------------------------------------------------------------
  * Function      : void BLE_SetServiceState(bool enable, uint8_t conidx)
  * ----------------------------------------------------------------------------
@@ -0,0 +1,33 @@
+/* ----------------------------------------------------------------------------
+ * eddystone_tlm.c
+ * - Eddystone TLM scan response (the advertising data and its encoder are in
+ *   eddystone_tlm_frame.c)
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+/* Scan response: device name followed by the company ID. Both are build
+ * constants, so it is encoded at compile time and stays in flash. */
+struct eddystone_tlm_scan_rsp_tag
+{
+    uint8_t name_length;
+    uint8_t name_flag;
+    char name[sizeof(APP_DFLT_DEVICE_NAME) - 1];
+    uint8_t company_id[APP_COMPANY_ID_DATA_LEN];
+} __attribute__ ((packed));
+
+_Static_assert(sizeof(struct eddystone_tlm_scan_rsp_tag) <=
+               EDDYSTONE_TLM_SCAN_RSP_LEN_MAX,
+               "device name and company ID exceed the scan response");
+
+static const struct eddystone_tlm_scan_rsp_tag eddystone_tlm_scan_rsp =
+{
+    .name_length = sizeof(APP_DFLT_DEVICE_NAME),
+    .name_flag = APP_DEVICE_NAME_FLAG,
+    .name = APP_DFLT_DEVICE_NAME,
+    .company_id = APP_COMPANY_ID_DATA
+};
+
+const uint8_t *const eddystone_tlm_scan_rsp_data =
+    (const uint8_t *)&eddystone_tlm_scan_rsp;
+const uint8_t eddystone_tlm_scan_rsp_data_len = sizeof(eddystone_tlm_scan_rsp);
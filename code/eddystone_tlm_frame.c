@@ -0,0 +1,62 @@
+/* ----------------------------------------------------------------------------
+ * eddystone_tlm_frame.c
+ * - Eddystone TLM advertising data and field encoder, shared with
+ *   tools/tlm_layout_test.c
+ * ------------------------------------------------------------------------- */
+
+#include "../include/eddystone_tlm.h"
+
+/* Pre-encoded frame; kept in RAM so it is retained in sleep mode. The
+ * advertising data starts from the template. */
+struct eddystone_tlm_env_tag eddystone_tlm =
+{
+    .adv_data = EDDYSTONE_TLM_ADV_DATA
+};
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Eddystone_TLM_Patch(uint8_t offset,
+ *                                                 uint32_t value,
+ *                                                 uint8_t length)
+ * ----------------------------------------------------------------------------
+ * Description   : Write a big-endian field of the advertising data
+ * Inputs        : - offset     - Offset of the field in the advertising data
+ *                 - value      - Field value
+ *                 - length     - Field length in bytes (2 or 4)
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Eddystone_TLM_Patch(uint8_t offset, uint32_t value,
+                                uint8_t length)
+{
+    uint8_t *field = &eddystone_tlm.adv_data[offset];
+
+    while (length > 0)
+    {
+        length--;
+        *field++ = (uint8_t)(value >> (8 * length));
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Eddystone_TLM_Encode(uint16_t vbatt_mv, uint16_t temp,
+ *                                           uint32_t adv_cnt,
+ *                                           uint32_t sec_cnt)
+ * ----------------------------------------------------------------------------
+ * Description   : Patch the TLM fields of the pre-encoded advertising data
+ * Inputs        : - vbatt_mv   - Battery voltage in mV (0 if not supported)
+ *                 - temp       - Beacon temperature, signed 8.8 fixed-point
+ *                                in degrees Celsius (0x8000 if not
+ *                                supported)
+ *                 - adv_cnt    - Advertising PDU count since power-up
+ *                 - sec_cnt    - Time since power-up in 0.1 s
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Eddystone_TLM_Encode(uint16_t vbatt_mv, uint16_t temp,
+                          uint32_t adv_cnt, uint32_t sec_cnt)
+{
+    Eddystone_TLM_Patch(EDDYSTONE_TLM_VBATT_OFFSET, vbatt_mv, 2);
+    Eddystone_TLM_Patch(EDDYSTONE_TLM_TEMP_OFFSET, temp, 2);
+    Eddystone_TLM_Patch(EDDYSTONE_TLM_ADV_CNT_OFFSET, adv_cnt, 4);
+    Eddystone_TLM_Patch(EDDYSTONE_TLM_SEC_CNT_OFFSET, sec_cnt, 4);
+}
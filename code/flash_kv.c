@@ -0,0 +1,557 @@
+/* ----------------------------------------------------------------------------
+ * flash_kv.c
+ * - Log-structured key/value store in flash
+ * ------------------------------------------------------------------------- */
+
+#include <string.h>
+#include "../include/flash_kv.h"
+
+struct flash_kv_env_tag flash_kv;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint32_t Flash_KV_Offset(uint8_t page, uint16_t unit)
+ * ----------------------------------------------------------------------------
+ * Description   : Offset of a unit in the store
+ * Inputs        : - page       - Page
+ *                 - unit       - Unit in the page
+ * Outputs       : return value - Offset in bytes
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint32_t Flash_KV_Offset(uint8_t page, uint16_t unit)
+{
+    return (uint32_t)page * FLASH_KV_PAGE_SIZE + (uint32_t)unit * FLASH_KV_UNIT;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Flash_KV_Seq_After(uint32_t a, uint32_t b)
+ * ----------------------------------------------------------------------------
+ * Description   : Compare two page sequence numbers, which wrap around at
+ *                 FLASH_KV_SEQ_MASK
+ * Inputs        : - a          - Sequence number
+ *                 - b          - Sequence number
+ * Outputs       : return value - true if a is more recent than b
+ * Assumptions   : The pages of the store are less than half the sequence
+ *                 range apart
+ * ------------------------------------------------------------------------- */
+static bool Flash_KV_Seq_After(uint32_t a, uint32_t b)
+{
+    uint32_t diff = (a - b) & FLASH_KV_SEQ_MASK;
+
+    return (diff != 0 && diff <= (FLASH_KV_SEQ_MASK >> 1));
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint8_t Flash_KV_Byte(uint32_t offset)
+ * ----------------------------------------------------------------------------
+ * Description   : Read a byte of the store
+ * Inputs        : - offset     - Offset in bytes
+ * Outputs       : return value - Byte
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint8_t Flash_KV_Byte(uint32_t offset)
+{
+    return (uint8_t)(Flash_KV_Port_Read(offset & ~3U) >> ((offset & 3) * 8));
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint16_t Flash_KV_CRC(uint16_t crc, uint8_t byte)
+ * ----------------------------------------------------------------------------
+ * Description   : Add a byte to a CRC-16/CCITT-FALSE
+ * Inputs        : - crc        - CRC so far
+ *                 - byte       - Byte
+ * Outputs       : return value - Updated CRC
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint16_t Flash_KV_CRC(uint16_t crc, uint8_t byte)
+{
+    uint8_t bit;
+
+    crc ^= (uint16_t)byte << 8;
+    for (bit = 0; bit < 8; bit++)
+    {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) :
+                               (uint16_t)(crc << 1);
+    }
+
+    return crc;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Flash_KV_Erased(uint8_t page, uint16_t unit)
+ * ----------------------------------------------------------------------------
+ * Description   : Check if a unit is erased
+ * Inputs        : - page       - Page
+ *                 - unit       - Unit in the page
+ * Outputs       : return value - true if both words are erased
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Flash_KV_Erased(uint8_t page, uint16_t unit)
+{
+    uint32_t offset = Flash_KV_Offset(page, unit);
+
+    return (Flash_KV_Port_Read(offset) == FLASH_KV_ERASED &&
+            Flash_KV_Port_Read(offset + 4) == FLASH_KV_ERASED);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Flash_KV_Page_Valid(uint8_t page, uint32_t *seq)
+ * ----------------------------------------------------------------------------
+ * Description   : Check the header of a page
+ * Inputs        : - page       - Page
+ * Outputs       : - seq        - Sequence number of the page
+ *                 return value - true if the page header is valid
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Flash_KV_Page_Valid(uint8_t page, uint32_t *seq)
+{
+    uint32_t offset = Flash_KV_Offset(page, 0);
+    uint32_t header = Flash_KV_Port_Read(offset);
+
+    *seq = header & FLASH_KV_SEQ_MASK;
+
+    return (Flash_KV_Port_Read(offset + 4) == ~header &&
+            (header >> 24) == FLASH_KV_MAGIC);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint8_t Flash_KV_Record(uint8_t page, uint16_t unit,
+ *                                               uint8_t *key, uint8_t *length)
+ * ----------------------------------------------------------------------------
+ * Description   : Check the record starting at a unit
+ * Inputs        : - page       - Page
+ *                 - unit       - Unit of the record header
+ * Outputs       : - key        - Key of the record
+ *                 - length     - Value length
+ *                 return value - Number of units of the record, 0 if there
+ *                                is no valid record
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint8_t Flash_KV_Record(uint8_t page, uint16_t unit, uint8_t *key,
+                               uint8_t *length)
+{
+    uint32_t offset = Flash_KV_Offset(page, unit);
+    uint32_t header = Flash_KV_Port_Read(offset);
+    uint16_t crc = 0xFFFF;
+    uint8_t units;
+    uint8_t i;
+
+    if (Flash_KV_Port_Read(offset + 4) != ~header)
+    {
+        return 0;
+    }
+
+    *key = (uint8_t)header;
+    *length = (uint8_t)(header >> 8);
+    units = 1 + (*length + FLASH_KV_UNIT - 1) / FLASH_KV_UNIT;
+    if (*key >= FLASH_KV_KEYS || *length > FLASH_KV_VALUE_MAX ||
+        unit + units > FLASH_KV_PAGE_UNITS)
+    {
+        return 0;
+    }
+
+    crc = Flash_KV_CRC(crc, *key);
+    crc = Flash_KV_CRC(crc, *length);
+    for (i = 0; i < *length; i++)
+    {
+        crc = Flash_KV_CRC(crc, Flash_KV_Byte(offset + FLASH_KV_UNIT + i));
+    }
+
+    return (crc == (uint16_t)(header >> 16)) ? units : 0;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Flash_KV_Page_Scan(uint8_t page)
+ * ----------------------------------------------------------------------------
+ * Description   : Record the location of the records of a page as the latest
+ *                 ones of their keys; the units of records interrupted by a
+ *                 power loss are skipped one at a time
+ * Inputs        : - page       - Page
+ * Outputs       : None
+ * Assumptions   : The pages are scanned from the oldest to the newest
+ * ------------------------------------------------------------------------- */
+static void Flash_KV_Page_Scan(uint8_t page)
+{
+    uint16_t unit = 1;
+    uint8_t units;
+    uint8_t key;
+    uint8_t length;
+
+    while (unit < FLASH_KV_PAGE_UNITS)
+    {
+        units = Flash_KV_Record(page, unit, &key, &length);
+        if (units == 0)
+        {
+            unit++;
+            continue;
+        }
+
+        flash_kv.page[key] = page;
+        flash_kv.unit[key] = unit;
+        unit += units;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint16_t Flash_KV_Page_End(uint8_t page)
+ * ----------------------------------------------------------------------------
+ * Description   : Find the end of the programmed part of a page, including
+ *                 the units of a record interrupted by a power loss
+ * Inputs        : - page       - Page
+ * Outputs       : return value - Unit following the last programmed unit
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint16_t Flash_KV_Page_End(uint8_t page)
+{
+    uint16_t unit = FLASH_KV_PAGE_UNITS;
+
+    while (unit > 0 && Flash_KV_Erased(page, unit - 1))
+    {
+        unit--;
+    }
+
+    return unit;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Flash_KV_Erase(uint8_t page)
+ * ----------------------------------------------------------------------------
+ * Description   : Erase a page and forget the records it held
+ * Inputs        : - page       - Page
+ * Outputs       : return value - false if the page could not be erased
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Flash_KV_Erase(uint8_t page)
+{
+    uint8_t key;
+    bool ok;
+
+    ok = Flash_KV_Port_Erase(page);
+    flash_kv.erases++;
+
+    for (key = 0; key < FLASH_KV_KEYS; key++)
+    {
+        if (flash_kv.page[key] == page)
+        {
+            flash_kv.page[key] = FLASH_KV_NONE;
+        }
+    }
+
+    return ok;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Flash_KV_Append(uint8_t key,
+ *                                           const uint8_t *value,
+ *                                           uint8_t length)
+ * ----------------------------------------------------------------------------
+ * Description   : Append a record to the active page: the value units first,
+ *                 then, if they have been programmed, the header unit, which
+ *                 commits the record
+ * Inputs        : - key        - Key
+ *                 - value      - Value
+ *                 - length     - Value length
+ * Outputs       : return value - false if the record does not fit in the
+ *                                active page or could not be programmed
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Flash_KV_Append(uint8_t key, const uint8_t *value, uint8_t length)
+{
+    uint8_t units = 1 + (length + FLASH_KV_UNIT - 1) / FLASH_KV_UNIT;
+    uint16_t unit = flash_kv.free;
+    uint32_t words[2];
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+    uint8_t n;
+    bool ok = true;
+
+    if (unit + units > FLASH_KV_PAGE_UNITS)
+    {
+        return false;
+    }
+
+    crc = Flash_KV_CRC(crc, key);
+    crc = Flash_KV_CRC(crc, length);
+    for (i = 0; i < length; i += FLASH_KV_UNIT)
+    {
+        n = (length - i < FLASH_KV_UNIT) ? (length - i) : FLASH_KV_UNIT;
+        memset(words, 0, sizeof(words));
+        memcpy(words, &value[i], n);
+        ok &= Flash_KV_Port_Write(
+            Flash_KV_Offset(flash_kv.active, unit + 1 + i / FLASH_KV_UNIT),
+            words[0], words[1]);
+    }
+    for (i = 0; i < length; i++)
+    {
+        crc = Flash_KV_CRC(crc, value[i]);
+    }
+
+    if (ok)
+    {
+        words[0] = key | (uint32_t)length << 8 | (uint32_t)crc << 16;
+        ok = Flash_KV_Port_Write(Flash_KV_Offset(flash_kv.active, unit),
+                                 words[0], ~words[0]);
+    }
+
+    /* The units are used even if programming failed */
+    flash_kv.free += units;
+    flash_kv.units += units;
+    if (ok)
+    {
+        flash_kv.page[key] = flash_kv.active;
+        flash_kv.unit[key] = unit;
+    }
+
+    return ok;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Flash_KV_Collect(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Copy the latest records held in the oldest page (the page
+ *                 after the active one) to the active page, then erase it;
+ *                 the page after the active one is then erased again. The
+ *                 page is only erased once all its records have been copied.
+ * Inputs        : None
+ * Outputs       : return value - false if a record could not be copied (the
+ *                                page is kept) or the page not erased
+ * Assumptions   : The records to copy fit in the active page
+ * ------------------------------------------------------------------------- */
+static bool Flash_KV_Collect(void)
+{
+    uint8_t oldest = (flash_kv.active + 1) % FLASH_KV_PAGES;
+    uint8_t value[FLASH_KV_VALUE_MAX];
+    uint8_t key;
+    uint8_t record_key;
+    uint8_t length;
+
+    if (Flash_KV_Page_End(oldest) == 0)
+    {
+        return true;
+    }
+
+    for (key = 0; key < FLASH_KV_KEYS; key++)
+    {
+        if (flash_kv.page[key] == oldest &&
+            Flash_KV_Record(oldest, flash_kv.unit[key], &record_key,
+                            &length) > 0)
+        {
+            if (!Flash_KV_Read(key, value, length) ||
+                !Flash_KV_Append(key, value, length))
+            {
+                return false;
+            }
+        }
+    }
+
+    return Flash_KV_Erase(oldest);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Flash_KV_Page_Open(uint8_t page)
+ * ----------------------------------------------------------------------------
+ * Description   : Make an erased page the active page. A page left
+ *                 programmed by a failed erase is erased again first, unless
+ *                 it still holds latest records (failed copy).
+ * Inputs        : - page       - Page
+ * Outputs       : return value - false if the page could not be erased or
+ *                                its header programmed; the active page is
+ *                                then unchanged
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Flash_KV_Page_Open(uint8_t page)
+{
+    uint32_t header;
+    uint32_t seq = (flash_kv.seq + 1) & FLASH_KV_SEQ_MASK;
+    uint8_t key;
+
+    if (Flash_KV_Page_End(page) > 0)
+    {
+        for (key = 0; key < FLASH_KV_KEYS; key++)
+        {
+            if (flash_kv.page[key] == page)
+            {
+                return false;
+            }
+        }
+        if (!Flash_KV_Erase(page))
+        {
+            return false;
+        }
+    }
+
+    flash_kv.units++;
+    header = (uint32_t)FLASH_KV_MAGIC << 24 | seq;
+    if (!Flash_KV_Port_Write(Flash_KV_Offset(page, 0), header, ~header))
+    {
+        return false;
+    }
+
+    flash_kv.seq = seq;
+    flash_kv.active = page;
+    flash_kv.free = 1;
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Flash_KV_Roll(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Change the active page to the next page and collect the
+ *                 oldest page
+ * Inputs        : None
+ * Outputs       : return value - false if the page change or the collection
+ *                                failed; a failed collection is completed
+ *                                by Flash_KV_Initialize at the next boot
+ * Assumptions   : The page after the active page is erased
+ * ------------------------------------------------------------------------- */
+static bool Flash_KV_Roll(void)
+{
+    return (Flash_KV_Page_Open((flash_kv.active + 1) % FLASH_KV_PAGES) &&
+            Flash_KV_Collect());
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Flash_KV_Initialize(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Locate the latest record of each key, reading each page
+ *                 once, and complete a page change interrupted by a power
+ *                 loss. An empty or unreadable store is formatted.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Flash_KV_Initialize(void)
+{
+    uint32_t seq[FLASH_KV_PAGES];
+    bool valid[FLASH_KV_PAGES];
+    uint8_t page;
+    uint8_t next;
+    bool found = false;
+
+    memset(&flash_kv, 0, sizeof(flash_kv));
+    memset(flash_kv.page, FLASH_KV_NONE, sizeof(flash_kv.page));
+
+    for (page = 0; page < FLASH_KV_PAGES; page++)
+    {
+        valid[page] = Flash_KV_Page_Valid(page, &seq[page]);
+        if (valid[page] && (!found || Flash_KV_Seq_After(seq[page],
+                                                         flash_kv.seq)))
+        {
+            flash_kv.active = page;
+            flash_kv.seq = seq[page];
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        /* Format */
+        for (page = 0; page < FLASH_KV_PAGES; page++)
+        {
+            if (Flash_KV_Page_End(page) > 0)
+            {
+                Flash_KV_Erase(page);
+            }
+        }
+        /* Without an active page, the writes fail until a page can be
+         * opened */
+        flash_kv.seq = 0;
+        flash_kv.free = FLASH_KV_PAGE_UNITS;
+        Flash_KV_Page_Open(0);
+        return;
+    }
+
+    /* Scan the valid pages from the oldest to the newest: in ring order
+     * starting after the active page */
+    for (page = 1; page <= FLASH_KV_PAGES; page++)
+    {
+        next = (flash_kv.active + page) % FLASH_KV_PAGES;
+        if (valid[next] && !Flash_KV_Seq_After(seq[next], flash_kv.seq))
+        {
+            Flash_KV_Page_Scan(next);
+        }
+    }
+    flash_kv.free = Flash_KV_Page_End(flash_kv.active);
+
+    /* The page after the active page has to be erased: finish the copy and
+     * erase of an interrupted or failed page change. If it fails again, the
+     * page is kept and the writes fail once the active page is full. */
+    Flash_KV_Collect();
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool Flash_KV_Read(uint8_t key, void *value, uint8_t length)
+ * ----------------------------------------------------------------------------
+ * Description   : Read the value of a key
+ * Inputs        : - key        - Key
+ *                 - length     - Expected value length
+ * Outputs       : - value      - Value
+ *                 return value - false if the key has no value of this length
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+bool Flash_KV_Read(uint8_t key, void *value, uint8_t length)
+{
+    uint32_t offset;
+    uint8_t i;
+
+    if (key >= FLASH_KV_KEYS || flash_kv.page[key] == FLASH_KV_NONE)
+    {
+        return false;
+    }
+
+    offset = Flash_KV_Offset(flash_kv.page[key], flash_kv.unit[key]);
+    if ((uint8_t)(Flash_KV_Port_Read(offset) >> 8) != length)
+    {
+        return false;
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        ((uint8_t *)value)[i] = Flash_KV_Byte(offset + FLASH_KV_UNIT + i);
+    }
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool Flash_KV_Write(uint8_t key, const void *value,
+ *                                     uint8_t length)
+ * ----------------------------------------------------------------------------
+ * Description   : Write the value of a key, unless it is unchanged. When the
+ *                 active page is full, the next page is opened and the oldest
+ *                 page collected.
+ * Inputs        : - key        - Key
+ *                 - value      - Value
+ *                 - length     - Value length
+ * Outputs       : return value - false if the value could not be written
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+bool Flash_KV_Write(uint8_t key, const void *value, uint8_t length)
+{
+    uint8_t current[FLASH_KV_VALUE_MAX];
+
+    if (key >= FLASH_KV_KEYS || length > FLASH_KV_VALUE_MAX)
+    {
+        return false;
+    }
+
+    if (Flash_KV_Read(key, current, length) &&
+        memcmp(current, value, length) == 0)
+    {
+        return true;
+    }
+
+    flash_kv.value_bytes += length;
+    if (Flash_KV_Append(key, value, length))
+    {
+        return true;
+    }
+
+    /* Page full (or damaged unit): change page and retry once */
+    if (!Flash_KV_Roll())
+    {
+        return false;
+    }
+
+    return Flash_KV_Append(key, value, length);
+}
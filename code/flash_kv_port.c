@@ -0,0 +1,53 @@
+/* ----------------------------------------------------------------------------
+ * flash_kv_port.c
+ * - Flash access of the key/value store on the RSL10 main flash
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint32_t Flash_KV_Port_Read(uint32_t offset)
+ * ----------------------------------------------------------------------------
+ * Description   : Read a word of the store
+ * Inputs        : - offset     - Offset in the store, word aligned
+ * Outputs       : return value - Word
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint32_t Flash_KV_Port_Read(uint32_t offset)
+{
+    return *(volatile uint32_t *)(FLASH_KV_BASE + offset);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool Flash_KV_Port_Write(uint32_t offset, uint32_t word0,
+ *                                          uint32_t word1)
+ * ----------------------------------------------------------------------------
+ * Description   : Program a word pair of the store with the ROM flash
+ *                 library
+ * Inputs        : - offset     - Offset in the store, unit aligned
+ *                 - word0      - First word
+ *                 - word1      - Second word
+ * Outputs       : return value - false if programming failed
+ * Assumptions   : The flash delay has been configured for the system clock
+ * ------------------------------------------------------------------------- */
+bool Flash_KV_Port_Write(uint32_t offset, uint32_t word0, uint32_t word1)
+{
+    return (Flash_WriteWordPair(FLASH_KV_BASE + offset, word0, word1) ==
+            FLASH_ERR_NONE);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool Flash_KV_Port_Erase(uint8_t page)
+ * ----------------------------------------------------------------------------
+ * Description   : Erase a page (flash sector) of the store with the ROM flash
+ *                 library
+ * Inputs        : - page       - Page
+ * Outputs       : return value - false if the erase failed
+ * Assumptions   : The flash delay has been configured for the system clock
+ * ------------------------------------------------------------------------- */
+bool Flash_KV_Port_Erase(uint8_t page)
+{
+    return (Flash_EraseSector(FLASH_KV_BASE +
+                              (uint32_t)page * FLASH_KV_PAGE_SIZE) ==
+            FLASH_ERR_NONE);
+}
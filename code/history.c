@@ -0,0 +1,354 @@
+/* ----------------------------------------------------------------------------
+ * history.c
+ * - Temperature history ring with delta-compressed storage
+ * ------------------------------------------------------------------------- */
+
+#include <string.h>
+#include "../include/history.h"
+
+#if (HISTORY_ENABLE)
+
+/* History ring; kept in .noinit so it survives sleep mode and warm resets */
+struct history_env_tag history __attribute__ ((section(".noinit")));
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint8_t History_Varint_Put(uint8_t *buf,
+ *                                                   uint32_t value)
+ * ----------------------------------------------------------------------------
+ * Description   : Encode a value as a varint (7 bits per byte, LSB first)
+ * Inputs        : - buf        - Destination, at least 5 bytes
+ *                 - value      - Value to encode
+ * Outputs       : return value - Number of bytes written
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint8_t History_Varint_Put(uint8_t *buf, uint32_t value)
+{
+    uint8_t len = 0;
+
+    while (value >= 0x80)
+    {
+        buf[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buf[len++] = (uint8_t)value;
+
+    return len;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool History_Varint_Get(const struct history_block
+ *                                                *blk, uint8_t *offset,
+ *                                                uint32_t *value)
+ * ----------------------------------------------------------------------------
+ * Description   : Decode a varint from the data of a block
+ * Inputs        : - blk        - Block
+ *                 - offset     - Decoding position, updated
+ * Outputs       : - value      - Decoded value
+ *                 return value - false if the varint exceeds the used data
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool History_Varint_Get(const struct history_block *blk,
+                               uint8_t *offset, uint32_t *value)
+{
+    uint8_t shift = 0;
+    uint8_t byte;
+
+    *value = 0;
+    do
+    {
+        if (*offset >= blk->used || shift > 28)
+        {
+            return false;
+        }
+        byte = blk->data[(*offset)++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void History_Initialize(bool keep)
+ * ----------------------------------------------------------------------------
+ * Description   : Keep the samples retained in .noinit if they are valid,
+ *                 otherwise clear the history
+ * Inputs        : - keep       - Keep the retained samples (warm resume)
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void History_Initialize(bool keep)
+{
+    if (!keep || history.magic != HISTORY_MAGIC ||
+        history.head >= HISTORY_BLOCKS || history.nb > HISTORY_BLOCKS)
+    {
+        History_Clear();
+    }
+    history.samples = 0;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void History_Clear(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Remove all samples and restart the sequence numbers at 0
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void History_Clear(void)
+{
+    history.magic = HISTORY_MAGIC;
+    history.head = 0;
+    history.nb = 0;
+    history.next_seq = 0;
+    history.samples = 0;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void History_Append(uint32_t time, int16_t temperature)
+ * ----------------------------------------------------------------------------
+ * Description   : Append a sample; a new block is started (dropping the
+ *                 oldest one if the ring is full) when the current block
+ *                 cannot hold the encoded sample
+ * Inputs        : - time        - Time since power-up in 0.1 s
+ *                 - temperature - Signed 8.8 fixed-point temperature
+ * Outputs       : None
+ * Assumptions   : Not called concurrently with an iteration
+ * ------------------------------------------------------------------------- */
+void History_Append(uint32_t time, int16_t temperature)
+{
+    struct history_block *blk = &history.blocks[history.head];
+    uint8_t record[HISTORY_RECORD_MAX];
+    int16_t temp = temperature >> 4;
+    int32_t dtime = (int32_t)(time - history.last_time);
+    int32_t dod = dtime - history.last_dtime;
+    int32_t dtemp = temp - history.last_temp;
+    uint8_t len;
+
+    if (history.nb > 0)
+    {
+        len = History_Varint_Put(record, (((uint32_t)dtemp << 1 ^
+                                           (uint32_t)(dtemp >> 31)) << 1) |
+                                         (dod != 0));
+        if (dod != 0)
+        {
+            len += History_Varint_Put(&record[len], (uint32_t)dod << 1 ^
+                                                    (uint32_t)(dod >> 31));
+        }
+
+        if (blk->count < UINT8_MAX && blk->used + len <= HISTORY_DATA_SIZE)
+        {
+            memcpy(&blk->data[blk->used], record, len);
+            blk->used += len;
+            blk->count++;
+
+            history.last_dtime = dtime;
+            history.last_time = time;
+            history.last_temp = temp;
+            history.next_seq++;
+            return;
+        }
+
+        /* Start a new block */
+        history.head = (history.head + 1) % HISTORY_BLOCKS;
+        blk = &history.blocks[history.head];
+    }
+
+    if (history.nb < HISTORY_BLOCKS)
+    {
+        history.nb++;
+    }
+
+    blk->seq = history.next_seq;
+    blk->time = time;
+    blk->temperature = temp;
+    blk->count = 1;
+    blk->used = 0;
+
+    history.last_dtime = 0;
+    history.last_time = time;
+    history.last_temp = temp;
+    history.next_seq++;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void History_Iterate_Load(struct history_iter *it,
+ *                                                  uint8_t index)
+ * ----------------------------------------------------------------------------
+ * Description   : Position an iterator on the first sample of a block
+ * Inputs        : - it         - Iterator
+ *                 - index      - Ring index of the block
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void History_Iterate_Load(struct history_iter *it, uint8_t index)
+{
+    const struct history_block *blk = &history.blocks[index];
+
+    it->index = index;
+    it->offset = 0;
+    it->pending = blk->count;
+    it->dtime = 0;
+    it->sample.seq = blk->seq;
+    it->sample.time = blk->time;
+    it->sample.temperature = blk->temperature;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool History_Iterate_Advance(struct history_iter *it)
+ * ----------------------------------------------------------------------------
+ * Description   : Decode the sample following the current one
+ * Inputs        : - it         - Iterator
+ * Outputs       : return value - false if there is no further sample
+ * Assumptions   : it->pending > 0
+ * ------------------------------------------------------------------------- */
+static bool History_Iterate_Advance(struct history_iter *it)
+{
+    const struct history_block *blk = &history.blocks[it->index];
+    uint32_t value;
+    uint32_t dod = 0;
+
+    it->pending--;
+    if (it->pending == 0)
+    {
+        if (it->left == 0)
+        {
+            return false;
+        }
+        it->left--;
+        History_Iterate_Load(it, (it->index + 1) % HISTORY_BLOCKS);
+        return (it->pending > 0);
+    }
+
+    if (!History_Varint_Get(blk, &it->offset, &value) ||
+        ((value & 1) && !History_Varint_Get(blk, &it->offset, &dod)))
+    {
+        /* Inconsistent block, e.g. after a reset during an append */
+        it->pending = 0;
+        it->left = 0;
+        return false;
+    }
+
+    value >>= 1;
+    it->dtime += (int32_t)(dod >> 1 ^ (0 - (dod & 1)));
+    it->sample.seq++;
+    it->sample.time += it->dtime;
+    it->sample.temperature += (int16_t)(value >> 1 ^ (0 - (value & 1)));
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint8_t History_Block_Index(uint32_t seq,
+ *                                                   uint8_t *left)
+ * ----------------------------------------------------------------------------
+ * Description   : Find the last block starting at or before a sequence
+ *                 number, or the oldest block if the sample has been dropped
+ * Inputs        : - seq        - Sequence number
+ * Outputs       : - left       - Number of blocks after the block found
+ *                 return value - Ring index of the block
+ * Assumptions   : history.nb > 0
+ * ------------------------------------------------------------------------- */
+static uint8_t History_Block_Index(uint32_t seq, uint8_t *left)
+{
+    uint8_t index;
+    uint8_t next;
+
+    index = (history.head + HISTORY_BLOCKS - (history.nb - 1)) %
+            HISTORY_BLOCKS;
+    *left = history.nb - 1;
+    next = (index + 1) % HISTORY_BLOCKS;
+    while (*left > 0 && history.blocks[next].seq <= seq)
+    {
+        index = next;
+        next = (index + 1) % HISTORY_BLOCKS;
+        (*left)--;
+    }
+
+    return index;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : const struct history_block *History_Block_Find(uint32_t
+ *                                                                seq)
+ * ----------------------------------------------------------------------------
+ * Description   : Get the block holding the sample with the given sequence
+ *                 number, or the oldest block if the sample has been dropped
+ * Inputs        : - seq        - Sequence number
+ * Outputs       : return value - Block, NULL if there is no such or later
+ *                                sample
+ * Assumptions   : The newest block still grows with each History_Append
+ * ------------------------------------------------------------------------- */
+const struct history_block *History_Block_Find(uint32_t seq)
+{
+    uint8_t left;
+
+    if (history.nb == 0 || seq >= history.next_seq)
+    {
+        return NULL;
+    }
+
+    return &history.blocks[History_Block_Index(seq, &left)];
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool History_Iterate_Start(struct history_iter *it,
+ *                                            uint32_t seq)
+ * ----------------------------------------------------------------------------
+ * Description   : Position an iterator on the sample with the given sequence
+ *                 number, or on the oldest sample if it has been dropped
+ * Inputs        : - it         - Iterator
+ *                 - seq        - Sequence number of the first sample to read
+ * Outputs       : return value - false if there is no such or later sample
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+bool History_Iterate_Start(struct history_iter *it, uint32_t seq)
+{
+    it->pending = 0;
+    if (history.nb == 0 || seq >= history.next_seq)
+    {
+        return false;
+    }
+
+    History_Iterate_Load(it, History_Block_Index(seq, &it->left));
+    while (it->pending > 0 && it->sample.seq < seq)
+    {
+        if (!History_Iterate_Advance(it))
+        {
+            it->pending = 0;
+        }
+    }
+
+    return (it->pending > 0);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool History_Iterate_Next(struct history_iter *it,
+ *                                           struct history_sample *sample)
+ * ----------------------------------------------------------------------------
+ * Description   : Read the current sample and advance to the next one
+ * Inputs        : - it         - Iterator
+ * Outputs       : - sample     - Sample, in 8.8 fixed-point
+ *                 return value - false if the end of the history is reached
+ * Assumptions   : History_Iterate_Start has been called
+ * ------------------------------------------------------------------------- */
+bool History_Iterate_Next(struct history_iter *it,
+                          struct history_sample *sample)
+{
+    if (it->pending == 0)
+    {
+        return false;
+    }
+
+    *sample = it->sample;
+    sample->temperature = (int16_t)(it->sample.temperature * 16);
+
+    if (!History_Iterate_Advance(it))
+    {
+        it->pending = 0;
+    }
+
+    return true;
+}
+
+#endif /* HISTORY_ENABLE */
@@ -0,0 +1,219 @@
+/* ----------------------------------------------------------------------------
+ * history_download.c
+ * - Bulk history download over the custom service
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+#if (HISTORY_ENABLE)
+
+struct history_download_env_tag history_download;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void History_Download_Header(uint8_t *chunk,
+ *                                                    uint32_t seq,
+ *                                                    uint8_t offset)
+ * ----------------------------------------------------------------------------
+ * Description   : Write the header of a chunk
+ * Inputs        : - chunk      - Chunk, at least HISTORY_DOWNLOAD_HEADER_SIZE
+ *                                bytes
+ *                 - seq        - First sample of the block
+ *                 - offset     - Offset of the chunk in the block
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void History_Download_Header(uint8_t *chunk, uint32_t seq,
+                                   uint8_t offset)
+{
+    chunk[0] = (uint8_t)seq;
+    chunk[1] = (uint8_t)(seq >> 8);
+    chunk[2] = (uint8_t)(seq >> 16);
+    chunk[3] = (uint8_t)(seq >> 24);
+    chunk[4] = offset;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool History_Download_Notify(uint8_t *chunk,
+ *                                                   uint16_t length)
+ * ----------------------------------------------------------------------------
+ * Description   : Send a chunk, recording where to resume from if it is
+ *                 dropped
+ * Inputs        : - chunk      - Chunk
+ *                 - length     - Length of the chunk
+ * Outputs       : return value - false if the notification window is full
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool History_Download_Notify(uint8_t *chunk, uint16_t length)
+{
+    uint16_t seq_num;
+
+    if (!CustomService_Notify(history_download.conidx, CS_IDX_TX_VALUE_VAL,
+                              chunk, length, CS_NTF_SRC_DOWNLOAD, &seq_num))
+    {
+        return false;
+    }
+
+    history_download.resume[seq_num % CS_NTF_WINDOW_MAX] =
+        history_download.next;
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void History_Download_Continue(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Send chunks until the notification window is full or the
+ *                 end of the history is reached
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void History_Download_Continue(void)
+{
+    uint8_t chunk[HISTORY_DOWNLOAD_CHUNK_MAX];
+    const struct history_block *blk = NULL;
+    uint16_t len;
+
+    while (history_download.active && CustomService_Credits() > 0)
+    {
+        /* Continue the current block, unless it has been dropped */
+        if (history_download.offset > 0)
+        {
+            blk = History_Block_Find(history_download.blk_seq);
+            if (blk == NULL || blk->seq != history_download.blk_seq)
+            {
+                history_download.offset = 0;
+            }
+        }
+
+        if (history_download.offset == 0)
+        {
+            blk = History_Block_Find(history_download.next);
+            if (blk == NULL)
+            {
+                /* End of the history */
+                History_Download_Header(chunk, history_download.next,
+                                        HISTORY_DOWNLOAD_END);
+                history_download.active =
+                    !History_Download_Notify(chunk,
+                                             HISTORY_DOWNLOAD_HEADER_SIZE);
+                return;
+            }
+
+            history_download.blk_seq = blk->seq;
+            history_download.blk_count = blk->count;
+            history_download.blk_size = HISTORY_HEADER_SIZE + blk->used;
+        }
+
+        /* Largest chunk allowed by the ATT MTU */
+        len = history_download.blk_size - history_download.offset;
+        if (len > ble_env.mtu - 3 - HISTORY_DOWNLOAD_HEADER_SIZE)
+        {
+            len = ble_env.mtu - 3 - HISTORY_DOWNLOAD_HEADER_SIZE;
+        }
+
+        History_Download_Header(chunk, history_download.blk_seq,
+                                history_download.offset);
+        memcpy(&chunk[HISTORY_DOWNLOAD_HEADER_SIZE],
+               (const uint8_t *)blk + history_download.offset, len);
+        if (!History_Download_Notify(chunk,
+                                     HISTORY_DOWNLOAD_HEADER_SIZE + len))
+        {
+            return;
+        }
+
+        history_download.offset += len;
+        if (history_download.offset >= history_download.blk_size)
+        {
+            history_download.next = history_download.blk_seq +
+                                    history_download.blk_count;
+            history_download.offset = 0;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void History_Download_Command(uint8_t conidx,
+ *                                               const uint8_t *value,
+ *                                               uint16_t length)
+ * ----------------------------------------------------------------------------
+ * Description   : Handle a write to the RX value: start a download from the
+ *                 requested sample, or stop the current download
+ * Inputs        : - conidx     - Connection index
+ *                 - value      - Value written
+ *                 - length     - Length of the value
+ * Outputs       : None
+ * Assumptions   : Values that are not download commands are ignored
+ * ------------------------------------------------------------------------- */
+void History_Download_Command(uint8_t conidx, const uint8_t *value,
+                              uint16_t length)
+{
+    if (length == 1 && value[0] == HISTORY_DOWNLOAD_CMD_STOP)
+    {
+        history_download.active = false;
+        history_download.seq_num_start = cs_env.ntf.seq_num;
+    }
+    else if (length == 5 && value[0] == HISTORY_DOWNLOAD_CMD_START)
+    {
+        history_download.conidx = conidx;
+        history_download.next = (uint32_t)value[1] |
+                                (uint32_t)value[2] << 8 |
+                                (uint32_t)value[3] << 16 |
+                                (uint32_t)value[4] << 24;
+        history_download.offset = 0;
+        history_download.active = true;
+        history_download.seq_num_start = cs_env.ntf.seq_num;
+
+        History_Download_Continue();
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void History_Download_Sent(uint16_t seq_num, uint8_t status)
+ * ----------------------------------------------------------------------------
+ * Description   : Handle the completion of a download notification and send
+ *                 the next chunks. A chunk dropped for lack of buffers is
+ *                 sent again; on other errors the download stops and the
+ *                 client resumes it from the last chunk received.
+ * Inputs        : - seq_num    - Sequence number of the notification
+ *                 - status     - Status of the notification
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void History_Download_Sent(uint16_t seq_num, uint8_t status)
+{
+    if (status == GAP_ERR_INSUFF_RESOURCES)
+    {
+        /* Resume from the dropped chunk; the chunks sent before resuming
+         * are not considered any more */
+        if ((int16_t)(seq_num - history_download.seq_num_start) >= 0)
+        {
+            history_download.next =
+                history_download.resume[seq_num % CS_NTF_WINDOW_MAX];
+            history_download.offset = 0;
+            history_download.active = true;
+            history_download.seq_num_start = cs_env.ntf.seq_num;
+        }
+    }
+    else if (status != GAP_ERR_NO_ERROR)
+    {
+        history_download.active = false;
+    }
+
+    History_Download_Continue();
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void History_Download_Stop(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Stop the download when the connection is lost
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void History_Download_Stop(void)
+{
+    history_download.active = false;
+}
+
+#endif /* HISTORY_ENABLE */
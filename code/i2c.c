@@ -15,9 +15,13 @@
  *   currently supported.
  * - The DIOs used by the I2C interface are not configured by this library; they
  *   have to be configured on the application level.
- * - Known limitations:
- *   > DMA transfers are not supported.
- *   > I2C bus errors are not treated.
+ * - Transactions are queued (up to I2C_QUEUE_SIZE) and executed back to back
+ *   from the interrupt handler.
+ * - Transactions of at least I2C_DMA_MIN_LENGTH bytes are transferred by DMA;
+ *   shorter transactions are handled byte per byte by I2C_IRQHandler.
+ * - Bus errors, NACKs and transactions exceeding I2C_TIMEOUT_MS (SysTick) are
+ *   retried up to I2C_RETRY_MAX times, with a bus recovery sequence if the
+ *   DIOs have been registered with I2C_Recovery_Config.
  * ----------------------------------------------------------------------------
  * $Revision: $
  * $Date: $
@@ -28,6 +32,7 @@
 /* Global variable definitions */
 
 struct i2c_env_tag    i2c_env;
+struct i2c_recovery_tag    i2c_recovery;
 
 
 /* Initialization and configuration */
@@ -47,11 +52,25 @@ void I2C_Master_Init(uint8_t speed)
 {
     /* Reset the I2C application environment */
     memset(&i2c_env, 0, sizeof(i2c_env));
+    i2c_env.speed = speed;
+    i2c_env.engine = I2C_ENGINE_CM3;
 
     /* Configure the I2C interface */
     Sys_I2C_Config(((uint32_t)(speed << I2C_CTRL0_SPEED_Pos)) |
-                   I2C_CONTROLLER_CM3 | I2C_STOP_INT_ENABLE |
-                   I2C_AUTO_ACK_DISABLE  | I2C_SAMPLE_CLK_ENABLE | I2C_SLAVE_DISABLE );
+                   I2C_CONFIG_CM3 | I2C_CONFIG_COMMON);
+
+    #if (I2C_DMA_ENABLE)
+        Sys_DMA_ChannelDisable(I2C_DMA_CHANNEL);
+        Sys_DMA_ClearChannelStatus(I2C_DMA_CHANNEL);
+        NVIC_ClearPendingIRQ(I2C_DMA_IRQn);
+        NVIC_EnableIRQ(I2C_DMA_IRQn);
+    #endif
+
+    /* Start the cycle counter used by the benchmark */
+    #if (I2C_BENCHMARK)
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    #endif
 
     /* Configure I2C debug DIO */
     #ifdef I2C_DBG_DIO_NUM
@@ -67,19 +86,24 @@ void I2C_Master_Init(uint8_t speed)
 /**** Write/read functions ****/
 
 /* ----------------------------------------------------------------------------
- * Function      : void I2C_WriteRead(uint8_t address, 
-                                      uint8_t *txdata, uint16_t txlength,
-                                      uint8_t *rxdata, uint16_t rxlength, 
-                                      void *callback)
+ * Function      : uint8_t I2C_WriteRead(uint8_t address, 
+                                         uint8_t *txdata, uint16_t txlength,
+                                         uint8_t *rxdata, uint16_t rxlength, 
+                                         void *callback)
  * ----------------------------------------------------------------------------
- * Description   : Initiates a write, read or combined write-read transaction, 
-                   of one or multiple bytes. Optionally a callback function 
+ * Description   : Queues a write, read or combined write-read transaction, 
+                   of one or multiple bytes. The transaction is started 
+                   immediately if the I2C interface is idle, otherwise it is
+                   started from the interrupt handler once the preceding 
+                   transactions are completed. Optionally a callback function 
                    can be provided that will be called once the tranasction is 
-                   completed. If both, write and read parameters are provided 
-                   (e.g txdata/txlength, rxdata/rxlength), the write sequence
-                   is first performed followed by the read sequence. This 
-                   allows running a sequence of 1) sending device address, 
-                   2) sending memory address, 3) receiving memory data.
+                   completed; i2c_env.xfer_status holds the completion status
+                   while the callback is executed. If both, write and read 
+                   parameters are provided (e.g txdata/txlength, 
+                   rxdata/rxlength), the write sequence is first performed 
+                   followed by the read sequence. This allows running a 
+                   sequence of 1) sending device address, 2) sending memory 
+                   address, 3) receiving memory data.
  * Inputs        : - address  - 7-bit slave address
                    - txdata   - Pointer to the TX data. Ignored if txlength=0
                    - txlength - Number of bytes to transfer. To be set to 0 for
@@ -90,43 +114,65 @@ void I2C_Master_Init(uint8_t speed)
                    - callback - Pointer to function that will be called if the
                                 transaction is completed. To be set to NULL if 
                                 no callback function is used.
- * Outputs       : None
+ * Outputs       : return value - I2C_XFER_OK if the transaction is queued,
+                                  I2C_XFER_QUEUE_FULL if the queue is full
  * Assumptions   : The I2C interface has previously been configured with 
-                   I2C_Master_Init.
+                   I2C_Master_Init. The TX/RX buffers remain valid until the
+                   transaction is completed. Can be called from a callback 
+                   function.
  * ------------------------------------------------------------------------- */
-void I2C_WriteRead(uint8_t address, uint8_t *txdata, uint16_t txlength,
-              uint8_t *rxdata, uint16_t rxlength, void *callback)
+uint8_t I2C_WriteRead(uint8_t address, uint8_t *txdata, uint16_t txlength,
+                      uint8_t *rxdata, uint16_t rxlength, void *callback)
 {
-    /* Copy the transaction parameters to the I2C environment structure */
-    i2c_env.address = address;
-    i2c_env.tx_buffer = txdata;
-    i2c_env.tx_buffer_length = txlength;
-    i2c_env.rx_buffer = rxdata;
-    i2c_env.rx_buffer_length = rxlength;
-    i2c_env.callbackfunction = callback;
-
-     /* Start the transaction by reseting the interface */
-    Sys_I2C_Reset();
+    struct i2c_xfer_tag *xfer;
+    uint32_t primask;
 
-    /* Start either a TX or RX transaction with the device selected with the 
-       provided address. */
-    if (txlength > 0)
+    /* The queue is shared with the I2C, DMA and timeout interrupt handlers */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (i2c_env.queue_count >= I2C_QUEUE_SIZE)
     {
-        Sys_I2C_StartWrite(address);
+        __set_PRIMASK(primask);
+        return (I2C_XFER_QUEUE_FULL);
     }
-    else if (rxlength > 0)
+
+    /* Copy the transaction parameters to the tail of the queue */
+    xfer = &i2c_env.queue[(i2c_env.queue_head + i2c_env.queue_count) %
+                          I2C_QUEUE_SIZE];
+    xfer->address = address;
+    xfer->tx_buffer = txdata;
+    xfer->tx_buffer_length = txlength;
+    xfer->rx_buffer = rxdata;
+    xfer->rx_buffer_length = rxlength;
+    xfer->callbackfunction = callback;
+    i2c_env.queue_count++;
+
+    /* Start the transaction if no other transaction is in progress */
+    if (!i2c_env.busy)
     {
-        i2c_env.tx_buffer_length--;
-        Sys_I2C_StartRead(address);
+        #if (I2C_BENCHMARK)
+            i2c_env.bench_start = DWT->CYCCNT;
+        #endif
+
+        I2C_StartNext();
+
+        #if (I2C_BENCHMARK)
+            i2c_env.bench_cycles += DWT->CYCCNT - i2c_env.bench_start;
+        #endif
     }
+
+    __set_PRIMASK(primask);
+
+    return (I2C_XFER_OK);
 }
 
 /* ----------------------------------------------------------------------------
- * Function      : void I2C_Write(uint8_t address, 
-                                  uint8_t *txdata, uint16_t txlength,
-                                  void *callback)
+ * Function      : uint8_t I2C_Write(uint8_t address, 
+                                     uint8_t *txdata, uint16_t txlength,
+                                     void *callback)
  * ----------------------------------------------------------------------------
- * Description   : Initiates a write transaction of one or multiple 
+ * Description   : Queues a write transaction of one or multiple 
                    bytes. Optionally a callback function can be provided that
                    will be called once the tranasction is completed.
  * Inputs        : - address  - 7-bit slave address
@@ -135,22 +181,23 @@ void I2C_WriteRead(uint8_t address, uint8_t *txdata, uint16_t txlength,
                    - callback - Pointer to function that will be called if the
                                 transaction is completed. To be set to NULL if 
                                 no callback function is used.
- * Outputs       : None
+ * Outputs       : return value - I2C_XFER_OK if the transaction is queued,
+                                  I2C_XFER_QUEUE_FULL if the queue is full
  * Assumptions   : The I2C interface has previously been configured with 
                    I2C_Master_Init.
  * ------------------------------------------------------------------------- */
-void I2C_Write(uint8_t address, uint8_t *txdata, uint16_t txlength,
-               void *callback)
+uint8_t I2C_Write(uint8_t address, uint8_t *txdata, uint16_t txlength,
+                  void *callback)
 {
-    I2C_WriteRead(address, txdata, txlength, NULL, 0, callback);
+    return I2C_WriteRead(address, txdata, txlength, NULL, 0, callback);
 }
 
 /* ----------------------------------------------------------------------------
- * Function      : void I2C_Read(uint8_t address, 
-                                 uint8_t *rxdata, uint16_t rxlength, 
-                                 void *callback)
+ * Function      : uint8_t I2C_Read(uint8_t address, 
+                                    uint8_t *rxdata, uint16_t rxlength, 
+                                    void *callback)
  * ----------------------------------------------------------------------------
- * Description   : Initiates a read transaction of one or multiple 
+ * Description   : Queues a read transaction of one or multiple 
                    bytes. Optionally a callback function can be provided that
                    will be called once the tranasction is completed.
  * Inputs        : - address  - 7-bit slave address
@@ -160,19 +207,347 @@ void I2C_Write(uint8_t address, uint8_t *txdata, uint16_t txlength,
                    - callback - Pointer to function that will be called if the
                                 transaction is completed. To be set to NULL if 
                                 no callback function is used.
- * Outputs       : None
+ * Outputs       : return value - I2C_XFER_OK if the transaction is queued,
+                                  I2C_XFER_QUEUE_FULL if the queue is full
  * Assumptions   : The I2C interface has previously been configured with 
                    I2C_Master_Init.
  * ------------------------------------------------------------------------- */
-void I2C_Read(uint8_t address, uint8_t *rxdata, uint16_t rxlength,
-              void *callback)
+uint8_t I2C_Read(uint8_t address, uint8_t *rxdata, uint16_t rxlength,
+                 void *callback)
 {
-    I2C_WriteRead(address, NULL, 0, rxdata, rxlength, callback);
+    return I2C_WriteRead(address, NULL, 0, rxdata, rxlength, callback);
 }
 
 
 /**** Support functions (internally used by the library) ****/
 
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_StartNext(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Remove the transaction at the head of the queue and start
+                   it. If the queue is empty, the I2C interface becomes idle.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : No transaction is in progress and interrupts are disabled 
+                   or this function is called from one of the library 
+                   interrupt handlers.
+ * ------------------------------------------------------------------------- */
+void I2C_StartNext(void)
+{
+    if (i2c_env.queue_count == 0)
+    {
+        i2c_env.busy = false;
+        return;
+    }
+
+    i2c_env.xfer = i2c_env.queue[i2c_env.queue_head];
+    i2c_env.queue_head = (i2c_env.queue_head + 1) % I2C_QUEUE_SIZE;
+    i2c_env.queue_count--;
+    i2c_env.retries = 0;
+
+    #if (I2C_BENCHMARK)
+        i2c_env.bench_length = i2c_env.xfer.tx_buffer_length + 
+                               i2c_env.xfer.rx_buffer_length;
+        i2c_env.bench_cycles = 0;
+    #endif
+
+    I2C_StartCurrent();
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_StartCurrent(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Copy the current transaction (i2c_env.xfer) to the I2C
+                   environment, arm its deadline and start it. Also used to
+                   retry a failed transaction.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Same as I2C_StartNext
+ * ------------------------------------------------------------------------- */
+void I2C_StartCurrent(void)
+{
+    struct i2c_xfer_tag *xfer = &i2c_env.xfer;
+
+    /* Copy the transaction parameters to the I2C environment structure */
+    i2c_env.address = xfer->address;
+    i2c_env.tx_buffer = xfer->tx_buffer;
+    i2c_env.tx_buffer_length = xfer->tx_buffer_length;
+    i2c_env.rx_buffer = xfer->rx_buffer;
+    i2c_env.rx_buffer_length = xfer->rx_buffer_length;
+    i2c_env.callbackfunction = xfer->callbackfunction;
+    i2c_env.xfer_status = I2C_XFER_OK;
+    i2c_env.busy = true;
+
+    /* Select the transfer engine, and reconfigure the I2C interface if it
+       differs from the engine of the previous transaction */
+    #if (I2C_DMA_ENABLE)
+    {
+        uint8_t engine = I2C_ENGINE_CM3;
+
+        if ((xfer->tx_buffer_length + xfer->rx_buffer_length) >=
+            I2C_DMA_MIN_LENGTH)
+        {
+            engine = I2C_ENGINE_DMA;
+        }
+
+        if (engine != i2c_env.engine)
+        {
+            i2c_env.engine = engine;
+            Sys_I2C_Config(((uint32_t)(i2c_env.speed << I2C_CTRL0_SPEED_Pos)) |
+                           ((engine == I2C_ENGINE_DMA) ? I2C_CONFIG_DMA :
+                                                         I2C_CONFIG_CM3) |
+                           I2C_CONFIG_COMMON);
+        }
+    }
+    #endif
+
+     /* Start the transaction by reseting the interface; drop a stop 
+        interrupt of the previous transaction that may still be pending */
+    Sys_I2C_Reset();
+    NVIC_ClearPendingIRQ(I2C_IRQn);
+    I2C_Timeout_Start();
+
+    #if (I2C_DMA_ENABLE)
+        if (i2c_env.engine == I2C_ENGINE_DMA)
+        {
+            if (i2c_env.tx_buffer_length > 0)
+            {
+                I2C_DMA_StartWrite();
+            }
+            else
+            {
+                I2C_DMA_StartRead();
+            }
+            return;
+        }
+    #endif
+
+    /* Start either a TX or RX transaction with the device selected with the 
+       provided address. */
+    if (i2c_env.tx_buffer_length > 0)
+    {
+        Sys_I2C_StartWrite(i2c_env.address);
+    }
+    else if (i2c_env.rx_buffer_length > 0)
+    {
+        i2c_env.tx_buffer_length--;
+        Sys_I2C_StartRead(i2c_env.address);
+    }
+
+    /* Nothing to transfer, complete the transaction immediately */
+    else
+    {
+        I2C_Complete(I2C_XFER_OK);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_Complete(uint8_t status)
+ * ----------------------------------------------------------------------------
+ * Description   : Report the completion of the transaction in progress by
+                   calling its callback function (if defined), then chain
+                   into the next queued transaction.
+ * Inputs        : - status   - Completion status of the transaction
+ * Outputs       : None
+ * Assumptions   : Called from the I2C interrupt handler, or with the I2C 
+                   interrupt disabled. The callback function can queue new
+                   transactions; they are started after the callback returns.
+ * ------------------------------------------------------------------------- */
+void I2C_Complete(uint8_t status)
+{
+    void *callback = i2c_env.callbackfunction;
+
+    I2C_Timeout_Stop();
+    i2c_env.xfer_status = status;
+    i2c_env.callbackfunction = NULL;
+
+    /* Account the transaction to its engine and length; the cycles spent in
+       the callback function are excluded */
+    #if (I2C_BENCHMARK)
+    {
+        uint32_t length = i2c_env.bench_length;
+
+        i2c_env.bench_cycles += DWT->CYCCNT - i2c_env.bench_start;
+        if ((length > 0) && (length <= I2C_BENCH_LENGTHS))
+        {
+            i2c_env.bench[i2c_env.engine][length - 1].count++;
+            i2c_env.bench[i2c_env.engine][length - 1].cycles +=
+                i2c_env.bench_cycles;
+        }
+    }
+    #endif
+
+    if (callback != NULL)
+    {
+        ((void(*)())callback)();
+    }
+
+    #if (I2C_BENCHMARK)
+        i2c_env.bench_start = DWT->CYCCNT;
+    #endif
+
+    I2C_StartNext();
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_Error(uint8_t status)
+ * ----------------------------------------------------------------------------
+ * Description   : Abort the transaction in progress. Unless the slave has 
+                   not acknowledged, the bus is recovered first. The 
+                   transaction is retried up to I2C_RETRY_MAX times before it
+                   is completed with the error status.
+ * Inputs        : - status   - I2C_XFER_NACK, I2C_XFER_BUS_ERROR or 
+                                I2C_XFER_TIMEOUT
+ * Outputs       : None
+ * Assumptions   : Same as I2C_Complete
+ * ------------------------------------------------------------------------- */
+void I2C_Error(uint8_t status)
+{
+    I2C_Timeout_Stop();
+
+    #if (I2C_DMA_ENABLE)
+        Sys_DMA_ChannelDisable(I2C_DMA_CHANNEL);
+    #endif
+
+    /* Release the bus */
+    Sys_I2C_NackAndStop();
+    Sys_I2C_Reset();
+    if (status != I2C_XFER_NACK)
+    {
+        I2C_Bus_Recover();
+    }
+
+    i2c_env.error_count++;
+    if (i2c_env.retries < I2C_RETRY_MAX)
+    {
+        i2c_env.retries++;
+        I2C_StartCurrent();
+    }
+    else
+    {
+        I2C_Complete(status);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_Recovery_Config(uint8_t scl, uint8_t sda, 
+                                            uint32_t config)
+ * ----------------------------------------------------------------------------
+ * Description   : Register the DIOs used by the I2C interface, so that the 
+                   bus can be recovered after a bus error or a timeout
+ * Inputs        : - scl      - DIO number of the SCL pad
+                   - sda      - DIO number of the SDA pad
+                   - config   - DIO configuration given to Sys_I2C_DIOConfig
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void I2C_Recovery_Config(uint8_t scl, uint8_t sda, uint32_t config)
+{
+    i2c_recovery.scl = scl;
+    i2c_recovery.sda = sda;
+    i2c_recovery.config = config;
+    i2c_recovery.enabled = true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_Bus_Recover(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Free a bus held by a slave (SDA low): clock SCL as a GPIO
+                   up to 9 times until SDA is released, generate a stop
+                   condition and give the pads back to the I2C interface
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : I2C_Recovery_Config has been called, otherwise nothing is
+                   done
+ * ------------------------------------------------------------------------- */
+void I2C_Bus_Recover(void)
+{
+    uint8_t i;
+
+    if (!i2c_recovery.enabled)
+    {
+        return;
+    }
+
+    /* SCL and SDA are only driven low, the pull-ups drive the high level */
+    Sys_DIO_Config(i2c_recovery.sda, DIO_MODE_INPUT | DIO_STRONG_PULL_UP);
+    Sys_DIO_Config(i2c_recovery.scl, DIO_MODE_INPUT | DIO_STRONG_PULL_UP);
+    for (i = 0; (i < 9) && (DIO_DATA->ALIAS[i2c_recovery.sda] == 0); i++)
+    {
+        Sys_DIO_Config(i2c_recovery.scl, DIO_MODE_GPIO_OUT_0);
+        Sys_Delay_ProgramROM(I2C_RECOVERY_HALF_PERIOD);
+        Sys_DIO_Config(i2c_recovery.scl, DIO_MODE_INPUT | DIO_STRONG_PULL_UP);
+        Sys_Delay_ProgramROM(I2C_RECOVERY_HALF_PERIOD);
+    }
+
+    /* Stop condition: SDA rising while SCL is high */
+    Sys_DIO_Config(i2c_recovery.sda, DIO_MODE_GPIO_OUT_0);
+    Sys_Delay_ProgramROM(I2C_RECOVERY_HALF_PERIOD);
+    Sys_DIO_Config(i2c_recovery.sda, DIO_MODE_INPUT | DIO_STRONG_PULL_UP);
+    Sys_Delay_ProgramROM(I2C_RECOVERY_HALF_PERIOD);
+
+    Sys_I2C_DIOConfig(i2c_recovery.config, i2c_recovery.scl, 
+                      i2c_recovery.sda);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_Timeout_Start(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Arm the deadline of the transaction in progress on the 
+                   SysTick timer
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : SysTick is not used by the application
+ * ------------------------------------------------------------------------- */
+void I2C_Timeout_Start(void)
+{
+    #if (I2C_TIMEOUT_MS > 0)
+        /* Same priority as the I2C interrupt, so that the handlers do not 
+           preempt each other */
+        NVIC_SetPriority(SysTick_IRQn, NVIC_GetPriority(I2C_IRQn));
+        SysTick->LOAD = (SystemCoreClock / 1000) * I2C_TIMEOUT_MS - 1;
+        SysTick->VAL = 0;
+        SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk |
+                        SysTick_CTRL_ENABLE_Msk;
+    #endif
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_Timeout_Stop(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Disarm the deadline of the transaction in progress
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void I2C_Timeout_Stop(void)
+{
+    #if (I2C_TIMEOUT_MS > 0)
+        SysTick->CTRL = 0;
+        NVIC_ClearPendingIRQ(SysTick_IRQn);
+    #endif
+}
+
+#if (I2C_TIMEOUT_MS > 0)
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_Timeout_IRQHandler(void)
+ * ----------------------------------------------------------------------------
+ * Description   : SysTick interrupt service function; the transaction in 
+                   progress has missed its deadline
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void I2C_Timeout_IRQHandler(void)
+{
+    SysTick->CTRL = 0;
+    if (i2c_env.busy)
+    {
+        I2C_Error(I2C_XFER_TIMEOUT);
+    }
+}
+#endif
+
 /* ----------------------------------------------------------------------------
  * Function      : void I2C_IRQHandler(void)
  * ----------------------------------------------------------------------------
@@ -188,6 +563,12 @@ void I2C_Read(uint8_t address, uint8_t *rxdata, uint16_t rxlength,
  * ------------------------------------------------------------------------- */
 void I2C_IRQHandler(void)
 {
+    bool nack;
+
+    #if (I2C_BENCHMARK)
+        i2c_env.bench_start = DWT->CYCCNT;
+    #endif
+
     /* Toggle the debug IO in debug mode */
     #ifdef I2C_DBG_DIO_NUM
         Sys_GPIO_Toggle(I2C_DBG_DIO_NUM);
@@ -196,8 +577,75 @@ void I2C_IRQHandler(void)
      /* Read the current I2C interface status */
     i2c_env.last_status = Sys_I2C_Get_Status();
 
+    /* Slave address or data byte not acknowledged: NACK status during a
+       write sequence, or before the first byte of a read sequence */
+    nack = (((i2c_env.last_status & (1<<I2C_STATUS_ACK_STATUS_Pos)) == 
+             I2C_HAS_NACK) &&
+            (((i2c_env.last_status & (1<<I2C_STATUS_READ_WRITE_Pos)) == 
+              I2C_IS_WRITE) ||
+             ((i2c_env.last_status & (1<<I2C_STATUS_BUFFER_FULL_Pos)) != 
+              I2C_BUFFER_FULL)));
+
+    /* No transaction in progress (e.g. stop interrupt of a completed 
+       transaction) */
+    if (!i2c_env.busy)
+    {
+        /* Nothing to do */
+    }
+
+    /* Bus error or arbitration lost */
+    else if ((i2c_env.last_status & I2C_STATUS_ERROR_MASK) != 0)
+    {
+        I2C_Error(I2C_XFER_BUS_ERROR);
+    }
+
+    #if (I2C_DMA_ENABLE)
+    /* DMA transactions: the bytes are transferred by the DMA channel, the 
+       interface only has to be handled at the end (stop condition) of the
+       write and read sequences. Handled before the NACK test below: at the
+       stop of a read sequence, the ACK status is the NACK sent by the master
+       on the last byte and the buffer has been emptied by the DMA channel. */
+    else if (i2c_env.engine == I2C_ENGINE_DMA)
+    {
+        if (((i2c_env.last_status & (1<<I2C_STATUS_STOP_DETECT_Pos)) != 0) &&
+            (!nack || 
+             ((i2c_env.last_status & (1<<I2C_STATUS_READ_WRITE_Pos)) == 
+              I2C_IS_READ)))
+        {
+            Sys_DMA_ChannelDisable(I2C_DMA_CHANNEL);
+
+            /* End of the write sequence: initiate the read sequence if 
+               required */
+            if ((i2c_env.tx_buffer_length > 0) && 
+                (i2c_env.rx_buffer_length > 0))
+            {
+                i2c_env.tx_buffer_length = 0;
+                I2C_DMA_StartRead();
+            }
+            else
+            {
+                i2c_env.tx_buffer_length = 0;
+                i2c_env.rx_buffer_length = 0;
+                I2C_Complete(I2C_XFER_OK);
+            }
+        }
+
+        /* Slave address or written byte not acknowledged */
+        else if (nack)
+        {
+            I2C_Error(I2C_XFER_NACK);
+        }
+    }
+    #endif
+
+    /* Slave address or data byte not acknowledged */
+    else if (nack)
+    {
+        I2C_Error(I2C_XFER_NACK);
+    }
+
     /* Handle write/TX transfers (priority over read transaction) */
-    if ((i2c_env.last_status & (1<<I2C_STATUS_READ_WRITE_Pos)) == I2C_IS_WRITE)
+    else if ((i2c_env.last_status & (1<<I2C_STATUS_READ_WRITE_Pos)) == I2C_IS_WRITE)
     {
         /* As long as the TX buffer contains data, transfer the next byte */
         if (i2c_env.tx_buffer_length > 0)
@@ -219,9 +667,9 @@ void I2C_IRQHandler(void)
             {
                 Sys_I2C_StartRead(i2c_env.address);
             }
-            else if (i2c_env.callbackfunction != NULL)
+            else
             {
-                ((void(*)())i2c_env.callbackfunction)();
+                I2C_Complete(I2C_XFER_OK);
             }
         }
     }
@@ -258,16 +706,114 @@ void I2C_IRQHandler(void)
             }
         }
           
-        /* If the last byte has been received, read it from the buffer, and 
-           call the callback function if such one is defined */
+        /* If the last byte has been received, read it from the buffer, 
+           call the callback function if such one is defined and start the
+           next queued transaction */
         else if (i2c_env.rx_buffer_length == 1)
         {
             i2c_env.rx_buffer_length--;
             *i2c_env.rx_buffer++ = I2C->DATA;
-            if (i2c_env.callbackfunction != NULL)
-            {
-                ((void(*)())i2c_env.callbackfunction)();
-            }
+            I2C_Complete(I2C_XFER_OK);
         }
     }
+
+    #if (I2C_BENCHMARK)
+        i2c_env.bench_cycles += DWT->CYCCNT - i2c_env.bench_start;
+    #endif
 }
+
+#if (I2C_DMA_ENABLE)
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_DMA_StartWrite(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Start the write sequence of the transaction in progress with
+                   the DMA channel transferring the TX buffer to the I2C 
+                   interface. The DMA complete interrupt indicates the last 
+                   byte; a single byte is indicated as the last one at once,
+                   so that the sequence only raises the stop interrupt.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The I2C interface is configured for DMA transfers and 
+                   i2c_env.tx_buffer_length > 0.
+ * ------------------------------------------------------------------------- */
+void I2C_DMA_StartWrite(void)
+{
+    Sys_DMA_ClearChannelStatus(I2C_DMA_CHANNEL);
+    Sys_DMA_ChannelConfig(I2C_DMA_CHANNEL,
+                          (i2c_env.tx_buffer_length == 1) ?
+                          (I2C_DMA_TX_CFG & ~DMA_COMPLETE_INT_ENABLE) :
+                          I2C_DMA_TX_CFG,
+                          i2c_env.tx_buffer_length, 0,
+                          (uint32_t)i2c_env.tx_buffer, (uint32_t)&I2C->DATA);
+    Sys_I2C_StartWrite(i2c_env.address);
+
+    /* A single byte is the last one */
+    if (i2c_env.tx_buffer_length == 1)
+    {
+        I2C_CTRL1->LAST_DATA_ALIAS = I2C_LAST_DATA_BITBAND;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_DMA_StartRead(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Start the read sequence of the transaction in progress with
+                   the DMA channel transferring the received bytes to the RX 
+                   buffer. The DMA counter interrupt, raised before the last 
+                   byte is received, indicates the last byte.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The I2C interface is configured for DMA transfers and 
+                   i2c_env.rx_buffer_length > 0.
+ * ------------------------------------------------------------------------- */
+void I2C_DMA_StartRead(void)
+{
+    Sys_DMA_ClearChannelStatus(I2C_DMA_CHANNEL);
+    Sys_DMA_ChannelConfig(I2C_DMA_CHANNEL, I2C_DMA_RX_CFG,
+                          i2c_env.rx_buffer_length, 
+                          i2c_env.rx_buffer_length - 1,
+                          (uint32_t)&I2C->DATA, (uint32_t)i2c_env.rx_buffer);
+    Sys_I2C_StartRead(i2c_env.address);
+
+    /* A single byte is the last one */
+    if (i2c_env.rx_buffer_length == 1)
+    {
+        I2C_CTRL1->LAST_DATA_ALIAS = I2C_LAST_DATA_BITBAND;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void I2C_DMA_IRQHandler(void)
+ * ----------------------------------------------------------------------------
+ * Description   : DMA channel interrupt service function. It is called once
+                   per write or read sequence, when all TX bytes have been 
+                   handed to the I2C interface or when all RX bytes but the
+                   last one have been received, to indicate the last byte.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : A DMA transaction has been initiated with 
+                   I2C_DMA_StartWrite or I2C_DMA_StartRead.
+ * ------------------------------------------------------------------------- */
+void I2C_DMA_IRQHandler(void)
+{
+    uint32_t status;
+
+    #if (I2C_BENCHMARK)
+        i2c_env.bench_start = DWT->CYCCNT;
+    #endif
+
+    status = Sys_DMA_Get_ChannelStatus(I2C_DMA_CHANNEL);
+    Sys_DMA_ClearChannelStatus(I2C_DMA_CHANNEL);
+
+    if ((status & (DMA_COMPLETE_INT_STATUS | DMA_COUNTER_INT_STATUS)) != 0)
+    {
+        I2C_CTRL1->LAST_DATA_ALIAS = I2C_LAST_DATA_BITBAND;
+    }
+
+    #if (I2C_BENCHMARK)
+        i2c_env.bench_cycles += DWT->CYCCNT - i2c_env.bench_start;
+    #endif
+}
+
+#endif /* I2C_DMA_ENABLE */
@@ -0,0 +1,314 @@
+/* ----------------------------------------------------------------------------
+ * job_schedule.c
+ * - Wake-coalescing job scheduler
+ * ------------------------------------------------------------------------- */
+
+#include "../include/job_schedule.h"
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Job_Schedule_Initialize(struct job_schedule_tag *sched,
+ *                                              const struct job_desc *jobs,
+ *                                              uint8_t nb)
+ * ----------------------------------------------------------------------------
+ * Description   : Initialize a scheduler for a job table and compute the
+ *                 execution order of its jobs
+ * Inputs        : - sched      - Scheduler
+ *                 - jobs       - Job table
+ *                 - nb         - Number of jobs (at most JOB_SCHEDULE_MAX)
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Job_Schedule_Initialize(struct job_schedule_tag *sched,
+                             const struct job_desc *jobs, uint8_t nb)
+{
+    uint8_t i;
+    uint8_t j;
+    uint8_t n = 0;
+
+    sched->jobs = jobs;
+    sched->nb = nb;
+
+    /* Asynchronous jobs, insertion-sorted by decreasing cost */
+    for (i = 0; i < nb; i++)
+    {
+        sched->elapsed[i] = jobs[i].offset;
+        sched->period[i] = jobs[i].period;
+        if (jobs[i].pending != NULL)
+        {
+            j = n++;
+            while (j > 0 && jobs[sched->order[j - 1]].cost_us < jobs[i].cost_us)
+            {
+                sched->order[j] = sched->order[j - 1];
+                j--;
+            }
+            sched->order[j] = i;
+        }
+    }
+
+    /* Synchronous jobs */
+    for (i = 0; i < nb; i++)
+    {
+        if (jobs[i].pending == NULL)
+        {
+            sched->order[n++] = i;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool Job_Schedule_Set_Period(struct job_schedule_tag *sched,
+ *                                              void (*start)(void),
+ *                                              uint16_t period)
+ * ----------------------------------------------------------------------------
+ * Description   : Change the period of a job at runtime; the job runs on the
+ *                 next wake-up if the new period has already elapsed
+ * Inputs        : - sched      - Scheduler
+ *                 - start      - Job function identifying the job
+ *                 - period     - New period in wake-ups (at least 1)
+ * Outputs       : return value - false if the job is not in the table
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+bool Job_Schedule_Set_Period(struct job_schedule_tag *sched,
+                             void (*start)(void), uint16_t period)
+{
+    uint8_t i;
+
+    for (i = 0; i < sched->nb; i++)
+    {
+        if (sched->jobs[i].start == start)
+        {
+            sched->period[i] = (period > 0) ? period : 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint16_t Job_Schedule_Remaining(
+ *                                  const struct job_schedule_tag *sched,
+ *                                  void (*start)(void))
+ * ----------------------------------------------------------------------------
+ * Description   : Number of wake-ups until a job reaches its period; 1 if it
+ *                 runs on the next wake-up
+ * Inputs        : - sched      - Scheduler
+ *                 - start      - Job function identifying the job
+ * Outputs       : return value - Number of wake-ups, UINT16_MAX if the job
+ *                                is not in the table
+ * Assumptions   : The job may still be pulled earlier into a wake window
+ *                 within its slack
+ * ------------------------------------------------------------------------- */
+uint16_t Job_Schedule_Remaining(const struct job_schedule_tag *sched,
+                                void (*start)(void))
+{
+    uint8_t i;
+
+    for (i = 0; i < sched->nb; i++)
+    {
+        if (sched->jobs[i].start == start)
+        {
+            return (sched->elapsed[i] < sched->period[i]) ?
+                   (sched->period[i] - sched->elapsed[i]) : 1;
+        }
+    }
+
+    return UINT16_MAX;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t Job_Schedule_Select(struct job_schedule_tag *sched)
+ * ----------------------------------------------------------------------------
+ * Description   : Account a wake-up and select the jobs to run in it: the
+ *                 jobs that have reached their period and, if one of them is
+ *                 periodic work, the periodic jobs within their slack
+ * Inputs        : - sched      - Scheduler
+ * Outputs       : return value - Mask of the jobs to run (bit n = job n)
+ * Assumptions   : Called once per wake-up
+ * ------------------------------------------------------------------------- */
+uint8_t Job_Schedule_Select(struct job_schedule_tag *sched)
+{
+    const struct job_desc *job;
+    uint8_t due = 0;
+    bool window = false;
+    uint8_t i;
+
+    for (i = 0; i < sched->nb; i++)
+    {
+        if (sched->elapsed[i] < UINT16_MAX)
+        {
+            sched->elapsed[i]++;
+        }
+
+        if (sched->elapsed[i] >= sched->period[i])
+        {
+            due |= (1U << i);
+            window |= (sched->period[i] > 1);
+        }
+    }
+
+    /* Pull the periodic jobs within their slack into this wake window */
+    if (window)
+    {
+        for (i = 0; i < sched->nb; i++)
+        {
+            job = &sched->jobs[i];
+            if (sched->period[i] > 1 &&
+                (uint32_t)sched->elapsed[i] + job->slack >= sched->period[i])
+            {
+                due |= (1U << i);
+            }
+        }
+    }
+
+    for (i = 0; i < sched->nb; i++)
+    {
+        if (due & (1U << i))
+        {
+            sched->elapsed[i] = 0;
+        }
+    }
+
+    return due;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Job_Schedule_Start(const struct job_schedule_tag *sched,
+ *                                         uint8_t due)
+ * ----------------------------------------------------------------------------
+ * Description   : Start the selected asynchronous jobs, longest latency first
+ * Inputs        : - sched      - Scheduler
+ *                 - due        - Mask returned by Job_Schedule_Select
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Job_Schedule_Start(const struct job_schedule_tag *sched, uint8_t due)
+{
+    const struct job_desc *job;
+    uint8_t i;
+
+    for (i = 0; i < sched->nb; i++)
+    {
+        job = &sched->jobs[sched->order[i]];
+        if (job->pending != NULL && (due & (1U << sched->order[i])))
+        {
+            job->start();
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : volatile bool *Job_Schedule_Pending(
+ *                                  const struct job_schedule_tag *sched,
+ *                                  uint8_t due)
+ * ----------------------------------------------------------------------------
+ * Description   : Find a selected asynchronous job that has not completed yet
+ * Inputs        : - sched      - Scheduler
+ *                 - due        - Mask returned by Job_Schedule_Select
+ * Outputs       : return value - Completion flag of the job, NULL if all
+ *                                selected asynchronous jobs have completed
+ * Assumptions   : Job_Schedule_Start has been called
+ * ------------------------------------------------------------------------- */
+volatile bool *Job_Schedule_Pending(const struct job_schedule_tag *sched,
+                                    uint8_t due)
+{
+    uint8_t i;
+
+    for (i = 0; i < sched->nb; i++)
+    {
+        if ((due & (1U << i)) && sched->jobs[i].pending != NULL &&
+            *sched->jobs[i].pending)
+        {
+            return sched->jobs[i].pending;
+        }
+    }
+
+    return NULL;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint8_t Job_Schedule_Completed(
+ *                                  const struct job_schedule_tag *sched,
+ *                                  uint8_t due)
+ * ----------------------------------------------------------------------------
+ * Description   : Find the selected asynchronous jobs that have completed
+ * Inputs        : - sched      - Scheduler
+ *                 - due        - Mask returned by Job_Schedule_Select
+ * Outputs       : return value - Mask of the completed jobs (bit n = job n)
+ * Assumptions   : Job_Schedule_Start has been called
+ * ------------------------------------------------------------------------- */
+uint8_t Job_Schedule_Completed(const struct job_schedule_tag *sched,
+                               uint8_t due)
+{
+    uint8_t done = 0;
+    uint8_t i;
+
+    for (i = 0; i < sched->nb; i++)
+    {
+        if ((due & (1U << i)) && sched->jobs[i].pending != NULL &&
+            !*sched->jobs[i].pending)
+        {
+            done |= (1U << i);
+        }
+    }
+
+    return done;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Job_Schedule_Finish(const struct job_schedule_tag *sched,
+ *                                          uint8_t due)
+ * ----------------------------------------------------------------------------
+ * Description   : Run the selected synchronous jobs in table order
+ * Inputs        : - sched      - Scheduler
+ *                 - due        - Mask returned by Job_Schedule_Select
+ * Outputs       : None
+ * Assumptions   : The selected asynchronous jobs have completed
+ * ------------------------------------------------------------------------- */
+void Job_Schedule_Finish(const struct job_schedule_tag *sched, uint8_t due)
+{
+    uint8_t i;
+
+    for (i = 0; i < sched->nb; i++)
+    {
+        if ((due & (1U << i)) && sched->jobs[i].pending == NULL)
+        {
+            sched->jobs[i].start();
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : uint32_t Job_Schedule_Cost(const struct job_schedule_tag *sched,
+ *                                            uint8_t due)
+ * ----------------------------------------------------------------------------
+ * Description   : Estimate the duration of a wake window: the longest of the
+ *                 overlapped asynchronous jobs plus the synchronous jobs
+ * Inputs        : - sched      - Scheduler
+ *                 - due        - Mask returned by Job_Schedule_Select
+ * Outputs       : return value - Estimated duration in us
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+uint32_t Job_Schedule_Cost(const struct job_schedule_tag *sched, uint8_t due)
+{
+    uint32_t async = 0;
+    uint32_t sync = 0;
+    uint8_t i;
+
+    for (i = 0; i < sched->nb; i++)
+    {
+        if (due & (1U << i))
+        {
+            if (sched->jobs[i].pending == NULL)
+            {
+                sync += sched->jobs[i].cost_us;
+            }
+            else if (sched->jobs[i].cost_us > async)
+            {
+                async = sched->jobs[i].cost_us;
+            }
+        }
+    }
+
+    return async + sync;
+}
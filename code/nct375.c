@@ -9,211 +9,205 @@
 
 void NCT375_Received_Temperature(void)
 {
-	/* Temperature(C) = (TempCode*100)/16 */
-
-	//Dummy:
-//	ble_env.i2c_rx_buffer[0] = 0x11;
-//	ble_env.i2c_rx_buffer[1] = 0x10;
-
-
-	int32_t temp = ble_env.i2c_rx_buffer[0];
-
-	bool SGN = temp > 127;
-	temp = (temp<<4);
-	temp += (ble_env.i2c_rx_buffer[1]>>4);
-	/**/
-	if(SGN)	// temperatures less than zero
+	/* Temperature register: MSB = integer part (two's complement),
+	 * LSB D7..D4 = fraction in 1/16 C. The register pair is already the
+	 * signed 8.8 fixed-point format of the TLM frame.
+	 */
+	if(i2c_env.xfer_status != I2C_XFER_OK)
 	{
-		temp -=4096;
+		// sensor error, reported as "not supported" in the TLM frame
+		ble_env.temperature = NCT375_TEMP_INVALID;
+		return;
 	}
-	/* numbers behind the decimal point */
-	temp *= 10000;
-	/* To obtain real temperatur in (C) value should be converted to float
-	 * and devided by 16 then result is valid
-	 */
-	temp /= 16;
-
-		ble_env.temperature = temp;
+	ble_env.temperature = NCT375_TEMP_FIXED(ble_env.i2c_rx_buffer[0], ble_env.i2c_rx_buffer[1]);
+	nct375.samples++;
 }
 
-void NCT375_ONEShot_ModeOn(void)
+/* Temperature read in continuous conversion mode, and of the first
+ * conversion after a power-up. nct375.busy is set until the read has
+ * completed, or cleared here if it cannot be queued.
+ */
+static void NCT375_Temperature_Received(void)
 {
-	ble_env.i2c_tx_buffer[0]=0x01;	// Configuration register
-    ble_env.i2c_tx_buffer[1]=0x20;	// OneShot mode DO5 = 1
-	I2C_WriteRead(0x48, ble_env.i2c_tx_buffer, 2, NULL, 0, NULL);
+	NCT375_Received_Temperature();
+	nct375.busy = false;
 }
 
-void NCT375_ONEShot_ModeOff(void)
+void NCT375_Temperature_Read(void)
 {
-	app_env.i2c_tx_buffer[0]=0x01;	// Configuration register
-    app_env.i2c_tx_buffer[1]=0x00;	// OneShot mode DO5 = 0
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 2, NULL, 0, NULL);
+	nct375.busy = true;
+	ble_env.i2c_tx_buffer[0]=0x00;	// Temperature register
+	if(I2C_WriteRead(0x48, ble_env.i2c_tx_buffer, 1, ble_env.i2c_rx_buffer, 2, NCT375_Temperature_Received) != I2C_XFER_OK)
+	{
+		nct375.busy = false;
+	}
 }
 
-void NCT375_ONEShot_StartSample(void)
+/* Configuration and limit register writes. The I2C transactions are queued,
+ * so each write has its own TX bytes: a write queued behind another one does
+ * not change the data of the first. Two queued writes of the same limit
+ * register both send the later value.
+ */
+static uint8_t nct375_oneshot_on[2] = { 0x01, 0x20 };	// Configuration register, OneShot mode DO5 = 1
+static uint8_t nct375_oneshot_off[2] = { 0x01, 0x00 };	// Configuration register, OneShot mode DO5 = 0
+static uint8_t nct375_power_down[2] = { 0x01, 0x01 };	// Configuration register, Power Down DO0 = 1
+static uint8_t nct375_power_up[2] = { 0x01, 0x00 };		// Configuration register, Power Up DO0 = 0
+static uint8_t nct375_thyst[3] = { 0x02 };				// THYST register, limit
+static uint8_t nct375_tos[3] = { 0x03 };				// TOS register, limit
+
+void NCT375_ONEShot_ModeOn(void)
 {
-	ble_env.i2c_tx_buffer[0]=0x04;	// Address pointer register
-	ble_env.i2c_tx_buffer[1]=0x01;	// irrelevant data
-	I2C_WriteRead(0x48, ble_env.i2c_tx_buffer, 2, NULL, 0, NULL);
+	I2C_WriteRead(0x48, nct375_oneshot_on, 2, NULL, 0, NULL);
 }
 
-void NCT375_ONEShot_ReadSample(void)
+void NCT375_ONEShot_ModeOff(void)
 {
-	ble_env.i2c_tx_buffer[0]=0x00;	// Address pointer register
-	I2C_WriteRead(0x48, ble_env.i2c_tx_buffer, 1, NULL, 0, NULL);
-	NCT375_I2C_Delay();
-	I2C_WriteRead(0x48, NCT375_CMD_GET_TEMPERATURE, 0, ble_env.i2c_rx_buffer, 2, NCT375_Received_Temperature);
+	I2C_WriteRead(0x48, nct375_oneshot_off, 2, NULL, 0, NULL);
 }
 
-void NCT375_ONEShotReg_Read(void)
+/* One-shot sampling state machine. NCT375_ONEShot_Process only issues the
+ * next I2C transaction, the state is advanced by the I2C completion
+ * callbacks below. nct375.busy is set while a transaction is in flight; if
+ * the transaction cannot be queued, no callback follows, so the state is
+ * restored and nct375.busy cleared here (the transaction is issued again on
+ * the next wake).
+ */
+void NCT375_ONEShot_Process(void)
 {
-	void NCT375_ONEShotReg(void)
+	switch(nct375.state)
 	{
-		nct375.OneShot = app_env.i2c_rx_buffer[0];
+		case NCT375_STATE_IDLE:
+		{
+			/* Trigger a one-shot conversion */
+			nct375.state = NCT375_STATE_TRIGGER;
+			nct375.busy = true;
+			ble_env.i2c_tx_buffer[0]=0x04;	// One-shot register
+			ble_env.i2c_tx_buffer[1]=0x01;	// irrelevant data
+			if(I2C_WriteRead(0x48, ble_env.i2c_tx_buffer, 2, NULL, 0, NCT375_ONEShot_Triggered) != I2C_XFER_OK)
+			{
+				nct375.state = NCT375_STATE_IDLE;
+				nct375.busy = false;
+			}
+		}
+		break;
+		case NCT375_STATE_CONVERTING:
+		{
+			/* Set the pointer to the temperature register and read it back
+			 * in the same transaction (write followed by read) */
+			nct375.state = NCT375_STATE_READ;
+			nct375.busy = true;
+			ble_env.i2c_tx_buffer[0]=0x00;	// Temperature register
+			if(I2C_WriteRead(0x48, ble_env.i2c_tx_buffer, 1, ble_env.i2c_rx_buffer, 2, NCT375_ONEShot_Received) != I2C_XFER_OK)
+			{
+				nct375.state = NCT375_STATE_CONVERTING;
+				nct375.busy = false;
+			}
+		}
+		break;
+		default:
+		{
+			/* Transaction still in progress */
+		}
+		break;
 	}
-	// ONEShot register address writing
-	app_env.i2c_tx_buffer[0]=0x04;
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 1, app_env.i2c_rx_buffer, 0, NULL);
-	// ONEShot register content reading
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 0, app_env.i2c_rx_buffer, 1, NCT375_ONEShotReg);
 }
 
-void NCT375_PowerDown(void)
+/* Pipelined one-shot sampling. The temperature read of the conversion triggered
+ * on the previous wake and the trigger of the next conversion are queued as one
+ * I2C burst; the conversion then runs during the sleep period.
+ * nct375.busy is cleared when the trigger has been written, or here if a
+ * transaction cannot be queued (the conversion is then read, or a new one
+ * triggered, on the next wake).
+ */
+void NCT375_ONEShot_Pipeline(void)
 {
-	app_env.i2c_tx_buffer[0]=0x01;	// Configuration register
-    app_env.i2c_tx_buffer[1]=0x01;	// Power Down DO0 = 1
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 2, NULL, 0, NULL);
+	nct375.busy = true;
+	if(nct375.state == NCT375_STATE_CONVERTING)
+	{
+		ble_env.i2c_tx_buffer[0]=0x00;	// Temperature register
+		if(I2C_WriteRead(0x48, ble_env.i2c_tx_buffer, 1, ble_env.i2c_rx_buffer, 2, NCT375_Received_Temperature) != I2C_XFER_OK)
+		{
+			nct375.busy = false;
+			return;
+		}
+	}
+	/* Separate TX bytes, the read above is still queued */
+	nct375.state = NCT375_STATE_TRIGGER;
+	ble_env.i2c_tx_buffer[2]=0x04;	// One-shot register
+	ble_env.i2c_tx_buffer[3]=0x01;	// irrelevant data
+	if(I2C_WriteRead(0x48, &ble_env.i2c_tx_buffer[2], 2, NULL, 0, NCT375_ONEShot_Triggered) != I2C_XFER_OK)
+	{
+		nct375.state = NCT375_STATE_IDLE;
+		nct375.busy = false;
+	}
 }
 
-void NCT375_PowerUp(void)
+void NCT375_ONEShot_Triggered(void)
 {
-	ble_env.i2c_tx_buffer[0]=0x01;	// Configuration register
-    ble_env.i2c_tx_buffer[1]=0x00;	// Power Up DO0 = 0
-	I2C_WriteRead(0x48, ble_env.i2c_tx_buffer, 2, NULL, 0, NULL);
+	// no conversion running if the trigger failed, trigger again next time
+	nct375.state = (i2c_env.xfer_status == I2C_XFER_OK) ? NCT375_STATE_CONVERTING : NCT375_STATE_IDLE;
+	nct375.busy = false;
 }
 
-void NCT375_ConfReg_Read(void)
+void NCT375_ONEShot_Received(void)
 {
-	void NCT375_ConfReg(void)
-	{
-		nct375.Config = app_env.i2c_rx_buffer[0];
-	}
-	// Configuration register address writing
-	app_env.i2c_tx_buffer[0]=0x01;
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 1, app_env.i2c_rx_buffer, 0, NULL);
-	// Configuration register content reading
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 0, app_env.i2c_rx_buffer, 1, NCT375_ConfReg);
+	NCT375_Received_Temperature();
+	nct375.state = NCT375_STATE_IDLE;
+	nct375.busy = false;
 }
 
-void NCT375_I2C_Delay(void)
+void NCT375_PowerDown(void)
 {
-	// important wait between two i2c data frames
-	uint32_t tmp=1000;
-	while(tmp){tmp--;}
+	I2C_WriteRead(0x48, nct375_power_down, 2, NULL, 0, NULL);
 }
 
-/* temperature hysteresis and  over set register are used in comparasion and interrupt modes
- * (bit D1 configuration register) but chip has to be working in power NORMAL-MODE
- */
-// temperature hysteresis register
-void NCT375_THYST_Write(short int temp_hyst)
+void NCT375_PowerUp(void)
 {
-	union
-	{
-		short int hyst;
-		uint8_t buffer[2];
-	} to_buff;
-	to_buff.hyst=temp_hyst;
-
-	// only upper 12 bit is valid limit value
-	to_buff.hyst= (to_buff.hyst<<4);
-
-	app_env.i2c_tx_buffer[0]=0x02;	// Address pointer register
-	app_env.i2c_tx_buffer[1]=to_buff.buffer[1];
-	app_env.i2c_tx_buffer[2]=to_buff.buffer[0];
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 3, NULL, 0, NULL);
+	I2C_WriteRead(0x48, nct375_power_up, 2, NULL, 0, NULL);
 }
 
-short int NCT375_THYST_Read(void)
+/* Alarm mode: program TOS, THYST and the comparator mode. The three writes are
+ * queued, so each one needs its own TX bytes.
+ */
+void NCT375_Alarm_Configure(void)
 {
-	union
-	{
-		short int hyst;
-		uint8_t buffer[2];
-	} from_buff;
+	static uint8_t alarm_cfg[8];
 
-	short int temp_hyst=0;
-
-	void NCT375_THYSTReg(void)
-	{
+	alarm_cfg[0]=0x03;	// TOS register
+	alarm_cfg[1]=(uint8_t)(NCT375_ALARM_TOS >> 8);
+	alarm_cfg[2]=(uint8_t)(NCT375_ALARM_TOS & 0xF0);
+	I2C_WriteRead(0x48, &alarm_cfg[0], 3, NULL, 0, NULL);
 
-		from_buff.buffer[0] = app_env.i2c_rx_buffer[1];
-		from_buff.buffer[1] = app_env.i2c_rx_buffer[0];
-		// only upper 12 bit is valid limit value
-		from_buff.hyst = from_buff.hyst>>4;
-		/* negative value correction for 16 bits */
-		if(app_env.i2c_rx_buffer[1] & 0x80)
-		{
-			from_buff.buffer[1]=from_buff.buffer[1]|0xF0;
-		}
-		/**/
-		temp_hyst=from_buff.hyst;
-	}
+	alarm_cfg[3]=0x02;	// THYST register
+	alarm_cfg[4]=(uint8_t)(NCT375_ALARM_THYST >> 8);
+	alarm_cfg[5]=(uint8_t)(NCT375_ALARM_THYST & 0xF0);
+	I2C_WriteRead(0x48, &alarm_cfg[3], 3, NULL, 0, NULL);
 
-	app_env.i2c_tx_buffer[0]=0x02;	// Address pointer register
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 1, NULL, 0, NULL);
-	NCT375_I2C_Delay();
-	// THYST register content reading
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 0, app_env.i2c_rx_buffer, 2, NCT375_THYSTReg);
-	return temp_hyst;
+	alarm_cfg[6]=0x01;	// Configuration register
+	alarm_cfg[7]=NCT375_ALARM_CONFIG;
+	I2C_WriteRead(0x48, &alarm_cfg[6], 2, NULL, 0, NULL);
 }
 
-// temperature over set alert value register
-void NCT375_TOS_Write(short int temp_tos)
+/* temperature hysteresis and  over set register are used in comparasion and interrupt modes
+ * (bit D1 configuration register) but chip has to be working in power NORMAL-MODE.
+ * The limits are 12-bit two's complement codes in 1/16 C (upper 12 bits of the register).
+ */
+// temperature hysteresis register
+void NCT375_THYST_Write(short int temp_hyst)
 {
-	union
-	{
-		short int tos;
-		uint8_t buffer[2];
-	} to_buff;
-	to_buff.tos= temp_tos;
-	// only upper 12 bit is valid limit value
-	to_buff.tos= (to_buff.tos<<4);
-
-	app_env.i2c_tx_buffer[0]=0x03;	// Address pointer register
-	app_env.i2c_tx_buffer[1]=to_buff.buffer[1];
-	app_env.i2c_tx_buffer[2]=to_buff.buffer[0];
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 3, NULL, 0, NULL);
+	uint16_t reg = (uint16_t)(temp_hyst << 4);
+
+	nct375_thyst[1]=(uint8_t)(reg >> 8);
+	nct375_thyst[2]=(uint8_t)reg;
+	I2C_WriteRead(0x48, nct375_thyst, 3, NULL, 0, NULL);
 }
 
-short int NCT375_TOS_Read(void)
+// temperature over set alert value register
+void NCT375_TOS_Write(short int temp_tos)
 {
-	union
-	{
-		short int tos;
-		uint8_t buffer[2];
-	} from_buff;
-
-	short int temp_tos=0;
-
-	void NCT375_TOSReg(void)
-	{
+	uint16_t reg = (uint16_t)(temp_tos << 4);
 
-		from_buff.buffer[0] = app_env.i2c_rx_buffer[1];
-		from_buff.buffer[1] = app_env.i2c_rx_buffer[0];
-		// only upper 12 bit is valid limit value
-		from_buff.tos = from_buff.tos>>4;
-		/* negative value correction for 16 bits */
-		if(app_env.i2c_rx_buffer[1] & 0x80)
-		{
-			from_buff.buffer[1]=from_buff.buffer[1]|0xF0;
-		}
-		temp_tos=from_buff.tos;
-	}
-	app_env.i2c_tx_buffer[0]=0x03;	// Address pointer register
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 1, NULL, 0, NULL);
-	NCT375_I2C_Delay();
-	// TOS register content reading
-	I2C_WriteRead(0x48, app_env.i2c_tx_buffer, 0, app_env.i2c_rx_buffer, 2, NCT375_TOSReg);
-	return temp_tos;
+	nct375_tos[1]=(uint8_t)(reg >> 8);
+	nct375_tos[2]=(uint8_t)reg;
+	I2C_WriteRead(0x48, nct375_tos, 3, NULL, 0, NULL);
 }
@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * pad_policy.c
+ * - Application of the pad policy table on sleep entry and wake-up
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+/* DIO configuration of each pull and drive of the table */
+static const uint32_t pad_pull[] =
+{
+    DIO_NO_PULL, DIO_WEAK_PULL_UP, DIO_WEAK_PULL_DOWN, DIO_STRONG_PULL_UP
+};
+
+static const uint32_t pad_drive[] =
+{
+    DIO_2X_DRIVE, DIO_3X_DRIVE, DIO_5X_DRIVE, DIO_6X_DRIVE
+};
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Pad_Policy_Apply(uint8_t dio,
+ *                                              const struct pad_state_tag
+ *                                              *state)
+ * ----------------------------------------------------------------------------
+ * Description   : Configure a DIO to a pad state of the table
+ * Inputs        : - dio        - DIO number
+ *                 - state      - Pad state
+ * Outputs       : None
+ * Assumptions   : state->mode is not PAD_MODE_OWNED
+ * ------------------------------------------------------------------------- */
+static void Pad_Policy_Apply(uint8_t dio, const struct pad_state_tag *state)
+{
+    uint32_t cfg = pad_pull[state->pull] | pad_drive[state->drive];
+
+    if (state->mode == PAD_MODE_OUTPUT)
+    {
+        cfg |= (state->level) ? DIO_MODE_GPIO_OUT_1 : DIO_MODE_GPIO_OUT_0;
+    }
+    else if (state->mode == PAD_MODE_INPUT)
+    {
+        cfg |= DIO_MODE_INPUT | DIO_LPF_DISABLE;
+    }
+    else
+    {
+        cfg |= DIO_MODE_DISABLE;
+    }
+    Sys_DIO_Config(dio, cfg);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Pad_Policy_Sleep(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Apply the sleep state of each pad of the table; the pads
+ *                 of the sensor bus are disabled while the sensor is
+ *                 unpowered
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Called right before each sleep attempt; the pads of the
+ *                 sensor bus are handed back to the I2C interface by
+ *                 Pad_Policy_Wake
+ * ------------------------------------------------------------------------- */
+void Pad_Policy_Sleep(void)
+{
+    static const struct pad_state_tag unpowered =
+    {
+        PAD_MODE_DISABLE, PAD_PULL_NONE, PAD_DRIVE_2X, 0
+    };
+    const struct pad_policy_tag *pad;
+    uint8_t i;
+
+    for (i = 0; i < pad_policy_count; i++)
+    {
+        pad = &pad_policy[i];
+        if (pad->load == PAD_LOAD_SENSOR_BUS && !sensor_power.on)
+        {
+            Pad_Policy_Apply(pad->dio, &unpowered);
+        }
+        else if (pad->sleep.mode != PAD_MODE_OWNED)
+        {
+            Pad_Policy_Apply(pad->dio, &pad->sleep);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Pad_Policy_Wake(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Apply the wake state of each pad of the table, and hand
+ *                 the pads of the sensor bus back to the I2C interface
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Called at each wake-up, before the pad retention is
+ *                 released, and after each sleep attempt that did not enter
+ *                 sleep mode
+ * ------------------------------------------------------------------------- */
+void Pad_Policy_Wake(void)
+{
+    bool bus = false;
+    uint8_t i;
+
+    for (i = 0; i < pad_policy_count; i++)
+    {
+        if (pad_policy[i].wake.mode != PAD_MODE_OWNED)
+        {
+            Pad_Policy_Apply(pad_policy[i].dio, &pad_policy[i].wake);
+        }
+        else if (pad_policy[i].load == PAD_LOAD_SENSOR_BUS)
+        {
+            bus = true;
+        }
+    }
+
+    /* Same DIO configuration as at initialization, so that the snapshot of
+     * Periph_Retention_Restore still matches */
+    if (bus)
+    {
+        Sys_I2C_DIOConfig(I2C_DIO_CFG, I2C_SCL_DIO_NUM, I2C_SDA_DIO_NUM);
+    }
+}
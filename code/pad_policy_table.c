@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------------
+ * pad_policy_table.c
+ * - Pad policy table (sleep and wake states of the DIOs used by the
+ *   application), shared with tools/pad_leakage_report.c
+ * ------------------------------------------------------------------------- */
+
+#include "../include/pad_policy.h"
+#include "../include/nct375.h"
+
+/* LED lit while awake in the development profile */
+#if (PAD_POLICY_PRODUCTION)
+#define PAD_LED_WAKE    { PAD_MODE_DISABLE, PAD_PULL_NONE, PAD_DRIVE_2X, 0 }
+#else
+#define PAD_LED_WAKE    { PAD_MODE_OUTPUT, PAD_PULL_NONE, PAD_DRIVE_2X, 1 }
+#endif
+
+const struct pad_policy_tag pad_policy[] =
+{
+    /* Name, DIO, load,
+     *   sleep state (mode, pull, drive, level),
+     *   wake state */
+    { "LED", LED_DIO, PAD_LOAD_LED,
+      { PAD_MODE_DISABLE, PAD_PULL_NONE, PAD_DRIVE_2X, 0 },
+      PAD_LED_WAKE },
+
+    /* Unused, disabled to avoid current consumption on VDDO */
+    { "DIO4", 4, PAD_LOAD_NONE,
+      { PAD_MODE_DISABLE, PAD_PULL_NONE, PAD_DRIVE_2X, 0 },
+      { PAD_MODE_DISABLE, PAD_PULL_NONE, PAD_DRIVE_2X, 0 } },
+    { "DIO5", 5, PAD_LOAD_NONE,
+      { PAD_MODE_DISABLE, PAD_PULL_NONE, PAD_DRIVE_2X, 0 },
+      { PAD_MODE_DISABLE, PAD_PULL_NONE, PAD_DRIVE_2X, 0 } },
+
+    /* I2C interface (I2C_DIO_CFG while awake); the bus idles high during
+     * sleep, held by the weak pull-ups only */
+    { "I2C SCL", I2C_SCL_DIO_NUM, PAD_LOAD_SENSOR_BUS,
+      { PAD_MODE_INPUT, PAD_PULL_WEAK_UP, PAD_DRIVE_2X, 0 },
+      { PAD_MODE_OWNED, PAD_PULL_STRONG_UP, PAD_DRIVE_6X, 0 } },
+    { "I2C SDA", I2C_SDA_DIO_NUM, PAD_LOAD_SENSOR_BUS,
+      { PAD_MODE_INPUT, PAD_PULL_WEAK_UP, PAD_DRIVE_2X, 0 },
+      { PAD_MODE_OWNED, PAD_PULL_STRONG_UP, PAD_DRIVE_6X, 0 } },
+
+    /* Sensor ground and supply, outputs driven by sensor_power.c */
+    { "Sensor GND", I2C_GND_DIO_NUM, PAD_LOAD_NONE,
+      { PAD_MODE_OWNED, PAD_PULL_NONE, PAD_DRIVE_2X, 0 },
+      { PAD_MODE_OWNED, PAD_PULL_NONE, PAD_DRIVE_2X, 0 } },
+    { "Sensor PWR", I2C_PWR_DIO_NUM, PAD_LOAD_SENSOR_SUPPLY,
+      { PAD_MODE_OWNED, PAD_PULL_NONE, PAD_DRIVE_2X, 1 },
+      { PAD_MODE_OWNED, PAD_PULL_NONE, PAD_DRIVE_2X, 1 } },
+
+#if defined(ALARM_MODE)
+    /* NCT375 OS/ALERT output (open drain), wakes up the system */
+    { "NCT375 ALERT", NCT375_ALERT_DIO, PAD_LOAD_OPEN_DRAIN,
+      { PAD_MODE_INPUT, PAD_PULL_WEAK_UP, PAD_DRIVE_2X, 0 },
+      { PAD_MODE_INPUT, PAD_PULL_WEAK_UP, PAD_DRIVE_2X, 0 } },
+#endif
+};
+
+const uint8_t pad_policy_count = sizeof(pad_policy) / sizeof(pad_policy[0]);
@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * periph_retention.c
+ * - Peripheral context retention for the I2C interface and its DIOs
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+/* Register snapshot; kept in RAM so it is retained in sleep mode */
+struct periph_retention_env_tag periph_retention;
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Periph_Retention_Save(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Take a snapshot of the I2C interface and I2C DIO
+ *                 configuration
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The I2C interface and its DIOs have been configured and no
+ *                 I2C transaction is in progress
+ * ------------------------------------------------------------------------- */
+void Periph_Retention_Save(void)
+{
+    uint8_t i;
+
+    periph_retention.i2c_ctrl0 = I2C->CTRL0;
+    periph_retention.i2c_speed = i2c_env.speed;
+    periph_retention.dio_num[0] = I2C_SCL_DIO_NUM;
+    periph_retention.dio_num[1] = I2C_SDA_DIO_NUM;
+    for (i = 0; i < PERIPH_RETENTION_DIO_NB; i++)
+    {
+        periph_retention.dio_cfg[i] = DIO->CFG[periph_retention.dio_num[i]];
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Periph_Retention_Restore(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Write back the registers of the snapshot that have lost
+ *                 their value in sleep mode
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Periph_Retention_Save has been called
+ * ------------------------------------------------------------------------- */
+void Periph_Retention_Restore(void)
+{
+    bool intact = true;
+    uint8_t i;
+
+    for (i = 0; i < PERIPH_RETENTION_DIO_NB; i++)
+    {
+        if (DIO->CFG[periph_retention.dio_num[i]] != periph_retention.dio_cfg[i])
+        {
+            DIO->CFG[periph_retention.dio_num[i]] = periph_retention.dio_cfg[i];
+            intact = false;
+        }
+    }
+
+    /* The snapshot holds the configuration of the per-byte interrupt engine;
+     * if it is written back, the next DMA transaction reconfigures the
+     * interface, with the speed of the snapshot (a sampling wake-up
+     * configures the RC oscillator speed) */
+    if (I2C->CTRL0 != periph_retention.i2c_ctrl0 ||
+        i2c_env.speed != periph_retention.i2c_speed)
+    {
+        I2C->CTRL0 = periph_retention.i2c_ctrl0;
+        i2c_env.speed = periph_retention.i2c_speed;
+        i2c_env.engine = I2C_ENGINE_CM3;
+        intact = false;
+    }
+
+    NVIC_EnableIRQ(I2C_IRQn);
+#if (I2C_DMA_ENABLE)
+    NVIC_EnableIRQ(I2C_DMA_IRQn);
+#endif
+
+    if (intact)
+    {
+        periph_retention.intact++;
+    }
+    else
+    {
+        periph_retention.restored++;
+    }
+}
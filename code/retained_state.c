@@ -0,0 +1,166 @@
+/* ----------------------------------------------------------------------------
+ * retained_state.c
+ * - Retained application state
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+/* State block; kept in .noinit so it survives sleep mode and resets */
+struct retained_state_tag retained_state __attribute__ ((section(".noinit")));
+
+bool retained_state_warm;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint16_t Retained_State_CRC(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Calculate the CRC of the state block, CRC field excluded
+ * Inputs        : None
+ * Outputs       : return value - CRC-16/CCITT-FALSE of the block
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint16_t Retained_State_CRC(void)
+{
+    const uint8_t *data = (const uint8_t *)&retained_state;
+    uint16_t crc = RETAINED_STATE_CRC_INIT;
+    uint8_t i;
+    uint8_t bit;
+
+    for (i = 0; i < offsetof(struct retained_state_tag, crc); i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (bit = 0; bit < 8; bit++)
+        {
+            if (crc & 0x8000)
+            {
+                crc = (crc << 1) ^ RETAINED_STATE_CRC_POLY;
+            }
+            else
+            {
+                crc <<= 1;
+            }
+        }
+    }
+
+    return crc;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool Retained_State_Load(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Check the state block and resume the TLM counters, the last
+ *                 sample, the battery average and the runtime configuration
+ *                 from it. If the block is not valid (power-on reset, other
+ *                 firmware version), it is initialized with the TLM counters
+ *                 and the configuration persisted in flash, or the default
+ *                 configuration, instead. A restored configuration out of
+ *                 range is replaced by the defaults.
+ * Inputs        : None
+ * Outputs       : return value - true if the state has been resumed
+ * Assumptions   : The BLE environment has been initialized
+ * ------------------------------------------------------------------------- */
+bool Retained_State_Load(void)
+{
+    struct retained_counters counters;
+
+    Flash_KV_Initialize();
+
+    retained_state_warm = (retained_state.magic == RETAINED_STATE_MAGIC &&
+                           retained_state.version == RETAINED_STATE_VERSION &&
+                           retained_state.crc == Retained_State_CRC());
+
+    if (!retained_state_warm)
+    {
+        memset(&retained_state, 0, sizeof(retained_state));
+        retained_state.magic = RETAINED_STATE_MAGIC;
+        retained_state.version = RETAINED_STATE_VERSION;
+        retained_state.temperature = NCT375_TEMP_INVALID;
+        if (!Flash_KV_Read(RETAINED_KEY_CONFIG, &app_config,
+                           sizeof(app_config)))
+        {
+            App_Config_Defaults();
+        }
+        else
+        {
+            App_Config_Validate();
+        }
+        if (Flash_KV_Read(RETAINED_KEY_COUNTERS, &counters,
+                          sizeof(counters)))
+        {
+            ble_env.adv_count = counters.adv_count;
+            ble_env.adv_time = counters.adv_time;
+        }
+        retained_state.adv_count = ble_env.adv_count;
+        retained_state.adv_time = ble_env.adv_time;
+        retained_state.persist_time = ble_env.adv_time;
+        retained_state.config = app_config;
+        retained_state.crc = Retained_State_CRC();
+
+        return false;
+    }
+
+    ble_env.adv_count = retained_state.adv_count;
+    ble_env.adv_time = retained_state.adv_time;
+    ble_env.batt_lvl = retained_state.batt_lvl;
+    ble_env.temperature = retained_state.temperature;
+    app_config = retained_state.config;
+    App_Config_Validate();
+    retained_state.config = app_config;
+
+    retained_state.warm_resets++;
+    retained_state.crc = Retained_State_CRC();
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Retained_State_Save(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Update the state block with the current TLM counters, last
+ *                 sample, battery average and runtime configuration
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Retained_State_Load has been called
+ * ------------------------------------------------------------------------- */
+void Retained_State_Save(void)
+{
+    retained_state.adv_count = ble_env.adv_count;
+    retained_state.adv_time = ble_env.adv_time;
+    retained_state.temperature = ble_env.temperature;
+    retained_state.batt_lvl = ble_env.batt_lvl;
+    retained_state.config = app_config;
+    retained_state.crc = Retained_State_CRC();
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Retained_State_Persist(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Write the TLM counters and the runtime configuration to
+ *                 the flash key/value store if RETAINED_PERSIST_MINUTES have
+ *                 elapsed since the last successful write
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Retained_State_Load has been called
+ * ------------------------------------------------------------------------- */
+void Retained_State_Persist(void)
+{
+    struct retained_counters counters;
+
+    if (ble_env.adv_time - retained_state.persist_time <
+        RETAINED_PERSIST_MINUTES * 600)
+    {
+        return;
+    }
+
+    counters.adv_count = ble_env.adv_count;
+    counters.adv_time = ble_env.adv_time;
+
+    /* Retried on the next wake-up if the store reports a flash failure */
+    if (!Flash_KV_Write(RETAINED_KEY_COUNTERS, &counters, sizeof(counters)) ||
+        !Flash_KV_Write(RETAINED_KEY_CONFIG, &app_config, sizeof(app_config)))
+    {
+        return;
+    }
+
+    retained_state.persist_time = ble_env.adv_time;
+    Retained_State_Save();
+}
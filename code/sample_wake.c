@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * sample_wake.c
+ * - RTC-alarm-driven sensor sampling
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+#if (SAMPLE_WAKE)
+
+struct sample_wake_env_tag sample_wake;
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Sample_Wake_Configure(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Load the RTC start value of the next RTC period: in
+ *                 one-shot mode, the conversion time after a trigger and
+ *                 the rest of the sampling period after a read, so that
+ *                 samples stay one sampling period apart; the sampling
+ *                 period otherwise. The alarm itself is enabled with the
+ *                 RTC configuration of Sleep_Mode_Configure.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The configuration has been loaded; the start value is
+ *                 loaded by the RTC at the next alarm, so it is written one
+ *                 period ahead
+ * ------------------------------------------------------------------------- */
+void Sample_Wake_Configure(void)
+{
+#if defined(ONE_SHOT_MODE)
+    /* Loaded at the alarm of the read wake-up if a conversion is running,
+     * at the alarm of the trigger wake-up otherwise */
+    ACS_RTC_CFG->START_VALUE = (nct375.state == NCT375_STATE_CONVERTING) ?
+        SAMPLE_WAKE_RTC_START_VALUE(app_config.sample_period) -
+        SAMPLE_WAKE_CONVERSION_TICKS : SAMPLE_WAKE_CONVERSION_TICKS;
+#else
+    ACS_RTC_CFG->START_VALUE =
+        SAMPLE_WAKE_RTC_START_VALUE(app_config.sample_period);
+#endif
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Sample_Wake_Process(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Minimal wake-up: access the NCT375 over I2C from the RC
+ *                 oscillator, store the sample if one has been read, load
+ *                 the next RTC period and go back to sleep. The baseband
+ *                 stays in deep sleep, so its timer still holds the next
+ *                 BLE event; the 48 MHz XTAL clock is not used.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The wake-up was caused by the RTC alarm only
+ *                 (SAMPLE_WAKE_RTC_ONLY) and Sys_PowerModes_Wakeup has been
+ *                 executed; does not return
+ * ------------------------------------------------------------------------- */
+void Sample_Wake_Process(void)
+{
+    uint8_t samples = nct375.samples;
+
+    /* Lower drive strength (required when VDDO > 2.7) and release the pads
+     * held during sleep */
+    DIO->PAD_CFG = PAD_LOW_DRIVE;
+    ACS_WAKEUP_CTRL->PADS_RETENTION_EN_BYTE = PADS_RETENTION_DISABLE_BYTE;
+
+    /* Configure the I2C interface for the RC oscillator clock; the next BLE
+     * wake-up restores the nominal configuration (Periph_Retention_Restore,
+     * including i2c_env.speed) */
+    I2C_Master_Init(SAMPLE_WAKE_I2C_SPEED);
+    NVIC_SetPriority(I2C_IRQn, 2);
+    Sys_I2C_DIOConfig(I2C_DIO_CFG, I2C_SCL_DIO_NUM, I2C_SDA_DIO_NUM);
+
+    __enable_irq();
+
+    /* Trigger a conversion or read the one triggered at the previous
+     * sampling wake-up (one-shot mode), or read the last conversion, and
+     * sleep until the transaction has completed */
+#if defined(ONE_SHOT_MODE)
+    NCT375_ONEShot_Process();
+#else
+    Sensor_Job();
+#endif
+    App_Wait_For_Completion(&nct375.busy);
+
+    if (nct375.samples != samples)
+    {
+        sample_wake.count++;
+#if (HISTORY_ENABLE)
+        History_Job();
+#endif
+        Retained_State_Save();
+    }
+
+    /* Go back to sleep until the next RTC alarm or BLE event */
+    Sample_Wake_Configure();
+    Pad_Policy_Sleep();
+    __disable_irq();
+    Sys_PowerModes_Sleep(&sleep_mode_env);
+
+    /* Not reached */
+    while (true);
+}
+
+#endif /* SAMPLE_WAKE */
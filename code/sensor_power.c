@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * sensor_power.c
+ * - Sensor power gating sequencer
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+struct sensor_power_env_tag sensor_power;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sensor_Power_Set(bool on)
+ * ----------------------------------------------------------------------------
+ * Description   : Switch the sensor supply
+ * Inputs        : - on         - Supply state
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sensor_Power_Set(bool on)
+{
+    if (on)
+    {
+        Sys_DIO_Config(I2C_PWR_DIO_NUM, DIO_MODE_GPIO_OUT_1);
+        sensor_power.cycles++;
+    }
+    else
+    {
+        Sys_DIO_Config(I2C_PWR_DIO_NUM, DIO_MODE_GPIO_OUT_0);
+    }
+    sensor_power.on = on;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Sensor_Power_Initialize(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Configure the sensor ground and supply DIOs and power the
+ *                 sensor
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Sensor_Power_Initialize(void)
+{
+    Sys_DIO_Config(I2C_GND_DIO_NUM, DIO_MODE_GPIO_OUT_0);
+    Sensor_Power_Set(true);
+}
+
+#if (SENSOR_POWER_GATING)
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Sensor_Power_Sequence(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Set the sensor supply for the coming sleep period: on if
+ *                 the sensor is read within the wake-ups covering
+ *                 SENSOR_POWER_STARTUP_MS, off otherwise
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Called once per wake-up, after the jobs of the wake-up
+ * ------------------------------------------------------------------------- */
+void Sensor_Power_Sequence(void)
+{
+    uint16_t lead;
+    bool on;
+
+    lead = (SENSOR_POWER_STARTUP_MS + app_config.adv_interval - 1) /
+           app_config.adv_interval;
+    on = (Job_Schedule_Remaining(&app_jobs, Sensor_Job) <= lead);
+
+    /* The I2C DIOs are disabled by Pad_Policy_Sleep while unpowered */
+    if (on != sensor_power.on)
+    {
+        Sensor_Power_Set(on);
+    }
+}
+
+#endif /* SENSOR_POWER_GATING */
@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * wake_profile.c
+ * - Wake-window profiler based on the Cortex-M3 DWT cycle counter
+ * ------------------------------------------------------------------------- */
+
+#include "../include/app.h"
+
+#if (WAKE_PROFILE)
+
+/* Profiler ring; kept in .noinit so it survives sleep mode and resets */
+struct wake_profile_env_tag wake_profile __attribute__ ((section(".noinit")));
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Wake_Profile_Initialize(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Start the DWT cycle counter and clear the profiler ring if
+ *                 it does not contain valid records yet
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Wake_Profile_Initialize(void)
+{
+    if (wake_profile.magic != WAKE_PROFILE_MAGIC ||
+        wake_profile.head >= WAKE_PROFILE_RECORDS)
+    {
+        memset(&wake_profile, 0, sizeof(wake_profile));
+        wake_profile.magic = WAKE_PROFILE_MAGIC;
+    }
+
+    /* Records of the last wake cycle before reset are incomplete */
+    memset(&wake_profile.ring[wake_profile.head], 0,
+           sizeof(struct wake_profile_record));
+
+    WAKE_PROFILE_START();
+    wake_profile.last = DWT->CYCCNT;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Wake_Profile_Begin(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Close the record of the previous wake cycle, add it to the
+ *                 per-phase breakdown and open a new record. The cycles since
+ *                 WAKE_PROFILE_START() are accounted to WAKE_PHASE_WAKEUP.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : WAKE_PROFILE_START() has been executed at wake-up
+ * ------------------------------------------------------------------------- */
+void Wake_Profile_Begin(void)
+{
+    uint32_t now = DWT->CYCCNT;
+    struct wake_profile_record *rec = &wake_profile.ring[wake_profile.head];
+    uint8_t i;
+
+    for (i = 0; i < WAKE_PHASE_NB; i++)
+    {
+        wake_profile.sum[i] += rec->cycles[i];
+        if (rec->cycles[i] > wake_profile.max[i])
+        {
+            wake_profile.max[i] = rec->cycles[i];
+        }
+    }
+    wake_profile.wakes++;
+
+    wake_profile.head = (wake_profile.head + 1) % WAKE_PROFILE_RECORDS;
+    rec = &wake_profile.ring[wake_profile.head];
+    memset(rec, 0, sizeof(struct wake_profile_record));
+
+    rec->wake_id = ble_env.adv_count;
+    rec->cycles[WAKE_PHASE_WAKEUP] = now;
+    wake_profile.last = now;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Wake_Profile_Mark(uint8_t phase)
+ * ----------------------------------------------------------------------------
+ * Description   : Account the cycles elapsed since the previous mark to the
+ *                 given phase of the current wake cycle
+ * Inputs        : - phase      - Phase that just ended (enum wake_phase)
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Wake_Profile_Mark(uint8_t phase)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    wake_profile.ring[wake_profile.head].cycles[phase] +=
+        (now - wake_profile.last);
+    wake_profile.last = now;
+}
+
+#endif /* WAKE_PROFILE */
@@ -53,7 +53,18 @@ extern "C"
 #include "ble_std.h"
 #include "ble_custom.h"
 #include "ble_bass.h"
+#include "eddystone_tlm.h"
+#include "periph_retention.h"
+#include "app_config.h"
+#include "retained_state.h"
+#include "job_schedule.h"
+#include "sample_wake.h"
+#include "pad_policy.h"
+#include "sensor_power.h"
+#include "history.h"
+#include "history_download.h"
 #include "calibration.h"
+#include "wake_profile.h"
 
 /* ----------------------------------------------------------------------------
  * Defines
@@ -70,14 +81,11 @@ extern "C"
 /* Maximum battery level */
 #define BAT_LVL_MAX                     100
 
-/* DIO number that is connected to LED of EVB */
-#define LED_DIO                         6
+/* The DIO assignment is given in pad_policy.h */
 
-/* DIO used for the I2C interface to interface the SI7042 sensor */
-#define I2C_SDA_DIO_NUM                 12 /* 0 */
-#define I2C_SCL_DIO_NUM                 11 /* 1 */
-#define I2C_GND_DIO_NUM                 10 /* 2 */
-#define I2C_PWR_DIO_NUM                 8  /* 4 */
+/* Configuration of the DIOs used for the I2C interface */
+#define I2C_DIO_CFG                     (DIO_6X_DRIVE | DIO_LPF_ENABLE | \
+                                         DIO_STRONG_PULL_UP)
 
 #define UART_CFG_SYS_CLK                SystemCoreClock
 #define UART_BAUD_RATE                  115200
@@ -89,15 +97,50 @@ extern "C"
 #define SPI_CS_DIO_NUM                  4
 #define SPI_MISO_DIO_NUM                7
 
+/* Wake-up configuration of the NCT375 OS/ALERT DIO (alarm mode) */
+#define NCT375_ALERT_WAKEUP_CFG         (WAKEUP_DIO3_FALLING | WAKEUP_DIO3_ENABLE)
+
+/* Alarm mode: advertising interval (units of 625us) and number of advertising
+ * events of the fast advertising burst after a threshold crossing */
+#define ALARM_ADV_INT                   160
+#define ALARM_BURST_COUNT               50
+
 /* NCT375 I2C commands */
 #define NCT375_CMD_GET_TEMPERATURE					(uint8_t[]){0x00}
 #define NCT375_CMD_GET_TEMPERATURE_ONE_SHOT			(uint8_t[]){0x04}
 
-/* DIO number that is used for easy re-flashing (recovery mode) */
-#define RECOVERY_DIO                    12
-
-/* Set timer to 200 ms (20 times the 10 ms kernel timer resolution) */
-#define TIMER_200MS_SETTING             20
+/* Start the asynchronous jobs (sensor read, battery measurement) while
+ * waiting for the baseband to wake up in Continue_Application, so that
+ * their latency overlaps the oscillator and BLE wake-up time; only the
+ * synchronous jobs (advertising data encode) remain once BLE is awake
+ * Options: 1 (during the wake-up wait) or 0 (in Main_Loop) */
+#define EARLY_WORK                      1
+
+/* Clock of the RTC counter (ACS_RTC_COUNT, read with Sys_RTC_Value)
+ * timestamping the asynchronous job completions (RTC_CLK_SRC, 30.5 us
+ * resolution); unlike the DWT cycle counter, it keeps counting while the
+ * core waits in WFI. Without sample wake-ups, the RTC runs with the alarm
+ * disabled from the largest start value. */
+#define APP_JOBS_RTC_CLK_HZ             32768
+#define APP_JOBS_RTC_START_VALUE        0xFFFFFFFF
+
+/* Periodic jobs: period and deadline slack (in wake-ups) and estimated
+ * duration (in us; latency of the operation for the battery and sensor
+ * jobs) */
+#define JOB_SENSOR_COST                 4000
+#define JOB_BATTERY_PERIOD              10
+#define JOB_BATTERY_SLACK               3
+#define JOB_BATTERY_COST                6400
+#define JOB_RC_CALIB_PERIOD             RC_OSC_UPDATE_INTERVAL
+#define JOB_RC_CALIB_SLACK              20
+#define JOB_RC_CALIB_COST               50
+#define JOB_NOTIFICATION_PERIOD         20
+#define JOB_NOTIFICATION_SLACK          5
+#define JOB_NOTIFICATION_COST           20
+#define JOB_ALARM_COST                  20
+#define JOB_ADVERTISING_COST            300
+#define JOB_HISTORY_COST                50
+#define JOB_PERSIST_COST                20
 
 /* Configure RF 48 MHz XTAL divided clock frequency in Hz
  * Options: 8, 12, 16, 24, 48 */
@@ -193,15 +236,27 @@ extern "C"
  * respect to OSC wake-up timings in us */
 #define TWOSC                           1100
 
+/* Wake up a lead time before each advertising event, on top of TWOSC in
+ * the LLD sleep parameters: the sensor read started at wake-up (EARLY_WORK)
+ * completes and the updated advertising data is committed before the
+ * event, instead of one advertising interval later. The lead is the longest
+ * sensor job latency measured so far (capped to APP_SAMPLE_LEAD_MAX_US)
+ * plus a margin for the advertising update; it is only applied while
+ * advertising, connection events wake up TWOSC before as without lead. On
+ * battery measurement wake-ups the longer ADC latency can still make the
+ * commit late (counted in app_jobs_stats.late). Not used with sample
+ * wake-ups, as the BLE wake-ups then do not read the sensor.
+ * Options: 1 (lead while advertising) or 0 (TWOSC only) */
+#define APP_SAMPLE_LEAD                 1
+#define APP_SAMPLE_LEAD_MARGIN_US       (JOB_ADVERTISING_COST + 100)
+#define APP_SAMPLE_LEAD_MAX_US          JOB_SENSOR_COST
+
 extern const struct ke_task_desc TASK_DESC_APP;
 
 /* APP Task messages */
 enum appm_msg
 {
     APPM_DUMMY_MSG = TASK_FIRST_MSG(TASK_ID_APP),
-
-    /* Timer used to have a tick periodically for application */
-    APP_TEST_TIMER,
 };
 
 typedef void (*appm_add_svc_func_t)(void);
@@ -236,28 +291,66 @@ typedef void (*appm_enable_svc_func_t)(uint8_t);
 struct app_env_tag
 {
     /* Battery service */
-    uint8_t batt_lvl;
-    uint32_t sum_batt_lvl;
-    uint16_t num_batt_read;
     uint8_t send_batt_ntf;
 
-    uint32_t sleep_cycles;
+    /* Set while an ADC battery measurement is in progress; cleared from
+     * ADC_BATMON_IRQHandler */
+    bool batt_meas_pending;
 
-	/* Temperature value and CCCD */
-	int16_t temperature;
-    uint16_t temperature_cccd_value;
+    uint32_t sleep_cycles;
 
-    /* I2C reception buffer */
-    uint8_t i2c_rx_buffer[8];
+    /* Alarm mode: OS/ALERT state at the last wake-up and remaining fast
+     * advertising events */
+    bool alarm_active;
+    uint8_t alarm_burst;
 
-    /* I2C reception buffer */
-    uint8_t i2c_tx_buffer[8];
+	/* Temperature CCCD */
+    uint16_t temperature_cccd_value;
 
+    /* Periodic jobs selected for this wake-up, and set once their
+     * asynchronous jobs have been started */
+    uint8_t jobs_due;
+    bool jobs_started;
 };
 
-#ifdef ONE_SHOT_MODE
-	typedef void (*OneShotMode_t)(void);
-#endif
+/* Latencies of the asynchronous jobs, started together and joined before
+ * the synchronous jobs (advertising update) */
+struct app_jobs_stats_tag
+{
+    /* RTC counter when the jobs of the wake-up were started and mask of the
+     * jobs seen completed since */
+    uint32_t start;
+    uint8_t done;
+
+    /* Latency of each asynchronous job at its last run (by job table
+     * index), in us */
+    uint16_t latency[JOB_SCHEDULE_MAX];
+
+    /* Last wake-up: critical path (start to completion of the last job)
+     * and sum of the latencies (duration if run one after the other), in
+     * us */
+    uint16_t critical;
+    uint16_t serial;
+
+    /* All wake-ups: longest critical path, wake-ups with asynchronous jobs
+     * and totals, in us; the mean saving of the overlap is
+     * (serial_sum - critical_sum) / wakes */
+    uint16_t critical_max;
+    uint32_t wakes;
+    uint32_t critical_sum;
+    uint32_t serial_sum;
+
+    /* Longest sensor job latency, in us, and wake-up lead currently
+     * applied before the advertising events (see APP_SAMPLE_LEAD), in us */
+    uint16_t sensor_max;
+    uint16_t lead;
+
+    /* Time from the start of the jobs to the advertising data commit at the
+     * last wake-up, in us, and number of commits made after the advertising
+     * event (TWOSC + lead after the wake-up) */
+    uint16_t commit;
+    uint32_t late;
+};
 
 /* RC oscillator period measurement parameter */
 extern volatile uint16_t sample_cnt;
@@ -274,6 +367,11 @@ extern const appm_add_svc_func_t appm_add_svc_func_list[];
 /* Parameters and configurations for the sleep mode */
 extern struct sleep_mode_env_tag sleep_mode_env;
 
+/* Periodic job scheduler */
+extern struct job_schedule_tag app_jobs;
+
+extern struct app_jobs_stats_tag app_jobs_stats;
+
 /* ---------------------------------------------------------------------------
  * Function prototype definitions
  * --------------------------------------------------------------------------*/
@@ -294,6 +392,36 @@ extern void Main_Loop(void);
 
 extern void Measure_Battery_Level(void);
 
+extern void Battery_Measure_Start(void);
+
+extern void App_Wait_For_Completion(volatile bool *pending);
+
+extern void ADC_BATMON_IRQHandler(void);
+
+extern void Alarm_Process(void);
+
+extern void App_Jobs_Initialize(void);
+
+extern void App_Jobs_Begin(void);
+
+extern uint16_t App_Jobs_Elapsed(void);
+
+extern void App_Jobs_Poll(void);
+
+extern void App_Jobs_Join(void);
+
+extern void App_Sample_Lead_Update(void);
+
+extern void Sensor_Job(void);
+
+extern void RC_Calibration_Job(void);
+
+extern void Notification_Job(void);
+
+extern void Advertising_Job(void);
+
+extern void History_Job(void);
+
 extern uint8_t Emulate_CS_Val_Notif_Change(uint8_t val_notif);
 
 extern int Msg_Handler(ke_msg_id_t const msgid, void *param,
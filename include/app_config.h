@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * app_config.h
+ * - Runtime configuration of the advertising and sampling parameters. A
+ *   parameter is set by writing
+ *     APP_CONFIG_CMD_SET | parameter (uint8) | value (uint16)
+ *   to the RX value of the custom service (little endian, two's complement
+ *   for the RF output power). The value is range-checked (the
+ *   write fails with APP_CONFIG_ERR_OUT_OF_RANGE otherwise), applied at once
+ *   and kept in the retained state. APP_CONFIG_CMD_DEFAULTS restores the
+ *   build defaults. The CONFIG characteristic reads back
+ *   struct app_config_tag. A configuration restored from the retained state
+ *   or from flash is checked against the same ranges, and replaced by the
+ *   build defaults if a parameter is out of range.
+ * ------------------------------------------------------------------------- */
+
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* RX value commands */
+#define APP_CONFIG_CMD_SET              0x10
+#define APP_CONFIG_CMD_DEFAULTS         0x11
+
+/* ATT errors of a rejected command: unknown parameter (application error)
+ * and value out of range (common profile error) */
+#define APP_CONFIG_ERR_UNKNOWN          0x80
+#define APP_CONFIG_ERR_OUT_OF_RANGE     0xFF
+
+/* Parameters */
+enum app_config_param
+{
+    /* Advertising interval in ms */
+    APP_CONFIG_ADV_INTERVAL,
+
+    /* RF output power in dBm */
+    APP_CONFIG_TX_POWER,
+
+    /* Temperature sampling period in s; 0 samples on each BLE wake-up */
+    APP_CONFIG_SAMPLE_PERIOD,
+
+    /* Battery measurement period in s */
+    APP_CONFIG_BATT_PERIOD
+};
+
+/* Ranges; non-connectable advertising is limited to 100 ms, and the RF
+ * output power to the level the RF supplies are trimmed for
+ * (RF_TX_POWER_LEVEL) */
+#if (APP_ADV_CONNECTABILITY_MODE == ADV_NON_CONNECTABLE_MODE)
+#define APP_CONFIG_ADV_INTERVAL_MIN     100
+#else
+#define APP_CONFIG_ADV_INTERVAL_MIN     20
+#endif
+#define APP_CONFIG_ADV_INTERVAL_MAX     10240
+#define APP_CONFIG_TX_POWER_MIN         (-17)
+#define APP_CONFIG_TX_POWER_MAX         RF_TX_POWER_LEVEL
+#if (SAMPLE_WAKE)
+#define APP_CONFIG_SAMPLE_PERIOD_MIN    1
+#else
+#define APP_CONFIG_SAMPLE_PERIOD_MIN    0
+#endif
+#define APP_CONFIG_SAMPLE_PERIOD_MAX    3600
+#define APP_CONFIG_BATT_PERIOD_MIN      10
+#define APP_CONFIG_BATT_PERIOD_MAX      43200
+
+/* Build defaults */
+#ifdef CFG_ADV_INTERVAL_MS
+#define APP_CONFIG_ADV_INTERVAL_DFLT    CFG_ADV_INTERVAL_MS
+#else
+#define APP_CONFIG_ADV_INTERVAL_DFLT    100
+#endif
+#define APP_CONFIG_TX_POWER_DFLT        RF_TX_POWER_LEVEL
+#if (SAMPLE_WAKE)
+#define APP_CONFIG_SAMPLE_PERIOD_DFLT   (SAMPLE_INTERVAL_MS / 1000)
+#else
+#define APP_CONFIG_SAMPLE_PERIOD_DFLT   0
+#endif
+
+/* Battery measurement every JOB_BATTERY_PERIOD advertising wake-ups, at
+ * least every APP_CONFIG_BATT_PERIOD_MIN s */
+#if (JOB_BATTERY_PERIOD * APP_CONFIG_ADV_INTERVAL_DFLT / 1000 > \
+     APP_CONFIG_BATT_PERIOD_MIN)
+#define APP_CONFIG_BATT_PERIOD_DFLT     (JOB_BATTERY_PERIOD * \
+                                         APP_CONFIG_ADV_INTERVAL_DFLT / 1000)
+#else
+#define APP_CONFIG_BATT_PERIOD_DFLT     APP_CONFIG_BATT_PERIOD_MIN
+#endif
+
+/* Advertising interval in units of 625 us */
+#define APP_CONFIG_ADV_INT()            ((uint16_t)(app_config.adv_interval * \
+                                                    8 / 5))
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct app_config_tag
+{
+    uint16_t adv_interval;
+    int8_t tx_power;
+    uint16_t sample_period;
+    uint16_t batt_period;
+} __attribute__ ((packed));
+
+extern struct app_config_tag app_config;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void App_Config_Defaults(void);
+
+extern bool App_Config_Validate(void);
+
+extern void App_Config_Apply(void);
+
+extern uint8_t App_Config_Command(const uint8_t *value, uint16_t length);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_CONFIG_H */
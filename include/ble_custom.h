@@ -47,6 +47,12 @@ extern "C"
 #define CS_CHARACTERISTIC_RX_UUID       { 0x24, 0xdc, 0x0e, 0x6e, 0x03, 0x40, \
                                           0xca, 0x9e, 0xe5, 0xa9, 0xa3, 0x00, \
                                           0xb5, 0xf3, 0x93, 0xe0 }
+#define CS_CHARACTERISTIC_STATS_UUID    { 0x24, 0xdc, 0x0e, 0x6e, 0x04, 0x40, \
+                                          0xca, 0x9e, 0xe5, 0xa9, 0xa3, 0x00, \
+                                          0xb5, 0xf3, 0x93, 0xe0 }
+#define CS_CHARACTERISTIC_CONFIG_UUID   { 0x24, 0xdc, 0x0e, 0x6e, 0x05, 0x40, \
+                                          0xca, 0x9e, 0xe5, 0xa9, 0xa3, 0x00, \
+                                          0xb5, 0xf3, 0x93, 0xe0 }
 
 #define ATT_DECL_CHAR() \
     { ATT_DECL_CHARACTERISTIC_128, PERM(RD, ENABLE), 0, 0 }
@@ -77,6 +83,16 @@ enum cs_idx_att
     CS_IDX_RX_VALUE_CCC,
     CS_IDX_RX_VALUE_USR_DSCP,
 
+    /* Notification statistics Characteristic */
+    CS_IDX_STATS_VALUE_CHAR,
+    CS_IDX_STATS_VALUE_VAL,
+    CS_IDX_STATS_VALUE_USR_DSCP,
+
+    /* Configuration read-back Characteristic */
+    CS_IDX_CONFIG_VALUE_CHAR,
+    CS_IDX_CONFIG_VALUE_VAL,
+    CS_IDX_CONFIG_VALUE_USR_DSCP,
+
     /* Max number of characteristics */
     CS_IDX_NB,
 };
@@ -85,8 +101,31 @@ enum cs_idx_att
 #define CS_RX_VALUE_MAX_LENGTH          20
 #define CS_USER_DESCRIPTION_MAX_LENGTH  16
 
+/* Maximum length of a TX notification (ATT MTU of MTU_MAX) */
+#define CS_TX_NTF_MAX_LENGTH            (MTU_MAX - 3)
+
 #define CS_TX_CHARACTERISTIC_NAME       "TX_VALUE"
 #define CS_RX_CHARACTERISTIC_NAME       "RX_VALUE"
+#define CS_STATS_CHARACTERISTIC_NAME    "NTF_STATS"
+#define CS_CONFIG_CHARACTERISTIC_NAME   "CONFIG"
+
+/* Notification window: maximum number of notifications in flight (a power of
+ * two), reduced by half when the stack runs out of buffers and increased by
+ * one after each window of notifications completed without error. The light
+ * stack has fewer TX buffers. */
+#if defined(CFG_LIGHT_STACK)
+#define CS_NTF_WINDOW_MAX               2
+#else
+#define CS_NTF_WINDOW_MAX               8
+#endif
+#define CS_NTF_WINDOW_INIT              2
+
+/* Notification senders */
+enum cs_ntf_src
+{
+    CS_NTF_SRC_APP,
+    CS_NTF_SRC_DOWNLOAD
+};
 
 /* List of message handlers that are used by the custom service application manager */
 #define CS_MESSAGE_HANDLER_LIST                                     \
@@ -108,6 +147,49 @@ enum cs_state
  * Global variables and types
  * --------------------------------------------------------------------------*/
 
+/* Notification counters of the current connection; the value of the
+ * statistics characteristic (little endian) */
+struct cs_ntf_stats
+{
+    /* Notifications and value bytes sent */
+    uint32_t sent;
+    uint32_t bytes;
+
+    /* Notifications completed without error and with an error */
+    uint32_t completed;
+    uint16_t errors;
+
+    /* Window reductions on buffer exhaustion and notifications refused
+     * because the window was full */
+    uint16_t backoffs;
+    uint16_t refused;
+
+    /* Completions not matching the oldest notification in flight */
+    uint16_t out_of_order;
+
+    /* Notifications in flight: current, maximum and window */
+    uint8_t in_flight;
+    uint8_t depth_max;
+    uint8_t window;
+} __attribute__ ((packed));
+
+struct cs_ntf_queue_tag
+{
+    /* Sequence numbers of the next and of the oldest notification in
+     * flight */
+    uint16_t seq_num;
+    uint16_t seq_num_done;
+
+    /* Notifications completed since the last window increase */
+    uint8_t increase;
+
+    /* Sender of each notification in flight, by seq_num modulo
+     * CS_NTF_WINDOW_MAX */
+    uint8_t src[CS_NTF_WINDOW_MAX];
+
+    struct cs_ntf_stats stats;
+};
+
 struct cs_env_tag
 {
     /* The value of service handle in the database of attributes in the stack */
@@ -119,12 +201,6 @@ struct cs_env_tag
     /* CCCD value of TX characteristic */
     uint16_t tx_cccd_value;
 
-    /* A flag that indicates that TX value has been changed */
-    bool tx_value_changed;
-
-    /* A flag that indicates that PDU has been sent over the air */
-    bool sentSuccess;
-
     /* The value of RX characteristic value */
     uint8_t rx_value[CS_RX_VALUE_MAX_LENGTH];
 
@@ -140,6 +216,9 @@ struct cs_env_tag
     /* Custom service */
     uint16_t cnt_notifc;
     uint8_t val_notif;
+
+    /* Notification queue */
+    struct cs_ntf_queue_tag ntf;
 };
 
 extern struct cs_env_tag cs_env;
@@ -162,7 +241,13 @@ extern int GATTC_WriteReqInd(ke_msg_id_t const msg_id,
                              ke_task_id_t const dest_id,
                              ke_task_id_t const src_id);
 extern void CustomService_SendNotification(uint8_t conidx, uint8_t attidx,
-                                           uint8_t *value, uint8_t length);
+                                           uint8_t *value, uint16_t length,
+                                           uint16_t seq_num);
+extern void CustomService_Queue_Reset(void);
+extern uint8_t CustomService_Credits(void);
+extern bool CustomService_Notify(uint8_t conidx, uint8_t attidx,
+                                 uint8_t *value, uint16_t length,
+                                 uint8_t src, uint16_t *seq_num);
 extern int GATTC_CmpEvt(ke_msg_id_t const msg_id,
                         struct gattc_cmp_evt const *param,
                         ke_task_id_t const dest_id,
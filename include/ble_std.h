@@ -120,12 +120,13 @@ extern "C"
 #define APP_SCNRSP_DATA                 APP_COMPANY_ID_DATA
 #define APP_SCNRSP_DATA_LEN             APP_COMPANY_ID_DATA_LEN
 
-/* GAPM configuration definitions */
+/* GAPM configuration definitions; TX_OCT_MAX is the largest LE data length
+ * extension PDU payload (251 bytes, an ATT MTU of 247) */
 #define RENEW_DUR                       15000
 #define MTU_MAX                         0x200
 #define MPS_MAX                         0x200
 #define ATT_CFG                         0x80
-#define TX_OCT_MAX                      0x1b
+#define TX_OCT_MAX                      0xfb
 #define TX_TIME_MAX                     (14 * 8 + TX_OCT_MAX * 8)
 
 /* Define the available application states */
@@ -162,7 +163,9 @@ enum appm_state
     DEFINE_MESSAGE_HANDLER(GAPC_DISCONNECT_IND, GAPC_DisconnectInd),          \
     DEFINE_MESSAGE_HANDLER(GAPC_GET_DEV_INFO_REQ_IND, GAPC_GetDevInfoReqInd), \
     DEFINE_MESSAGE_HANDLER(GAPC_PARAM_UPDATED_IND, GAPC_ParamUpdatedInd),     \
-    DEFINE_MESSAGE_HANDLER(GAPC_PARAM_UPDATE_REQ_IND, GAPC_ParamUpdateReqInd) \
+    DEFINE_MESSAGE_HANDLER(GAPC_PARAM_UPDATE_REQ_IND, GAPC_ParamUpdateReqInd), \
+    DEFINE_MESSAGE_HANDLER(GAPC_LE_PKT_SIZE_IND, GAPC_LePktSizeInd),          \
+    DEFINE_MESSAGE_HANDLER(GATTC_MTU_CHANGED_IND, GATTC_MtuChangedInd)        \
 
 
 /* Standard declaration/description UUIDs in 16-byte format */
@@ -210,15 +213,27 @@ struct ble_env_tag
     uint16_t updated_latency;
     uint16_t updated_suo_to;
 
+    /* Negotiated ATT MTU and LE data length (maximum TX PDU payload) */
+    uint16_t mtu;
+    uint16_t max_tx_octets;
+
     uint32_t adv_count;
     uint32_t adv_time;
 
+    /* Part of the advertising time not yet counted in adv_time (units of
+     * 625us, below 160) */
+    uint8_t adv_time_rem;
+
+    /* Current advertising interval (units of 625us) */
+    uint16_t adv_interval;
+
     /* I2C reception buffer */
     uint8_t i2c_rx_buffer[8];
     /* I2C reception buffer */
     uint8_t i2c_tx_buffer[8];
 
-    uint32_t temperature;
+    /* Temperature, signed 8.8 fixed-point in degrees Celsius */
+    int16_t temperature;
 
     /* Battery service */
     uint16_t batt_lvl;
@@ -240,9 +255,12 @@ extern void BLE_Initialize(void);
 extern bool Service_Add(void);
 extern void Advertising_Start(void);
 extern void Advertising_Update(void);
+extern void Advertising_Data_Encode(void);
+extern void Advertising_Set_Interval(uint16_t interval);
 extern void BLE_SetStateEnable(void);
 extern void BLE_SetServiceState(bool enable, uint8_t conidx);
 extern bool Service_Enable(uint8_t conidx);
+extern void BLE_Link_Configure(uint8_t conidx);
 
 /* Bluetooth event and message handlers */
 extern int GAPM_ProfileAddedInd(ke_msg_id_t const msgid,
@@ -277,6 +295,14 @@ extern int GAPC_ConnectionReqInd(ke_msg_id_t const msgid,
                                  struct gapc_connection_req_ind const *param,
                                  ke_task_id_t const dest_id,
                                  ke_task_id_t const src_id);
+extern int GAPC_LePktSizeInd(ke_msg_id_t const msgid,
+                             struct gapc_le_pkt_size_ind const *param,
+                             ke_task_id_t const dest_id,
+                             ke_task_id_t const src_id);
+extern int GATTC_MtuChangedInd(ke_msg_id_t const msgid,
+                               struct gattc_mtu_changed_ind const *param,
+                               ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id);
 
 /* ----------------------------------------------------------------------------
  * Close the 'extern "C"' block
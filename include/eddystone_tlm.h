@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------------
+ * eddystone_tlm.h
+ * - Eddystone TLM frame encoder. The advertising data is encoded once in RAM
+ *   (retained in sleep mode); each update only patches the VBATT, TEMP,
+ *   ADV_CNT and SEC_CNT fields. The scan response is constant and stays in
+ *   flash.
+ * ------------------------------------------------------------------------- */
+
+#ifndef EDDYSTONE_TLM_H
+#define EDDYSTONE_TLM_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <rsl10.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Length of the advertising data (service list + TLM service data) */
+#define EDDYSTONE_TLM_ADV_DATA_LEN      22
+
+/* Maximum length of the scan response data */
+#define EDDYSTONE_TLM_SCAN_RSP_LEN_MAX  31
+
+/* Offsets of the TLM fields in the advertising data; all fields are
+ * big-endian */
+#define EDDYSTONE_TLM_VBATT_OFFSET      10
+#define EDDYSTONE_TLM_TEMP_OFFSET       12
+#define EDDYSTONE_TLM_ADV_CNT_OFFSET    14
+#define EDDYSTONE_TLM_SEC_CNT_OFFSET    18
+
+/* Pre-encoded advertising data */
+#define EDDYSTONE_TLM_ADV_DATA          { 0x03, /* Length of Service List */ \
+                                          0x03, /* Param: Service List */    \
+                                          0xAA, 0xFE, /* Eddystone ID */     \
+                                          0x11, /* Length of Service Data */ \
+                                          0x16, /* Service Data */           \
+                                          0xAA, 0xFE, /* Eddystone ID */     \
+                                          0x20, /* TLM flag */               \
+                                          0x00, /* TLM version */            \
+                                          0x00, 0x00, /* Battery voltage */  \
+                                          0x80, 0x00, /* Temperature */      \
+                                          0x00, 0x00, 0x00, 0x00, /* Count */\
+                                          0x00, 0x00, 0x00, 0x00  /* Time */ }
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct eddystone_tlm_env_tag
+{
+    /* Pre-encoded advertising data */
+    uint8_t adv_data[EDDYSTONE_TLM_ADV_DATA_LEN];
+};
+
+extern struct eddystone_tlm_env_tag eddystone_tlm;
+
+/* Scan response data (in flash) and its length */
+extern const uint8_t *const eddystone_tlm_scan_rsp_data;
+extern const uint8_t eddystone_tlm_scan_rsp_data_len;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void Eddystone_TLM_Encode(uint16_t vbatt_mv, uint16_t temp,
+                                 uint32_t adv_cnt, uint32_t sec_cnt);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EDDYSTONE_TLM_H */
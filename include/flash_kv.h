@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ * flash_kv.h
+ * - Log-structured key/value store in flash. The store is a ring of
+ *   FLASH_KV_PAGES flash pages written in 8-byte units (flash word pairs,
+ *   each programmed once between erases). A page starts with a header unit
+ *     page sequence number (24 bits) | FLASH_KV_MAGIC (8 bits) |
+ *     inverted first word
+ *   followed by records
+ *     key (uint8) | length (uint8) | CRC-16 (uint16) | inverted first word
+ *     value, padded to whole units
+ *   The latest record of a key is its value. The value units are written
+ *   before the header unit, so a record interrupted by a power loss is
+ *   never valid, and is skipped when the page is scanned. As the second
+ *   word of a header is the inverse of the first one, neither a torn write
+ *   nor a partial erase leaves a valid header behind.
+ *   When the active page is full, the next page (always kept erased)
+ *   becomes the active page, the records still current in the page after it
+ *   (the oldest) are copied, and that page is erased; the pages are thus
+ *   written in turn. A copy or erase interrupted by a power loss is
+ *   completed by Flash_KV_Initialize, which reads each unit of the store
+ *   once. A program or erase failure reported by the port makes
+ *   Flash_KV_Write fail: a page is only erased once all its latest records
+ *   have been copied, and a page whose erase failed is erased again before
+ *   it is opened. The page sequence numbers wrap around and are compared
+ *   modulo FLASH_KV_SEQ_MASK + 1.
+ *
+ *   The flash accesses go through the Flash_KV_Port functions, provided by
+ *   flash_kv_port.c on the device and by tools/flash_kv_sim.c on the host.
+ * ------------------------------------------------------------------------- */
+
+#ifndef FLASH_KV_H
+#define FLASH_KV_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Store location: the last FLASH_KV_PAGES sectors of the main flash, kept
+ * out of the FLASH region of sections.ld / sections_light.ld */
+#define FLASH_KV_BASE                   0x0015E000
+#define FLASH_KV_PAGE_SIZE              2048
+#define FLASH_KV_PAGES                  4
+
+/* Write unit (flash word pair) and units per page */
+#define FLASH_KV_UNIT                   8
+#define FLASH_KV_PAGE_UNITS             (FLASH_KV_PAGE_SIZE / FLASH_KV_UNIT)
+
+#define FLASH_KV_MAGIC                  0x4B
+#define FLASH_KV_SEQ_MASK               0x00FFFFFF
+#define FLASH_KV_ERASED                 0xFFFFFFFF
+
+/* Number of keys and maximum value length */
+#define FLASH_KV_KEYS                   4
+#define FLASH_KV_VALUE_MAX              32
+
+/* No record for the key */
+#define FLASH_KV_NONE                   0xFF
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct flash_kv_env_tag
+{
+    /* Sequence number of the active page, its first free unit and the
+     * active page */
+    uint32_t seq;
+    uint16_t free;
+    uint8_t active;
+
+    /* Location of the latest record of each key (page FLASH_KV_NONE if the
+     * key has no record) */
+    uint8_t page[FLASH_KV_KEYS];
+    uint16_t unit[FLASH_KV_KEYS];
+
+    /* Value bytes written by the application, units programmed and pages
+     * erased (write amplification) */
+    uint32_t value_bytes;
+    uint32_t units;
+    uint32_t erases;
+};
+
+extern struct flash_kv_env_tag flash_kv;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void Flash_KV_Initialize(void);
+
+extern bool Flash_KV_Read(uint8_t key, void *value, uint8_t length);
+
+extern bool Flash_KV_Write(uint8_t key, const void *value, uint8_t length);
+
+/* Flash access */
+extern uint32_t Flash_KV_Port_Read(uint32_t offset);
+
+extern bool Flash_KV_Port_Write(uint32_t offset, uint32_t word0,
+                                uint32_t word1);
+
+extern bool Flash_KV_Port_Erase(uint8_t page);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_KV_H */
@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * history.h
+ * - Temperature history. Timestamped samples are appended to a ring of
+ *   fixed-size blocks in .noinit (retained in sleep mode and across warm
+ *   resets). Each block starts with an absolute sample; the following samples
+ *   are stored as zig-zag varint deltas:
+ *     varint(zigzag(dtemp) << 1 | has_dod) [varint(zigzag(dod))]
+ *   with dtemp the temperature delta in 1/16 degrees Celsius and dod the
+ *   change of the time delta, only stored if the sampling interval has
+ *   changed. A steady 1-per-minute series takes one byte per sample. When
+ *   the ring is full, the oldest block is dropped.
+ * ------------------------------------------------------------------------- */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Keep the temperature history and its bulk download. The light stack only
+ * retains DRAM0 (sections_light.ld): the baseline leaves 440 bytes between
+ * the end of .noinit and the 400-byte main stack, of which the heap used by
+ * srand/rand needs 64. The other modules of the application take about 340
+ * of the rest, which leaves no room for a ring of useful size (two 64-byte
+ * blocks and the download state take 180 bytes), so the light stack goes
+ * without.
+ * Options: 1 (enabled) or 0 (disabled) */
+#if defined(CFG_LIGHT_STACK)
+#define HISTORY_ENABLE                  0
+#else
+#define HISTORY_ENABLE                  1
+#endif
+
+/* Ring size: block size in bytes (at most 255) and number of blocks; about 3
+ * days of 1-per-minute samples */
+#define HISTORY_BLOCK_SIZE              128
+#define HISTORY_BLOCKS                  40
+
+#define HISTORY_MAGIC                   0x48495354
+
+/* Block header size: seq, time, temperature, count, used */
+#define HISTORY_HEADER_SIZE             12
+#define HISTORY_DATA_SIZE               (HISTORY_BLOCK_SIZE - \
+                                         HISTORY_HEADER_SIZE)
+
+/* Maximum length of an encoded sample (two 32-bit varints) */
+#define HISTORY_RECORD_MAX              10
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct history_sample
+{
+    /* Sequence number, incremented for each sample since the history was
+     * cleared */
+    uint32_t seq;
+
+    /* Time since power-up in 0.1 s (TLM SEC_CNT) */
+    uint32_t time;
+
+    /* Temperature, signed 8.8 fixed-point in degrees Celsius (1/16 degree
+     * resolution) */
+    int16_t temperature;
+};
+
+/* Block layout, also the wire format of the bulk history download (little
+ * endian, no padding: HISTORY_HEADER_SIZE bytes of header, then the used
+ * data bytes) */
+struct history_block
+{
+    /* First sample of the block */
+    uint32_t seq;
+    uint32_t time;
+    int16_t temperature;
+
+    /* Number of samples and of data bytes used */
+    uint8_t count;
+    uint8_t used;
+
+    uint8_t data[HISTORY_DATA_SIZE];
+};
+
+struct history_env_tag
+{
+    uint32_t magic;
+
+    /* Ring index of the newest block and number of blocks in use */
+    uint8_t head;
+    uint8_t nb;
+
+    /* Sequence number of the next sample */
+    uint32_t next_seq;
+
+    /* Last sample (temperature in 1/16 degree) and time delta */
+    uint32_t last_time;
+    int32_t last_dtime;
+    int16_t last_temp;
+
+    /* Value of nct375.samples at the last append */
+    uint8_t samples;
+
+    struct history_block blocks[HISTORY_BLOCKS];
+};
+
+struct history_iter
+{
+    /* Ring index of the current block and number of blocks after it */
+    uint8_t index;
+    uint8_t left;
+
+    /* Decoding position and samples left in the current block, including
+     * the current sample */
+    uint8_t offset;
+    uint8_t pending;
+
+    int32_t dtime;
+    struct history_sample sample;
+};
+
+extern struct history_env_tag history;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void History_Initialize(bool keep);
+
+extern void History_Clear(void);
+
+extern void History_Append(uint32_t time, int16_t temperature);
+
+extern const struct history_block *History_Block_Find(uint32_t seq);
+
+extern bool History_Iterate_Start(struct history_iter *it, uint32_t seq);
+
+extern bool History_Iterate_Next(struct history_iter *it,
+                                 struct history_sample *sample);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORY_H */
@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * history_download.h
+ * - Bulk history download over the custom service. Writing
+ *     HISTORY_DOWNLOAD_CMD_START | seq (uint32)
+ *   to the RX value streams the history blocks from the block holding
+ *   sample seq onwards as TX value notifications, filling the notification
+ *   window of the custom service. Each chunk is
+ *     seq (uint32) | offset (uint8) | block bytes [offset, offset + n)
+ *   with seq the first sample of the block (struct history_block layout) and
+ *   n limited by the ATT MTU; once the MTU has been raised, each block is
+ *   sent in a single chunk. The stream ends with a header-only chunk with
+ *   offset HISTORY_DOWNLOAD_END and seq the next sample to request, which
+ *   resumes the download on a later connection. All values are little
+ *   endian. HISTORY_DOWNLOAD_CMD_STOP stops the stream. A chunk dropped
+ *   because the stack ran out of buffers is sent again, from the start of
+ *   its block.
+ * ------------------------------------------------------------------------- */
+
+#ifndef HISTORY_DOWNLOAD_H
+#define HISTORY_DOWNLOAD_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "history.h"
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* RX value commands */
+#define HISTORY_DOWNLOAD_CMD_START      0x01
+#define HISTORY_DOWNLOAD_CMD_STOP       0x02
+
+/* Chunk header size and offset of the end-of-stream chunk */
+#define HISTORY_DOWNLOAD_HEADER_SIZE    5
+#define HISTORY_DOWNLOAD_END            0xFF
+#define HISTORY_DOWNLOAD_CHUNK_MAX      (HISTORY_DOWNLOAD_HEADER_SIZE + \
+                                         HISTORY_BLOCK_SIZE)
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct history_download_env_tag
+{
+    bool active;
+    uint8_t conidx;
+
+    /* Offset of the next chunk in the current block */
+    uint8_t offset;
+
+    /* Next sample to send */
+    uint32_t next;
+
+    /* Current block: first sample, and number of samples and size when its
+     * transfer started (the newest block still grows) */
+    uint32_t blk_seq;
+    uint8_t blk_count;
+    uint8_t blk_size;
+
+    /* Sample to resume from if a chunk in flight is dropped, by seq_num
+     * modulo CS_NTF_WINDOW_MAX, and first seq_num sent since the download
+     * was started, stopped or resumed */
+    uint32_t resume[CS_NTF_WINDOW_MAX];
+    uint16_t seq_num_start;
+};
+
+extern struct history_download_env_tag history_download;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void History_Download_Command(uint8_t conidx, const uint8_t *value,
+                                     uint16_t length);
+
+extern void History_Download_Sent(uint16_t seq_num, uint8_t status);
+
+extern void History_Download_Continue(void);
+
+extern void History_Download_Stop(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORY_DOWNLOAD_H */
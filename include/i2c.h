@@ -15,9 +15,14 @@
  *   currently supported.
  * - The DIOs used by the I2C interface are not configured by this library; they
  *   have to be configured on the application level.
- * - Known limitations:
- *   > DMA transfers are not supported.
- *   > I2C bus errors are not treated.
+ * - Transactions are queued (up to I2C_QUEUE_SIZE) and executed back to back
+ *   from the interrupt handler.
+ * - With I2C_DMA_ENABLE, transactions of at least I2C_DMA_MIN_LENGTH bytes are
+ *   transferred by DMA; other transactions are handled byte per byte by
+ *   I2C_IRQHandler.
+ * - Bus errors, NACKs and transactions exceeding I2C_TIMEOUT_MS (SysTick) are
+ *   retried up to I2C_RETRY_MAX times, with a bus recovery sequence if the
+ *   DIOs have been registered with I2C_Recovery_Config.
  * ----------------------------------------------------------------------------
  * $Revision: $
  * $Date: $
@@ -39,6 +44,7 @@ extern "C"
  * Include files
  * --------------------------------------------------------------------------*/
 #include <rsl10.h>
+#include <stdbool.h>
 
 /* ----------------------------------------------------------------------------
  * Defines
@@ -48,24 +54,206 @@ extern "C"
  * I2C_DBG_DIO_NUM (un-comment the following line). */
 /* #define I2C_DBG_DIO_NUM 9 */
 
+/* Maximum number of transactions waiting in the queue (in addition to the
+ * transaction in progress), 20 bytes of RAM each. The light stack keeps the
+ * 3 places taken at start-up by NCT375_Alarm_Configure after
+ * NCT375_PowerUp. */
+#if defined(CFG_LIGHT_STACK)
+#define I2C_QUEUE_SIZE                  3
+#else
+#define I2C_QUEUE_SIZE                  4
+#endif
+
+/* Transaction status, returned by I2C_WriteRead and provided in
+ * i2c_env.xfer_status while a callback function is executed */
+#define I2C_XFER_OK                     0
+#define I2C_XFER_QUEUE_FULL             1
+#define I2C_XFER_NACK                   2
+#define I2C_XFER_BUS_ERROR              3
+#define I2C_XFER_TIMEOUT                4
+
+/* Deadline of a transaction in ms, measured with the SysTick timer (0 to
+ * disable). It has to cover the complete transaction at the configured
+ * speed. */
+#define I2C_TIMEOUT_MS                  10
+#define I2C_Timeout_IRQHandler          SysTick_Handler
+
+/* Number of retries of a failed transaction before its callback is called
+ * with the error status */
+#define I2C_RETRY_MAX                   2
+
+/* Half SCL period of the bus recovery sequence (5 us, 100 kHz) in cycles */
+#define I2C_RECOVERY_HALF_PERIOD        (SystemCoreClock / 200000)
+
+/* Status flags indicating a bus error or an arbitration loss */
+#define I2C_STATUS_ERROR_MASK           ((1 << I2C_STATUS_BUS_ERROR_Pos) | \
+                                         (1 << I2C_STATUS_ERROR_Pos))
+
+/* DMA transfer mode. A DMA transaction raises one (I2C stop) interrupt per
+ * read or write sequence, plus one DMA interrupt to set the last data flag
+ * if the sequence is 2 bytes or longer, instead of one interrupt per byte,
+ * address and stop condition. Interrupts per NCT375 transaction, measured
+ * by tools/i2c_sim.c:
+ *   bytes                      CM3     DMA
+ *   1 (pointer write)          2       1
+ *   2 (one-shot trigger)       3       2
+ *   3 (temperature read)       6       3
+ * The library work per transaction is the same on the host within the
+ * measurement noise, so all transactions use the DMA engine. One interrupt
+ * per transaction is only reached by single-byte sequences: the last data
+ * flag has to be set by the CPU while the last byte of a longer sequence is
+ * transferred, and the transaction only completes with the stop interrupt.
+ * Options: 1 (enabled) or 0 (disabled) */
+#ifndef I2C_DMA_ENABLE
+#define I2C_DMA_ENABLE                  1
+#endif
+
+/* Minimum number of bytes (TX + RX) of a transaction transferred by DMA;
+ * shorter transactions are handled byte per byte (CM3 engine) */
+#ifndef I2C_DMA_MIN_LENGTH
+#define I2C_DMA_MIN_LENGTH              1
+#endif
+
+/* DMA channel used by the I2C interface. Channels 0 and 1 are used to
+ * save/restore the baseband and RF registers in each sleep/wake-up cycle. */
+#define I2C_DMA_CHANNEL                 2
+#define I2C_DMA_IRQn                    DMA2_IRQn
+#define I2C_DMA_IRQHandler              DMA2_IRQHandler
+
+/* DMA channel configurations for the write (TX) and read (RX) sequences */
+#define I2C_DMA_TX_CFG                  (DMA_DEST_I2C | DMA_TRANSFER_M_TO_P | \
+                                         DMA_LITTLE_ENDIAN | DMA_PRIORITY_0 | \
+                                         DMA_COMPLETE_INT_ENABLE | \
+                                         DMA_COUNTER_INT_DISABLE | \
+                                         DMA_START_INT_DISABLE | \
+                                         DMA_ERROR_INT_DISABLE | \
+                                         DMA_DISABLE_INT_DISABLE | \
+                                         DMA_SRC_WORD_SIZE_8 | \
+                                         DMA_DEST_WORD_SIZE_8 | \
+                                         DMA_SRC_ADDR_INC | \
+                                         DMA_DEST_ADDR_STATIC | DMA_ENABLE)
+#define I2C_DMA_RX_CFG                  (DMA_SRC_I2C | DMA_TRANSFER_P_TO_M | \
+                                         DMA_LITTLE_ENDIAN | DMA_PRIORITY_0 | \
+                                         DMA_COMPLETE_INT_DISABLE | \
+                                         DMA_COUNTER_INT_ENABLE | \
+                                         DMA_START_INT_DISABLE | \
+                                         DMA_ERROR_INT_DISABLE | \
+                                         DMA_DISABLE_INT_DISABLE | \
+                                         DMA_SRC_WORD_SIZE_8 | \
+                                         DMA_DEST_WORD_SIZE_8 | \
+                                         DMA_SRC_ADDR_STATIC | \
+                                         DMA_DEST_ADDR_INC | DMA_ENABLE)
+
+/* I2C interface configuration for each transfer engine */
+#define I2C_CONFIG_COMMON               (I2C_STOP_INT_ENABLE | \
+                                         I2C_SAMPLE_CLK_ENABLE | \
+                                         I2C_SLAVE_DISABLE)
+#define I2C_CONFIG_CM3                  (I2C_CONTROLLER_CM3 | \
+                                         I2C_AUTO_ACK_DISABLE)
+#define I2C_CONFIG_DMA                  (I2C_CONTROLLER_DMA | \
+                                         I2C_AUTO_ACK_ENABLE)
+
+/* Transfer engines */
+#define I2C_ENGINE_CM3                  0
+#define I2C_ENGINE_DMA                  1
+#define I2C_ENGINE_NB                   2
+
+/* Benchmark: count the CPU cycles spent by the library (excluding callback
+ * functions) per engine and per transaction length, for transactions of up to
+ * I2C_BENCH_LENGTHS bytes. To compare both engines, build the application
+ * twice with the options given on the compiler command line (no source
+ * change):
+ *   -DI2C_BENCHMARK=1                                             (DMA only)
+ *   -DI2C_BENCHMARK=1 -DI2C_DMA_ENABLE=0                          (CM3 only)
+ * run each for a few hundred samples and read i2c_env.bench with the
+ * debugger: bench[engine][length - 1].cycles / .count is the average cost
+ * of a transaction of that length, interrupt entry and exit excluded. It
+ * confirms on the target the host measurement of the library work that
+ * I2C_DMA_MIN_LENGTH is chosen from.
+ * Options: 1 (enabled) or 0 (disabled) */
+#ifndef I2C_BENCHMARK
+#define I2C_BENCHMARK                   0
+#endif
+#ifndef I2C_BENCH_LENGTHS
+#define I2C_BENCH_LENGTHS               3
+#endif
 
 /* ----------------------------------------------------------------------------
  * Global variables and types
  * --------------------------------------------------------------------------*/
 
+/* Queued I2C transaction; pointers first, so that it takes 20 bytes */
+struct i2c_xfer_tag
+{
+	uint8_t *tx_buffer;
+	uint8_t *rx_buffer;
+	void *callbackfunction;
+	uint16_t tx_buffer_length;
+	uint16_t rx_buffer_length;
+	uint8_t address;
+};
+
+#if (I2C_BENCHMARK)
+/* Benchmark results for one engine and transaction length */
+struct i2c_bench_tag
+{
+	uint32_t count;
+	uint32_t cycles;
+};
+#endif
+
 /* I2C environment */
 struct i2c_env_tag
 {
-	uint8_t last_status;
+	uint32_t last_status;
+	uint8_t speed;
+	uint8_t engine;
+
+	/* Transaction in progress */
 	uint8_t address;
 	uint8_t *tx_buffer;
 	int16_t tx_buffer_length;
 	uint8_t *rx_buffer;
 	int16_t rx_buffer_length;
 	void *callbackfunction;
+	bool busy;
+
+	/* Completion status of the transaction in progress */
+	uint8_t xfer_status;
+
+	/* Number of failed attempts since I2C_Master_Init */
+	uint16_t error_count;
+
+	/* Copy of the transaction in progress (for retries) and number of 
+	 * retries */
+	struct i2c_xfer_tag xfer;
+	uint8_t retries;
+
+	/* Transactions waiting to be started */
+	uint8_t queue_head;
+	uint8_t queue_count;
+	struct i2c_xfer_tag queue[I2C_QUEUE_SIZE];
+
+#if (I2C_BENCHMARK)
+	/* Cycles spent on the transaction in progress */
+	uint32_t bench_start;
+	uint32_t bench_cycles;
+	uint32_t bench_length;
+	struct i2c_bench_tag bench[I2C_ENGINE_NB][I2C_BENCH_LENGTHS];
+#endif
 };
 extern struct i2c_env_tag    i2c_env;
 
+/* DIOs used for the bus recovery sequence */
+struct i2c_recovery_tag
+{
+	uint32_t config;
+	uint8_t scl;
+	uint8_t sda;
+	bool enabled;
+};
+extern struct i2c_recovery_tag    i2c_recovery;
+
 /* ----------------------------------------------------------------------------
  * Function prototype definitions
  * --------------------------------------------------------------------------*/
@@ -75,27 +263,66 @@ extern struct i2c_env_tag    i2c_env;
 /* I2C_Master_Init: Initialize the I2C interface in master mode */
 void I2C_Master_Init(uint8_t speed);
 
+/* I2C_Recovery_Config: Register the I2C DIOs for the bus recovery sequence */
+void I2C_Recovery_Config(uint8_t scl, uint8_t sda, uint32_t config);
+
 /**** Write/read functions ****/
 
-/* I2C_WriteRead: Initiates a write, read or combined write-read transaction, 
+/* I2C_WriteRead: Queues a write, read or combined write-read transaction, 
                   of one or multiple bytes */
-void I2C_WriteRead(uint8_t address, uint8_t *txdata, uint16_t txlength,
+uint8_t I2C_WriteRead(uint8_t address, uint8_t *txdata, uint16_t txlength,
 		             uint8_t *rxdata, uint16_t rxlength, void *callback);
 
-/* I2C_Write: Initiates a write transaction of one or multiple bytes */
-void I2C_Write(uint8_t address, uint8_t *txdata, uint16_t txlength,
+/* I2C_Write: Queues a write transaction of one or multiple bytes */
+uint8_t I2C_Write(uint8_t address, uint8_t *txdata, uint16_t txlength,
 		         void *callback);
 
-/* I2C_Read: Initiates a read transaction of one or multiple bytes */
-void I2C_Read(uint8_t address, uint8_t *rxdata, uint16_t rxlength,
+/* I2C_Read: Queues a read transaction of one or multiple bytes */
+uint8_t I2C_Read(uint8_t address, uint8_t *rxdata, uint16_t rxlength,
 		        void *callback);
 
 /**** Support functions (internally used by the library) ****/
 
+/* I2C_StartNext: Starts the next queued transaction, if any */
+void I2C_StartNext(void);
+
+/* I2C_StartCurrent: Starts (or restarts) the transaction in progress */
+void I2C_StartCurrent(void);
+
+/* I2C_Error: Aborts the transaction in progress, then retries or completes
+              it with an error status */
+void I2C_Error(uint8_t status);
+
+/* I2C_Bus_Recover: Clocks SCL until a slave releases SDA */
+void I2C_Bus_Recover(void);
+
+/* I2C_Timeout_Start/Stop: Arm/disarm the deadline of the transaction */
+void I2C_Timeout_Start(void);
+void I2C_Timeout_Stop(void);
+
+/* I2C_Timeout_IRQHandler: Deadline (SysTick) interrupt service function */
+void I2C_Timeout_IRQHandler(void);
+
+/* I2C_Complete: Reports the completion of the transaction in progress and
+                 chains into the next queued transaction */
+void I2C_Complete(uint8_t status);
+
 /* I2C_IRQHandler: I2C interrupt service function to handle all read and write 
                    operations */
 void I2C_IRQHandler(void);
 
+#if (I2C_DMA_ENABLE)
+/* I2C_DMA_StartWrite: Starts the write sequence of a DMA transaction */
+void I2C_DMA_StartWrite(void);
+
+/* I2C_DMA_StartRead: Starts the read sequence of a DMA transaction */
+void I2C_DMA_StartRead(void);
+
+/* I2C_DMA_IRQHandler: DMA channel interrupt service function indicating the
+                       last byte of a DMA transaction */
+void I2C_DMA_IRQHandler(void);
+#endif
+
 /* ----------------------------------------------------------------------------
  * Close the 'extern "C"' block
  * ------------------------------------------------------------------------- */
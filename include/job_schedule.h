@@ -0,0 +1,119 @@
+/* ----------------------------------------------------------------------------
+ * job_schedule.h
+ * - Wake-coalescing job scheduler. Periodic work is described by a job table
+ *   (period, deadline slack and estimated cost, in wake-ups and us). On each
+ *   wake-up the jobs that have reached their deadline are selected; if any of
+ *   them is periodic work (period > 1), the jobs within their slack are pulled
+ *   forward into the same wake window. Asynchronous jobs are started in
+ *   decreasing latency order so that their peripheral latencies overlap,
+ *   synchronous jobs then run in table order.
+ *
+ *   This module has no device dependencies, so that the selection logic can
+ *   be run by the host simulation in tools/job_schedule_sim.c.
+ * ------------------------------------------------------------------------- */
+
+#ifndef JOB_SCHEDULE_H
+#define JOB_SCHEDULE_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Maximum number of jobs in a table (size of the due job mask) */
+#define JOB_SCHEDULE_MAX                8
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct job_desc
+{
+    /* Job function; an asynchronous job only starts its operation */
+    void (*start)(void);
+
+    /* Asynchronous jobs: flag cleared on completion of the operation;
+     * NULL for synchronous jobs */
+    volatile bool *pending;
+
+    /* Period and number of wake-ups the job may run before its deadline to
+     * share a wake window with other periodic work */
+    uint16_t period;
+    uint16_t slack;
+
+    /* Number of wake-ups accounted as elapsed at initialization; period - 1
+     * runs the job on the first wake-up */
+    uint16_t offset;
+
+    /* Estimated duration in us (latency of the operation for asynchronous
+     * jobs) */
+    uint16_t cost_us;
+};
+
+struct job_schedule_tag
+{
+    const struct job_desc *jobs;
+    uint8_t nb;
+
+    /* Execution order: asynchronous jobs by decreasing cost, then
+     * synchronous jobs in table order */
+    uint8_t order[JOB_SCHEDULE_MAX];
+
+    /* Wake-ups elapsed since each job last ran */
+    uint16_t elapsed[JOB_SCHEDULE_MAX];
+
+    /* Period of each job, initialized from the job table */
+    uint16_t period[JOB_SCHEDULE_MAX];
+};
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void Job_Schedule_Initialize(struct job_schedule_tag *sched,
+                                    const struct job_desc *jobs, uint8_t nb);
+
+extern bool Job_Schedule_Set_Period(struct job_schedule_tag *sched,
+                                    void (*start)(void), uint16_t period);
+
+extern uint16_t Job_Schedule_Remaining(const struct job_schedule_tag *sched,
+                                       void (*start)(void));
+
+extern uint8_t Job_Schedule_Select(struct job_schedule_tag *sched);
+
+extern void Job_Schedule_Start(const struct job_schedule_tag *sched,
+                               uint8_t due);
+
+extern volatile bool *Job_Schedule_Pending(const struct job_schedule_tag *sched,
+                                           uint8_t due);
+
+extern uint8_t Job_Schedule_Completed(const struct job_schedule_tag *sched,
+                                      uint8_t due);
+
+extern void Job_Schedule_Finish(const struct job_schedule_tag *sched,
+                                uint8_t due);
+
+extern uint32_t Job_Schedule_Cost(const struct job_schedule_tag *sched,
+                                  uint8_t due);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JOB_SCHEDULE_H */
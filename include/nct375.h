@@ -14,6 +14,49 @@
  */
 #define ONE_SHOT_MODE
 
+/* ONE-SHOT-PIPELINED	- every wake reads the conversion triggered on the previous wake and triggers
+ * 						  the next one in a single I2C burst, so every advertisement carries a new sample
+ * (for ONE-SHOT-MODE alternating trigger and read wakes commented macro)
+ */
+#define ONE_SHOT_PIPELINED
+
+#if defined(ONE_SHOT_PIPELINED) && !defined(ONE_SHOT_MODE)
+#error "ONE_SHOT_PIPELINED requires ONE_SHOT_MODE"
+#endif
+
+/* ALARM-MODE		- TOS/THYST thresholds are programmed and the OS/ALERT output (comparator mode,
+ * 					  active low) wakes the SoC up when the temperature exceeds TOS
+ * (requires NORMAL-MODE; for no alarm commented macro)
+ */
+/* #define ALARM_MODE */
+
+/* Alarm thresholds, signed 8.8 fixed-point in C (only the upper 12 bits are valid) */
+#define NCT375_ALARM_TOS			(8 << 8)
+#define NCT375_ALARM_THYST			(7 << 8)
+
+/* Alarm configuration register: fault queue of 2 samples, comparator mode, active low */
+#define NCT375_ALARM_CONFIG			0x08
+
+#if defined(ALARM_MODE) && defined(ONE_SHOT_MODE)
+#error "ALARM_MODE requires NORMAL-MODE (ONE_SHOT_MODE commented)"
+#endif
+
+/* Temperature register pair (MSB, LSB) to signed 8.8 fixed-point in C; only
+ * LSB D7..D4 are valid (12-bit resolution) */
+#define NCT375_TEMP_FIXED(msb, lsb)	((int16_t)(((uint16_t)(msb) << 8) | ((lsb) & 0xF0)))
+
+/* Temperature not available (Eddystone TLM "not supported" value) */
+#define NCT375_TEMP_INVALID			((int16_t)0x8000)
+
+/* One-shot sampling states */
+enum NCT375_State
+{
+	NCT375_STATE_IDLE,			// no conversion triggered
+	NCT375_STATE_TRIGGER,		// one-shot register write in progress
+	NCT375_STATE_CONVERTING,	// conversion running, result not read yet
+	NCT375_STATE_READ			// temperature register read in progress
+};
+
 struct NCT375_Reg_tag
 {
 	uint8_t Config;
@@ -22,23 +65,29 @@ struct NCT375_Reg_tag
 	short int Thyst;
 	short int TOs;
 	uint16_t Temp;
+
+	/* One-shot state machine */
+	uint8_t state;
+	bool busy;
+
+	/* Number of temperatures read successfully (wraps around) */
+	uint8_t samples;
 };
 
 extern struct NCT375_Reg_tag nct375;
 
 void NCT375_Received_Temperature(void);
+void NCT375_Temperature_Read(void);
 void NCT375_ONEShot_ModeOn(void);
-void NCT375_ONEShot_StartSample(void);
-void NCT375_ONEShot_ReadSample(void);
+void NCT375_ONEShot_Process(void);
+void NCT375_ONEShot_Pipeline(void);
+void NCT375_Alarm_Configure(void);
+void NCT375_ONEShot_Triggered(void);
+void NCT375_ONEShot_Received(void);
 void NCT375_ONEShot_ModeOff(void);
-void NCT375_ONEShotReg_Read(void);
-void NCT375_ConfReg_Read(void);
 void NCT375_PowerDown(void);
 void NCT375_PowerUp(void);
-void NCT375_I2C_Delay(void);
 void NCT375_THYST_Write(short int);
-short int NCT375_THYST_Read(void);
 void NCT375_TOS_Write(short int);
-short int NCT375_TOS_Read(void);
 
 #endif /* NCT375_H_ */
@@ -0,0 +1,129 @@
+/* ----------------------------------------------------------------------------
+ * pad_policy.h
+ * - DIO assignment and pad policy. Each DIO used by the application is given
+ *   a sleep state and a wake state (mode, pull, drive, output level) in
+ *   the pad_policy table (pad_policy_table.c). Pad_Policy_Sleep applies the
+ *   sleep states before each sleep entry (the pads are then held by the pad
+ *   retention) and Pad_Policy_Wake the wake states at each wake-up, before
+ *   the pad retention is released, or after a sleep attempt that did not
+ *   enter sleep mode. Pads owned by another driver keep the configuration
+ *   of that driver (sensor ground and supply); the pads of the sensor bus
+ *   are handed back to the I2C interface by Pad_Policy_Wake with the
+ *   configuration of initialization. The pads of the sensor bus are
+ *   disabled during sleep while
+ *   the sensor is unpowered (SENSOR_POWER_GATING), so that no pull-up
+ *   back-powers it. DIOs not in the table keep their reset configuration.
+ *
+ *   This header and pad_policy_table.c do not depend on the SDK; the leakage
+ *   budget of the table is reported on the host by
+ *   tools/pad_leakage_report.c.
+ * ------------------------------------------------------------------------- */
+
+#ifndef PAD_POLICY_H
+#define PAD_POLICY_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Pad profile: the development profile lights the LED while awake, the
+ * production profile keeps it dark
+ * Options: 1 (production) or 0 (development) */
+#define PAD_POLICY_PRODUCTION           0
+
+/* DIO number that is connected to LED of EVB */
+#define LED_DIO                         6
+
+/* DIO used for the I2C interface to interface the SI7042 sensor */
+#define I2C_SDA_DIO_NUM                 12 /* 0 */
+#define I2C_SCL_DIO_NUM                 11 /* 1 */
+#define I2C_GND_DIO_NUM                 10 /* 2 */
+#define I2C_PWR_DIO_NUM                 8  /* 4 */
+
+/* DIO connected to the NCT375 OS/ALERT output (alarm mode); only DIO0 to
+ * DIO3 can wake up the system from sleep mode */
+#define NCT375_ALERT_DIO                3
+
+/* DIO number that is used for easy re-flashing (recovery mode) */
+#define RECOVERY_DIO                    12
+
+/* Pad modes; PAD_MODE_OWNED pads are configured by their driver (the
+ * pull and level given in the table are the ones of that driver) */
+#define PAD_MODE_DISABLE                0
+#define PAD_MODE_INPUT                  1
+#define PAD_MODE_OUTPUT                 2
+#define PAD_MODE_OWNED                  3
+
+#define PAD_PULL_NONE                   0
+#define PAD_PULL_WEAK_UP                1
+#define PAD_PULL_WEAK_DOWN              2
+#define PAD_PULL_STRONG_UP              3
+
+#define PAD_DRIVE_2X                    0
+#define PAD_DRIVE_3X                    1
+#define PAD_DRIVE_5X                    2
+#define PAD_DRIVE_6X                    3
+
+/* External load of a pad, used by the leakage report and to disable the
+ * sensor bus pads while the sensor is unpowered */
+#define PAD_LOAD_NONE                   0
+#define PAD_LOAD_LED                    1
+#define PAD_LOAD_SENSOR_BUS             2
+#define PAD_LOAD_SENSOR_SUPPLY          3
+#define PAD_LOAD_OPEN_DRAIN             4
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct pad_state_tag
+{
+    uint8_t mode;
+    uint8_t pull;
+    uint8_t drive;
+
+    /* Output level (PAD_MODE_OUTPUT) */
+    uint8_t level;
+};
+
+struct pad_policy_tag
+{
+    const char *name;
+    uint8_t dio;
+    uint8_t load;
+    struct pad_state_tag sleep;
+    struct pad_state_tag wake;
+};
+
+extern const struct pad_policy_tag pad_policy[];
+extern const uint8_t pad_policy_count;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void Pad_Policy_Sleep(void);
+
+extern void Pad_Policy_Wake(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PAD_POLICY_H */
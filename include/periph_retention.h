@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * periph_retention.h
+ * - Peripheral context retention. The I2C and DIO configuration written at
+ *   initialization is kept in RAM (retained in sleep mode); after wake-up only
+ *   the registers that no longer match it are written back, instead of
+ *   re-initializing the I2C interface and its DIOs.
+ * ------------------------------------------------------------------------- */
+
+#ifndef PERIPH_RETENTION_H
+#define PERIPH_RETENTION_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <rsl10.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Restore the peripheral context from the retained snapshot at wake-up, or
+ * re-initialize the I2C interface and its DIOs on each wake-up (previous
+ * behavior, kept to compare both paths with the wake-window profiler)
+ * Options: 1 (snapshot) or 0 (re-initialize) */
+#define PERIPH_RETENTION                1
+
+/* Number of DIOs in the snapshot */
+#define PERIPH_RETENTION_DIO_NB         2
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct periph_retention_env_tag
+{
+    /* Register snapshot, with the I2C speed configuration used by the DMA
+     * engine to reconfigure the interface */
+    uint32_t i2c_ctrl0;
+    uint8_t i2c_speed;
+    uint8_t dio_num[PERIPH_RETENTION_DIO_NB];
+    uint32_t dio_cfg[PERIPH_RETENTION_DIO_NB];
+
+    /* Number of wake-ups with intact and with restored registers. The I2C
+     * DIOs are handed back to the interface by Pad_Policy_Wake before the
+     * restore, with the configuration of the snapshot: a restore is counted
+     * when I2C->CTRL0 has lost its value in sleep mode, when a sampling
+     * wake-up has reconfigured the interface, or when a DIO register has
+     * been changed since */
+    uint32_t intact;
+    uint32_t restored;
+};
+
+extern struct periph_retention_env_tag periph_retention;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void Periph_Retention_Save(void);
+
+extern void Periph_Retention_Restore(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERIPH_RETENTION_H */
@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * retained_state.h
+ * - Retained application state. The TLM counters, the last sample, the
+ *   battery average and the RC oscillator calibration are kept in a packed,
+ *   versioned and CRC-protected block in the .noinit section, so that they
+ *   survive a watchdog or soft reset and can be resumed instead of restarting
+ *   from zero. After a power-on reset, the TLM counters and the runtime
+ *   configuration are restored from the flash key/value store (flash_kv.h),
+ *   written at most every RETAINED_PERSIST_MINUTES.
+ * ------------------------------------------------------------------------- */
+
+#ifndef RETAINED_STATE_H
+#define RETAINED_STATE_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <rsl10.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "app_config.h"
+#include "flash_kv.h"
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Block identification; the version has to be incremented whenever the
+ * layout of struct retained_state_tag changes */
+#define RETAINED_STATE_MAGIC            0x5253
+#define RETAINED_STATE_VERSION          3
+
+/* RC oscillator period available from before the reset */
+#define RETAINED_RC_PERIOD_VALID()      (retained_state_warm && \
+                                         retained_state.rc_period != 0)
+
+/* Flash keys of the persisted state and minimum time between two writes
+ * (the flash is only written if a value has changed) */
+#define RETAINED_KEY_COUNTERS           0
+#define RETAINED_KEY_CONFIG             1
+#define RETAINED_PERSIST_MINUTES        10
+
+/* CRC-16/CCITT-FALSE */
+#define RETAINED_STATE_CRC_POLY         0x1021
+#define RETAINED_STATE_CRC_INIT         0xFFFF
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct retained_state_tag
+{
+    uint16_t magic;
+    uint8_t version;
+
+    /* Number of resets resumed from this block (wraps around) */
+    uint8_t warm_resets;
+
+    /* TLM advertising PDU count and time since power-up in 0.1 s */
+    uint32_t adv_count;
+    uint32_t adv_time;
+
+    /* Last temperature sample, signed 8.8 fixed-point in degrees Celsius */
+    int16_t temperature;
+
+    /* Battery level average (ADC units of VBAT) */
+    uint16_t batt_lvl;
+
+    /* Averaged RC oscillator period measurement (0 if not measured) */
+    uint32_t rc_period;
+
+    /* Runtime configuration */
+    struct app_config_tag config;
+
+    /* Value of adv_time at the last write of the flash keys */
+    uint32_t persist_time;
+
+    /* CRC of all preceding fields */
+    uint16_t crc;
+} __attribute__ ((packed));
+
+/* Value of the RETAINED_KEY_COUNTERS flash key */
+struct retained_counters
+{
+    uint32_t adv_count;
+    uint32_t adv_time;
+};
+
+extern struct retained_state_tag retained_state;
+
+/* Set by Retained_State_Load if the block was valid at boot */
+extern bool retained_state_warm;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern bool Retained_State_Load(void);
+
+extern void Retained_State_Save(void);
+
+extern void Retained_State_Persist(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETAINED_STATE_H */
@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+ * sample_wake.h
+ * - RTC-alarm-driven sensor sampling. The RTC alarm provides a sampling
+ *   timebase independent of the advertising interval. A wake-up caused by the
+ *   RTC alarm alone (the baseband timer has not expired) is a minimal wake:
+ *   the baseband is not forced awake and the system clock stays on the RC
+ *   oscillator; only the NCT375 is accessed before going back to sleep. In
+ *   one-shot mode, a sample takes two such wake-ups: the first triggers a
+ *   conversion, the second one, SAMPLE_WAKE_CONVERSION_MS later, reads it
+ *   and stores the sample; the conversion runs while the system sleeps.
+ *   BLE wake-ups only advertise the last sample.
+ * ------------------------------------------------------------------------- */
+
+#ifndef SAMPLE_WAKE_H
+#define SAMPLE_WAKE_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <rsl10.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Sample on RTC alarm wake-ups instead of on each BLE wake-up
+ * Options: 1 (RTC alarm) or 0 (BLE wake-up) */
+#define SAMPLE_WAKE                     0
+
+/* Default sampling interval in ms; set at runtime with the sample period
+ * of the configuration (app_config.h) */
+#define SAMPLE_INTERVAL_MS              60000
+
+/* RTC clock frequency (RTC_CLK_SRC) in Hz and RTC start value giving a
+ * sampling interval in s; the RTC alarm is raised each time the counter
+ * reaches zero, the counter is then reloaded */
+#define SAMPLE_WAKE_RTC_CLK_HZ          32768
+#define SAMPLE_WAKE_RTC_START_VALUE(s)  ((uint32_t)(s) * SAMPLE_WAKE_RTC_CLK_HZ)
+
+/* I2C speed configuration used from the 3 MHz RC oscillator (about 110 kHz,
+ * SYSCLK / (3 * (speed + 1))) */
+#define SAMPLE_WAKE_I2C_SPEED           0x08U
+
+/* One-shot conversion time of the sensor in ms, slept between the trigger
+ * and the read wake-ups; use the datasheet value of the fitted sensor */
+#define SAMPLE_WAKE_CONVERSION_MS       60
+#define SAMPLE_WAKE_CONVERSION_TICKS    ((uint32_t)SAMPLE_WAKE_CONVERSION_MS * \
+                                         SAMPLE_WAKE_RTC_CLK_HZ / 1000)
+
+/* Wake-up caused by the RTC alarm only */
+#define SAMPLE_WAKE_RTC_ONLY()          (ACS_WAKEUP_STATE->RTC_ALARM_EVENT_ALIAS \
+                                         && !ACS_WAKEUP_STATE->BB_TIMER_EVENT_ALIAS)
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct sample_wake_env_tag
+{
+    /* Number of samples stored from sampling wake-ups */
+    uint32_t count;
+};
+
+extern struct sample_wake_env_tag sample_wake;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void Sample_Wake_Configure(void);
+
+extern void Sample_Wake_Process(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAMPLE_WAKE_H */
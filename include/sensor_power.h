@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * sensor_power.h
+ * - Sensor power gating. The NCT375 is supplied from I2C_PWR_DIO_NUM
+ *   (ground on I2C_GND_DIO_NUM); instead of keeping it powered, the
+ *   sequencer switches the supply on at the end of the wake-up preceding
+ *   the sampling wake-up by SENSOR_POWER_STARTUP_MS or more, so that the
+ *   sensor start-up and its first conversion take place during sleep. The
+ *   sampling wake-up then only reads the temperature register (the pointer
+ *   register write is the only configuration re-issued: the power-on
+ *   defaults give continuous conversions) and the supply is switched off
+ *   again until the next sample. While the sensor is unpowered, the I2C
+ *   DIOs are disabled during sleep (pad_policy.h) so that their pull-ups
+ *   do not back-power it.
+ *
+ *   See tools/sensor_power_energy.c for the comparison with the one-shot
+ *   mode and the NCT375 shutdown mode.
+ * ------------------------------------------------------------------------- */
+
+#ifndef SENSOR_POWER_H
+#define SENSOR_POWER_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <rsl10.h>
+#include <stdbool.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Switch the sensor supply off between samples; useful when the sample
+ * period spans several wake-ups (with a sample on each wake-up the supply
+ * stays on and the sensor converts continuously)
+ * Options: 1 (gated) or 0 (always powered) */
+#define SENSOR_POWER_GATING             0
+
+/* Time from power-on to the end of the first conversion of the sensor */
+#define SENSOR_POWER_STARTUP_MS         100
+
+#if (SENSOR_POWER_GATING)
+#if (SAMPLE_WAKE)
+#error "SENSOR_POWER_GATING requires sampling on BLE wake-ups (SAMPLE_WAKE 0)"
+#endif
+#if defined(ALARM_MODE)
+#error "SENSOR_POWER_GATING cannot be used with ALARM_MODE"
+#endif
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+struct sensor_power_env_tag
+{
+    /* Supply state */
+    bool on;
+
+    /* Number of power-on cycles */
+    uint32_t cycles;
+};
+
+extern struct sensor_power_env_tag sensor_power;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void Sensor_Power_Initialize(void);
+
+extern void Sensor_Power_Sequence(void);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_POWER_H */
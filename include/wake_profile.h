@@ -0,0 +1,155 @@
+/* ----------------------------------------------------------------------------
+ * wake_profile.h
+ * - Wake-window profiler. Each phase of a sleep/wake cycle is timestamped
+ *   with the Cortex-M3 DWT cycle counter and the per-phase cycle counts are
+ *   stored in a ring located in the .noinit section, so that the records
+ *   survive sleep mode and can be read back with the debugger.
+ * - The DWT counter is clocked by SYSCLK and stops while the core waits in
+ *   WFI; the recorded values are therefore active CPU cycles.
+ * - tools/wake_profile_decode.c prints the per-phase breakdown of an image
+ *   of wake_profile dumped with the debugger.
+ * ------------------------------------------------------------------------- */
+
+#ifndef WAKE_PROFILE_H
+#define WAKE_PROFILE_H
+
+/* ----------------------------------------------------------------------------
+ * If building with a C++ compiler, make all of the definitions in this header
+ * have a C binding.
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Include files
+ * --------------------------------------------------------------------------*/
+#include <rsl10.h>
+
+/* ----------------------------------------------------------------------------
+ * Defines
+ * --------------------------------------------------------------------------*/
+
+/* Enable/disable the wake-window profiler
+ * Options: 1 (enabled) or 0 (disabled) */
+#define WAKE_PROFILE                    0
+
+/* Number of wake cycles kept in the retention RAM ring */
+#define WAKE_PROFILE_RECORDS            8
+
+/* Marker used to detect an initialized ring of this layout after a reset */
+#define WAKE_PROFILE_MAGIC              0x57414B32
+
+/* Phases of a sleep/wake cycle */
+enum wake_phase
+{
+    /* Wakeup_From_Sleep_Application until Continue_Application */
+    WAKE_PHASE_WAKEUP,
+
+    /* BLE_Is_Awake wait in Continue_Application */
+    WAKE_PHASE_BLE_WAIT,
+
+    /* I2C interface and I2C DIO configuration */
+    WAKE_PHASE_PERIPH,
+
+    /* Job selection and start of the asynchronous jobs; before the
+     * BLE_Is_Awake wait with EARLY_WORK */
+    WAKE_PHASE_JOBS_START,
+
+    /* Asynchronous jobs (battery, sensor), started and overlapped until all
+     * have completed */
+    WAKE_PHASE_JOBS_ASYNC,
+
+    /* Synchronous jobs (alarm, notification, advertising update) */
+    WAKE_PHASE_JOBS_SYNC,
+
+    /* Kernel_Schedule until BLE_Power_Mode_Enter */
+    WAKE_PHASE_SCHEDULE,
+
+    /* Number of phases */
+    WAKE_PHASE_NB
+};
+
+/* The start of a wake cycle is executed from retention RAM before flash is
+ * available, so the cycle counter is (re-)started with inline register
+ * accesses only */
+#if (WAKE_PROFILE)
+#define WAKE_PROFILE_START()            do                                    \
+                                        {                                     \
+                                            CoreDebug->DEMCR |=               \
+                                              CoreDebug_DEMCR_TRCENA_Msk;     \
+                                            DWT->CYCCNT = 0;                  \
+                                            DWT->CTRL |=                      \
+                                              DWT_CTRL_CYCCNTENA_Msk;         \
+                                        } while (0)
+#define WAKE_PROFILE_BEGIN()            Wake_Profile_Begin()
+#define WAKE_PROFILE_MARK(phase)        Wake_Profile_Mark(phase)
+#define WAKE_PROFILE_OVERLAPPED()       (wake_profile.overlapped++)
+#else
+#define WAKE_PROFILE_START()
+#define WAKE_PROFILE_BEGIN()
+#define WAKE_PROFILE_MARK(phase)
+#define WAKE_PROFILE_OVERLAPPED()
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Global variables and types
+ * --------------------------------------------------------------------------*/
+
+/* Cycle counts of one wake cycle */
+struct wake_profile_record
+{
+    /* Value of ble_env.adv_count when the wake cycle started */
+    uint32_t wake_id;
+
+    /* Cycles spent in each phase */
+    uint32_t cycles[WAKE_PHASE_NB];
+};
+
+struct wake_profile_env_tag
+{
+    uint32_t magic;
+
+    /* Index of the record that is currently being filled */
+    uint32_t head;
+
+    /* DWT cycle counter value at the previous mark */
+    uint32_t last;
+
+    /* Number of completed wake cycles accumulated in sum/max */
+    uint32_t wakes;
+
+    /* Per-phase latency breakdown over all completed wake cycles; the mean
+     * phase cost is sum[phase] / wakes. The sums are 64-bit: a 32-bit sum of
+     * a phase of a few 10000 cycles overflows within days. */
+    uint64_t sum[WAKE_PHASE_NB];
+    uint32_t max[WAKE_PHASE_NB];
+
+    /* EARLY_WORK: wake cycles whose asynchronous jobs had all completed
+     * when BLE was awake, i.e. whose latency was fully hidden by the
+     * wake-up wait (WAKE_PHASE_JOBS_ASYNC then only holds the check) */
+    uint32_t overlapped;
+
+    struct wake_profile_record ring[WAKE_PROFILE_RECORDS];
+};
+
+extern struct wake_profile_env_tag wake_profile;
+
+/* ----------------------------------------------------------------------------
+ * Function prototype definitions
+ * --------------------------------------------------------------------------*/
+extern void Wake_Profile_Initialize(void);
+
+extern void Wake_Profile_Begin(void);
+
+extern void Wake_Profile_Mark(uint8_t phase);
+
+/* ----------------------------------------------------------------------------
+ * Close the 'extern "C"' block
+ * ------------------------------------------------------------------------- */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WAKE_PROFILE_H */
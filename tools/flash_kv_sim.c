@@ -0,0 +1,450 @@
+/* ----------------------------------------------------------------------------
+ * flash_kv_sim.c
+ * - Host simulation of the flash key/value store. The flash model only
+ *   programs erased word pairs (1 to 0 bits) and erases whole pages. Power
+ *   losses are injected at random flash operations, tearing the operation in
+ *   progress (partly programmed word pair, partly erased page), also while
+ *   the store recovers at boot. After each reboot, every key has to read back
+ *   its last written value or, for the write interrupted, its previous one.
+ *   The same check is made across the wrap-around of the page sequence
+ *   numbers, and with program and erase failures injected at random (the
+ *   write reports the failure and the previous value is kept). Then a
+ *   loss-free run reports the write amplification, the page erases and the
+ *   flash lifetime for a persist interval.
+ *
+ *   Build and run on the host:
+ *     cc -Wall -o flash_kv_sim tools/flash_kv_sim.c code/flash_kv.c
+ *     ./flash_kv_sim <interval_min> <endurance> [<losses>]
+ *
+ *   interval_min - Persist interval in minutes (one write of each key)
+ *   endurance    - Erase cycles per page of the flash
+ *   losses       - Number of injected power losses (default 10000)
+ * ------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "../include/flash_kv.h"
+
+#define SIM_SIZE                        (FLASH_KV_PAGES * FLASH_KV_PAGE_SIZE)
+
+/* Keys written by the simulation and their value lengths, as used by the
+ * application (counters, configuration) */
+#define SIM_KEYS                        2
+static const uint8_t sim_length[SIM_KEYS] = { 8, 7 };
+
+static uint8_t sim_flash[SIM_SIZE];
+static uint32_t sim_page_erases[FLASH_KV_PAGES];
+
+/* Flash operation count, operation at which the power is lost (0: never)
+ * and power loss exit */
+static uint32_t sim_ops;
+static uint32_t sim_loss_at;
+static jmp_buf sim_loss;
+
+/* Word reads (boot time) */
+static uint32_t sim_reads;
+
+/* Program and erase failures: one operation in sim_fail_rate fails (0:
+ * never), leaving the unit partly programmed or the page partly erased */
+static uint32_t sim_fail_rate;
+static uint32_t sim_failures;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Sim_Fail(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Draw a program or erase failure
+ * Inputs        : None
+ * Outputs       : return value - true if the operation fails
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Sim_Fail(void)
+{
+    if (sim_fail_rate != 0 && rand() % sim_fail_rate == 0)
+    {
+        sim_failures++;
+        return true;
+    }
+    return false;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Sim_Power_Lost(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Count a program or erase operation
+ * Inputs        : None
+ * Outputs       : return value - true if the power is lost during it
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Sim_Power_Lost(void)
+{
+    sim_ops++;
+    return (sim_loss_at != 0 && sim_ops == sim_loss_at);
+}
+
+uint32_t Flash_KV_Port_Read(uint32_t offset)
+{
+    uint32_t word;
+
+    sim_reads++;
+    memcpy(&word, &sim_flash[offset], sizeof(word));
+    return word;
+}
+
+bool Flash_KV_Port_Write(uint32_t offset, uint32_t word0, uint32_t word1)
+{
+    uint32_t words[2] = { word0, word1 };
+    uint8_t *unit = &sim_flash[offset];
+    bool erased = true;
+    uint8_t i;
+
+    for (i = 0; i < FLASH_KV_UNIT; i++)
+    {
+        erased &= (unit[i] == 0xFF);
+    }
+
+    if (Sim_Power_Lost())
+    {
+        /* Torn write: only some of the bits are programmed */
+        for (i = 0; i < FLASH_KV_UNIT; i++)
+        {
+            unit[i] &= ((uint8_t *)words)[i] | (uint8_t)rand();
+        }
+        longjmp(sim_loss, 1);
+    }
+    if (Sim_Fail())
+    {
+        for (i = 0; i < FLASH_KV_UNIT; i++)
+        {
+            unit[i] &= ((uint8_t *)words)[i] | (uint8_t)rand();
+        }
+        return false;
+    }
+
+    for (i = 0; i < FLASH_KV_UNIT; i++)
+    {
+        unit[i] &= ((uint8_t *)words)[i];
+    }
+
+    return erased;
+}
+
+bool Flash_KV_Port_Erase(uint8_t page)
+{
+    uint8_t *data = &sim_flash[page * FLASH_KV_PAGE_SIZE];
+    uint32_t i;
+
+    sim_page_erases[page]++;
+    if (Sim_Power_Lost())
+    {
+        /* Partial erase */
+        for (i = 0; i < FLASH_KV_PAGE_SIZE; i++)
+        {
+            if (rand() & 1)
+            {
+                data[i] = 0xFF;
+            }
+        }
+        longjmp(sim_loss, 1);
+    }
+    if (Sim_Fail())
+    {
+        for (i = 0; i < FLASH_KV_PAGE_SIZE; i++)
+        {
+            if (rand() & 1)
+            {
+                data[i] = 0xFF;
+            }
+        }
+        return false;
+    }
+
+    memset(data, 0xFF, FLASH_KV_PAGE_SIZE);
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Value(uint8_t key, uint32_t n,
+ *                                       uint8_t *value)
+ * ----------------------------------------------------------------------------
+ * Description   : Generate the n-th value of a key
+ * Inputs        : - key        - Key
+ *                 - n          - Value number
+ * Outputs       : - value      - Value
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Value(uint8_t key, uint32_t n, uint8_t *value)
+{
+    uint8_t i;
+
+    for (i = 0; i < sim_length[key]; i++)
+    {
+        value[i] = (uint8_t)(n >> (8 * (i % 4))) ^ (uint8_t)(key * 0x5A + i);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Boot(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Initialize the store, with power losses during the
+ *                 recovery half of the time
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint32_t sim_boot_reads_max;
+
+static void Sim_Boot(void)
+{
+    while (true)
+    {
+        sim_loss_at = (rand() & 1) ? sim_ops + 1 + rand() % 8 : 0;
+        if (setjmp(sim_loss) == 0)
+        {
+            sim_reads = 0;
+            Flash_KV_Initialize();
+            sim_loss_at = 0;
+            if (sim_reads > sim_boot_reads_max)
+            {
+                sim_boot_reads_max = sim_reads;
+            }
+            return;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Sim_Writes(uint32_t nb, uint32_t *committed,
+ *                                        uint32_t *refused)
+ * ----------------------------------------------------------------------------
+ * Description   : Write random keys, rebooting every 100 writes; after each
+ *                 write and each reboot, every key has to read back its last
+ *                 value written successfully
+ * Inputs        : - nb         - Number of writes
+ *                 - committed  - Value number last written per key
+ * Outputs       : - committed  - Updated
+ *                 - refused    - Number of writes that reported a failure
+ *                 return value - false if a key read back a wrong value
+ * Assumptions   : No power loss
+ * ------------------------------------------------------------------------- */
+static bool Sim_Writes(uint32_t nb, uint32_t *committed, uint32_t *refused)
+{
+    uint8_t expected[FLASH_KV_VALUE_MAX];
+    uint8_t value[FLASH_KV_VALUE_MAX];
+    uint32_t n;
+    uint8_t key;
+
+    for (n = 0; n < nb; n++)
+    {
+        key = rand() % SIM_KEYS;
+        Sim_Value(key, committed[key] + 1, value);
+        if (Flash_KV_Write(key, value, sim_length[key]))
+        {
+            committed[key]++;
+        }
+        else
+        {
+            (*refused)++;
+        }
+
+        if (n % 100 == 99)
+        {
+            Flash_KV_Initialize();
+        }
+        for (key = 0; key < SIM_KEYS; key++)
+        {
+            Sim_Value(key, committed[key], expected);
+            if (committed[key] != 0 &&
+                (!Flash_KV_Read(key, value, sim_length[key]) ||
+                 memcmp(value, expected, sim_length[key]) != 0))
+            {
+                printf("FAIL: key %u does not read back value %u after "
+                       "write %u\n", key, committed[key], n);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    /* Value number last written (committed) and being written per key */
+    volatile uint32_t committed[SIM_KEYS] = { 0 };
+    volatile int32_t pending_key = -1;
+    volatile uint32_t losses = 0;
+    volatile uint32_t pending = 0;
+    volatile uint32_t nb_losses = 10000;
+    uint32_t interval;
+    uint32_t endurance;
+    uint8_t expected[FLASH_KV_VALUE_MAX];
+    uint8_t value[FLASH_KV_VALUE_MAX];
+    uint32_t writes;
+    uint32_t max_erases;
+    uint8_t key;
+    uint8_t i;
+    double years;
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <interval_min> <endurance> [<losses>]\n",
+                argv[0]);
+        return 1;
+    }
+    interval = strtoul(argv[1], NULL, 0);
+    endurance = strtoul(argv[2], NULL, 0);
+    if (argc > 3)
+    {
+        nb_losses = strtoul(argv[3], NULL, 0);
+    }
+    if (interval == 0)
+    {
+        fprintf(stderr, "interval_min has to be at least 1\n");
+        return 1;
+    }
+    srand(1);
+
+    /* Power-loss recovery */
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    Sim_Boot();
+    while (losses < nb_losses)
+    {
+        if (setjmp(sim_loss) == 0)
+        {
+            sim_loss_at = sim_ops + 1 + rand() % 64;
+            while (true)
+            {
+                key = rand() % SIM_KEYS;
+                pending = committed[key] + 1;
+                pending_key = key;
+                Sim_Value(key, pending, value);
+                if (!Flash_KV_Write(key, value, sim_length[key]))
+                {
+                    printf("FAIL: write of key %u refused\n", key);
+                    return 1;
+                }
+                committed[key] = pending;
+                pending_key = -1;
+            }
+        }
+
+        losses++;
+        Sim_Boot();
+        for (key = 0; key < SIM_KEYS; key++)
+        {
+            if (committed[key] == 0 && key != pending_key)
+            {
+                continue;
+            }
+            if (!Flash_KV_Read(key, value, sim_length[key]))
+            {
+                printf("FAIL: key %u lost after power loss %u\n", key,
+                       losses);
+                return 1;
+            }
+            Sim_Value(key, committed[key], expected);
+            if (memcmp(value, expected, sim_length[key]) == 0)
+            {
+                continue;
+            }
+            Sim_Value(key, pending, expected);
+            if (key == pending_key &&
+                memcmp(value, expected, sim_length[key]) == 0)
+            {
+                committed[key] = pending;
+                continue;
+            }
+            printf("FAIL: key %u corrupted after power loss %u\n", key,
+                   losses);
+            return 1;
+        }
+        pending_key = -1;
+    }
+    printf("power losses: %u, all values recovered, boot reads max %u "
+           "(%u words in the store)\n", losses, sim_boot_reads_max,
+           SIM_SIZE / 4);
+
+    /* Wrap-around of the page sequence numbers: active page created with
+     * the sequence number before the last one */
+    {
+        uint32_t header = (uint32_t)FLASH_KV_MAGIC << 24 |
+                          (FLASH_KV_SEQ_MASK - 1);
+        uint32_t done[SIM_KEYS] = { 0 };
+        uint32_t refused = 0;
+
+        memset(sim_flash, 0xFF, sizeof(sim_flash));
+        Flash_KV_Port_Write(0, header, ~header);
+        Flash_KV_Initialize();
+        if (!Sim_Writes(2000, done, &refused) || refused != 0 ||
+            flash_kv.seq > FLASH_KV_PAGES * 4)
+        {
+            printf("FAIL: sequence number wrap-around (sequence %u, %u "
+                   "writes refused)\n", flash_kv.seq, refused);
+            return 1;
+        }
+        printf("sequence wrap-around: store reopened at sequence %u\n",
+               flash_kv.seq);
+    }
+
+    /* Program and erase failures */
+    {
+        uint32_t done[SIM_KEYS] = { 0 };
+        uint32_t refused = 0;
+
+        memset(sim_flash, 0xFF, sizeof(sim_flash));
+        Flash_KV_Initialize();
+        sim_fail_rate = 50;
+        if (!Sim_Writes(20000, done, &refused))
+        {
+            return 1;
+        }
+        sim_fail_rate = 0;
+        if (refused > 20000 / 2)
+        {
+            printf("FAIL: %u of 20000 writes refused after %u flash "
+                   "failures\n", refused, sim_failures);
+            return 1;
+        }
+        printf("flash failures: %u, writes refused: %u of 20000, values "
+               "kept\n", sim_failures, refused);
+    }
+
+    /* Write amplification and wear, one write of each key per interval */
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    memset(sim_page_erases, 0, sizeof(sim_page_erases));
+    Flash_KV_Initialize();
+    memset(&flash_kv.value_bytes, 0, 3 * sizeof(uint32_t));
+    memset(sim_page_erases, 0, sizeof(sim_page_erases));
+    writes = 200000;
+    for (committed[0] = 1; committed[0] <= writes; committed[0]++)
+    {
+        for (key = 0; key < SIM_KEYS; key++)
+        {
+            Sim_Value(key, committed[0], value);
+            Flash_KV_Write(key, value, sim_length[key]);
+        }
+    }
+
+    max_erases = 0;
+    for (i = 0; i < FLASH_KV_PAGES; i++)
+    {
+        printf("page %u: %u erases\n", i, sim_page_erases[i]);
+        if (sim_page_erases[i] > max_erases)
+        {
+            max_erases = sim_page_erases[i];
+        }
+    }
+
+    years = (double)endurance * writes / max_erases * interval /
+            (60.0 * 24 * 365);
+    printf("persists: %u, value bytes: %u, flash bytes: %u, "
+           "write amplification: %.2f\n", writes, flash_kv.value_bytes,
+           flash_kv.units * FLASH_KV_UNIT,
+           (double)flash_kv.units * FLASH_KV_UNIT / flash_kv.value_bytes);
+    printf("persists per page erase: %.1f, lifetime at %u min: %.0f years\n",
+           (double)writes / max_erases, interval, years);
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+/* ----------------------------------------------------------------------------
+ * history_test.c
+ * - Host test of the temperature history ring (code/history.c). Series of
+ *   samples are appended well beyond the ring capacity, with random
+ *   temperature steps over the whole 8.8 range, sampling interval changes
+ *   and a wrap-around of the time counter. After each append, the history
+ *   is read back from the oldest retained sample and from random sequence
+ *   numbers; every sample has to be decoded exactly (temperature at the
+ *   1/16 degree resolution). Then the storage cost of a steady 1-per-minute
+ *   series is reported in bytes per sample, with and without the block
+ *   headers, with the retention of the ring.
+ *
+ *   Build and run on the host (the light stack has no history, see
+ *   HISTORY_ENABLE):
+ *     cc -Wall -o history_test tools/history_test.c code/history.c
+ *     ./history_test
+ * ------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/history.h"
+
+/* Number of samples appended per series */
+#define TEST_SAMPLES                    30000
+
+/* Reference samples, indexed by sequence number */
+static struct history_sample ref[TEST_SAMPLES];
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint32_t Test_Oldest(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Sequence number of the oldest retained sample
+ * Inputs        : None
+ * Outputs       : return value - Sequence number
+ * Assumptions   : history.nb > 0
+ * ------------------------------------------------------------------------- */
+static uint32_t Test_Oldest(void)
+{
+    return history.blocks[(history.head + HISTORY_BLOCKS - (history.nb - 1)) %
+                          HISTORY_BLOCKS].seq;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Test_Read(uint32_t from, uint32_t n)
+ * ----------------------------------------------------------------------------
+ * Description   : Read the history back from a sequence number and compare
+ *                 it to the reference samples
+ * Inputs        : - from       - Sequence number of the first sample to read
+ *                 - n          - Number of samples appended
+ * Outputs       : return value - false on the first mismatch
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Test_Read(uint32_t from, uint32_t n)
+{
+    struct history_iter it;
+    struct history_sample sample;
+    uint32_t seq = (from < Test_Oldest()) ? Test_Oldest() : from;
+    int16_t expected;
+
+    if (!History_Iterate_Start(&it, from))
+    {
+        printf("FAIL: no sample from %u (%u appended)\n", from, n);
+        return false;
+    }
+    while (History_Iterate_Next(&it, &sample))
+    {
+        expected = (int16_t)(ref[seq].temperature & ~0xF);
+        if (seq >= n || sample.seq != seq || sample.time != ref[seq].time ||
+            sample.temperature != expected)
+        {
+            printf("FAIL: sample %u read from %u: seq %u time %u "
+                   "temperature %d, expected time %u temperature %d\n",
+                   seq, from, sample.seq, sample.time, sample.temperature,
+                   ref[seq].time, expected);
+            return false;
+        }
+        seq++;
+    }
+    if (seq != n)
+    {
+        printf("FAIL: read from %u ends at %u, %u appended\n", from, seq, n);
+        return false;
+    }
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Test_Exact(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Decoding exactness over the ring and time wrap-around
+ * Inputs        : None
+ * Outputs       : return value - false on failure
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Test_Exact(void)
+{
+    uint32_t time = 0xFFFFFFFF - 600 * 200;
+    uint32_t interval = 600;
+    int32_t temp = 25 * 256;
+    uint32_t blocks = 0;
+    uint32_t n;
+    uint32_t from;
+
+    History_Clear();
+    for (n = 0; n < TEST_SAMPLES; n++)
+    {
+        /* Interval changes (1 s to 1 day), small drift and full range
+         * steps */
+        if (rand() % 50 == 0)
+        {
+            interval = 10 + rand() % 864000;
+        }
+        if (rand() % 100 == 0)
+        {
+            temp = (rand() % 65536) - 32768;
+        }
+        else
+        {
+            temp += (rand() % 97) - 48;
+            temp = (temp > INT16_MAX) ? INT16_MAX :
+                   (temp < INT16_MIN) ? INT16_MIN : temp;
+        }
+        time += interval;
+
+        ref[n].seq = n;
+        ref[n].time = time;
+        ref[n].temperature = (int16_t)temp;
+        History_Append(time, (int16_t)temp);
+        if (history.blocks[history.head].seq == n)
+        {
+            blocks++;
+        }
+
+        if (history.next_seq != n + 1)
+        {
+            printf("FAIL: next sequence number %u after %u appends\n",
+                   history.next_seq, n + 1);
+            return false;
+        }
+
+        /* Full read back (from 0, dropped samples included) and from a
+         * random retained sample */
+        from = Test_Oldest() + rand() % (n + 1 - Test_Oldest());
+        if ((n % 16 == 0 && !Test_Read(0, n + 1)) || !Test_Read(from, n + 1))
+        {
+            return false;
+        }
+    }
+
+    printf("exact: %u samples in %u blocks (ring wrapped %u times, time "
+           "wrapped), %u retained\n", n, blocks, blocks / HISTORY_BLOCKS,
+           n - Test_Oldest());
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Test_Density(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Storage cost of a steady 1-per-minute series drifting by
+ *                 up to 1/16 degree per sample
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Test_Density(void)
+{
+    uint32_t time = 0;
+    int32_t temp = 21 * 256;
+    uint32_t samples = 0;
+    uint32_t used = 0;
+    uint32_t n;
+    uint8_t i;
+
+    History_Clear();
+    for (n = 0; n < TEST_SAMPLES; n++)
+    {
+        time += 600;
+        temp += ((rand() % 3) - 1) * 16;
+        History_Append(time, (int16_t)temp);
+    }
+
+    for (i = 0; i < history.nb; i++)
+    {
+        const struct history_block *blk =
+            &history.blocks[(history.head + HISTORY_BLOCKS - i) %
+                            HISTORY_BLOCKS];
+
+        samples += blk->count;
+        used += blk->used;
+    }
+
+    /* The first sample of each block is stored in its header */
+    printf("%u blocks of %u bytes: %.2f B/sample (data), %.2f B/sample "
+           "(with headers), %u samples retained (%.1f h at 1 per minute)\n",
+           HISTORY_BLOCKS, HISTORY_BLOCK_SIZE,
+           (double)used / (samples - history.nb),
+           (double)history.nb * HISTORY_BLOCK_SIZE / samples, samples,
+           samples / 60.0);
+}
+
+int main(void)
+{
+    srand(1);
+    if (!Test_Exact())
+    {
+        return 1;
+    }
+    Test_Density();
+
+    return 0;
+}
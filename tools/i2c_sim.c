@@ -0,0 +1,445 @@
+/* ----------------------------------------------------------------------------
+ * i2c_sim.c
+ * - Host test of the I2C library (code/i2c.c) against a simulated I2C
+ *   interface and NCT375-like slave. The interrupts of the interface are
+ *   raised one at a time and I2C_IRQHandler is called for each of them; the
+ *   SysTick deadline fires when the bus stalls. The tests queue batches of
+ *   transactions and check their completion order, status and data, the
+ *   queue full status, the retries and error statuses of address and data
+ *   NACKs, bus errors and timeouts, and transactions queued from a
+ *   completion callback. With the default options, the transactions use
+ *   the DMA engine: the simulated DMA channel moves the bytes, raises the
+ *   enabled DMA interrupt before the last byte and the interface only
+ *   raises the stop (or NACK) interrupts. Built with -DI2C_DMA_ENABLE=0,
+ *   all the transactions use the CM3 engine; with -DI2C_DMA_MIN_LENGTH=2,
+ *   the engine changes between the 1-byte and the longer transactions.
+ * - Benchmark of the NCT375 transactions of 1, 2 and 3 bytes: interrupts of
+ *   the interface and of the DMA channel (checked against the expected
+ *   count of the engine) and host time spent starting the transaction and
+ *   in the interrupt handlers, fastest of BENCH_RUNS runs. The host time
+ *   only compares the work of the library; on the device, each interrupt
+ *   also costs its entry and exit and a wake-up from WFI.
+ *
+ *   Build and run on the host (tools/shim/rsl10.h stands in for the SDK,
+ *   tools/sim_i2c.c models the interface and the slave):
+ *     cc -Wall -Wno-pointer-to-int-cast -Itools/shim -Iinclude -o i2c_sim \
+ *        tools/i2c_sim.c tools/sim_i2c.c code/i2c.c
+ *     ./i2c_sim
+ *     cc -Wall -DI2C_DMA_ENABLE=0 -Itools/shim -Iinclude -o i2c_sim_cm3 \
+ *        tools/i2c_sim.c tools/sim_i2c.c code/i2c.c
+ *     ./i2c_sim_cm3
+ *     cc -Wall -Wno-pointer-to-int-cast -DI2C_DMA_MIN_LENGTH=2 \
+ *        -Itools/shim -Iinclude -o i2c_sim_mixed tools/i2c_sim.c \
+ *        tools/sim_i2c.c code/i2c.c
+ *     ./i2c_sim_mixed
+ * ------------------------------------------------------------------------- */
+
+#include <string.h>
+#include "sim_i2c.h"
+
+/* Registers of the shim */
+uint32_t SystemCoreClock = 8000000;
+struct sim_systick_tag sim_systick;
+struct sim_dio_tag sim_dio;
+struct sim_dio_data_tag sim_dio_data;
+struct sim_nvic_tag sim_nvic;
+
+#define SIM_DONE_MAX                    16
+
+/* Completed transactions, in completion order */
+struct sim_done_tag
+{
+    uint8_t *tx_buffer;
+    uint8_t *rx_buffer;
+    uint8_t status;
+};
+
+static struct sim_done_tag sim_done[SIM_DONE_MAX];
+static uint8_t sim_done_count;
+static uint32_t sim_timeouts;
+static uint32_t sim_xfers;
+
+/* ----------------------------------------------------------------------------
+ * Function      : void Sys_Delay_ProgramROM(uint32_t cycles)
+ * ----------------------------------------------------------------------------
+ * Description   : Busy wait of the bus recovery; no time is simulated
+ * Inputs        : - cycles     - Number of cycles
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+void Sys_Delay_ProgramROM(uint32_t cycles)
+{
+    (void)cycles;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Run(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Handle the interrupts of the interface, the DMA transfers
+ *                 and the deadline while the bus is stalled, until the
+ *                 library is idle
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Run(void)
+{
+    uint32_t steps;
+
+    for (steps = 0; steps < 10000; steps++)
+    {
+        if (Sim_I2C_Step())
+        {
+            continue;
+        }
+        else if (i2c_env.busy && (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+        {
+            sim_timeouts++;
+            I2C_Timeout_IRQHandler();
+        }
+        else
+        {
+            SIM_CHECK(!i2c_env.busy, "busy without pending interrupt or "
+                      "deadline");
+            return;
+        }
+    }
+    SIM_CHECK(false, "no completion");
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Callback(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Completion callback recording the transaction and status
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Callback(void)
+{
+    SIM_CHECK(sim_done_count < SIM_DONE_MAX, "too many completions");
+    sim_done[sim_done_count].tx_buffer = i2c_env.xfer.tx_buffer;
+    sim_done[sim_done_count].rx_buffer = i2c_env.xfer.rx_buffer;
+    sim_done[sim_done_count].status = i2c_env.xfer_status;
+    sim_done_count++;
+    sim_xfers++;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Start(const char *test)
+ * ----------------------------------------------------------------------------
+ * Description   : Initialize the library and the slave for a test
+ * Inputs        : - test       - Test name
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Start(const char *test)
+{
+    sim_test = test;
+    memset(&sim_slave, 0, sizeof(sim_slave));
+    memset(sim_done, 0, sizeof(sim_done));
+    sim_done_count = 0;
+    sim_timeouts = 0;
+    sim_recoveries = 0;
+    Sys_I2C_Reset();
+    I2C_Master_Init(0x80);
+    memset(&i2c_recovery, 0, sizeof(i2c_recovery));
+
+    /* Temperature 25.25 C, configuration, THYST 75 C, TOS 80 C */
+    sim_slave.reg[0][0] = 0x19;
+    sim_slave.reg[0][1] = 0x40;
+    sim_slave.reg[1][0] = 0x20;
+    sim_slave.reg[2][0] = 0x4B;
+    sim_slave.reg[3][0] = 0x50;
+}
+
+/* Sensor read sequence and configuration writes queued as one batch */
+static void Test_Batch(void)
+{
+    uint8_t temp_ptr[1] = { 0x00 };
+    uint8_t trigger[2] = { 0x04, 0x01 };
+    uint8_t conf_ptr[1] = { 0x01 };
+    uint8_t tos[3] = { 0x03, 0x55, 0x80 };
+    uint8_t thyst_ptr[1] = { 0x02 };
+    uint8_t temp[2];
+    uint8_t conf[1];
+    uint8_t thyst[2];
+
+    Sim_Start("batch");
+    SIM_CHECK(I2C_WriteRead(SIM_ADDRESS, temp_ptr, 1, temp, 2,
+                            Sim_Callback) == I2C_XFER_OK, "queue temperature");
+    SIM_CHECK(I2C_Write(SIM_ADDRESS, trigger, 2, Sim_Callback) ==
+              I2C_XFER_OK, "queue trigger");
+    SIM_CHECK(I2C_WriteRead(SIM_ADDRESS, conf_ptr, 1, conf, 1,
+                            Sim_Callback) == I2C_XFER_OK, "queue config");
+    SIM_CHECK(I2C_Write(SIM_ADDRESS, tos, 3, Sim_Callback) == I2C_XFER_OK,
+              "queue TOS");
+    SIM_CHECK(I2C_WriteRead(SIM_ADDRESS, thyst_ptr, 1, thyst, 2,
+                            Sim_Callback) == I2C_XFER_OK, "queue THYST");
+
+    /* One transaction in progress and I2C_QUEUE_SIZE waiting */
+    SIM_CHECK(I2C_Write(SIM_ADDRESS, trigger, 2, Sim_Callback) ==
+              I2C_XFER_QUEUE_FULL, "queue full");
+
+    Sim_Run();
+    SIM_CHECK(sim_done_count == 5, "all transactions completed");
+    SIM_CHECK(sim_done[0].rx_buffer == temp && sim_done[1].tx_buffer ==
+              trigger && sim_done[2].rx_buffer == conf &&
+              sim_done[3].tx_buffer == tos && sim_done[4].rx_buffer == thyst,
+              "completion order");
+    SIM_CHECK(sim_done[0].status == I2C_XFER_OK &&
+              sim_done[1].status == I2C_XFER_OK &&
+              sim_done[2].status == I2C_XFER_OK &&
+              sim_done[3].status == I2C_XFER_OK &&
+              sim_done[4].status == I2C_XFER_OK, "completion status");
+    SIM_CHECK(temp[0] == 0x19 && temp[1] == 0x40, "temperature read");
+    SIM_CHECK(conf[0] == 0x20, "configuration read");
+    SIM_CHECK(thyst[0] == 0x4B && thyst[1] == 0x00, "THYST read");
+    SIM_CHECK(sim_slave.reg[4][0] == 0x01, "one-shot register written");
+    SIM_CHECK(sim_slave.reg[3][0] == 0x55 && sim_slave.reg[3][1] == 0x80,
+              "TOS written");
+    SIM_CHECK(i2c_env.queue_count == 0 && i2c_env.error_count == 0,
+              "queue empty, no error");
+}
+
+/* Slave not answering: retried, completed with I2C_XFER_NACK, then the next
+ * queued transaction runs */
+static void Test_Nack_Address(void)
+{
+    uint8_t trigger[2] = { 0x04, 0x01 };
+    uint8_t temp_ptr[1] = { 0x00 };
+    uint8_t temp[2];
+
+    Sim_Start("address NACK");
+    I2C_Write(SIM_ADDRESS + 1, trigger, 2, Sim_Callback);
+    I2C_WriteRead(SIM_ADDRESS, temp_ptr, 1, temp, 2, Sim_Callback);
+    Sim_Run();
+    SIM_CHECK(sim_done_count == 2, "both transactions completed");
+    SIM_CHECK(sim_done[0].status == I2C_XFER_NACK, "NACK status");
+    SIM_CHECK(i2c_env.error_count == 1 + I2C_RETRY_MAX, "retries");
+    SIM_CHECK(sim_done[1].status == I2C_XFER_OK && temp[0] == 0x19 &&
+              temp[1] == 0x40, "next transaction");
+}
+
+/* Data byte not acknowledged once: the retry succeeds */
+static void Test_Nack_Data(void)
+{
+    uint8_t tos[3] = { 0x03, 0x60, 0x00 };
+
+    Sim_Start("data NACK");
+    sim_slave.nack_data = 1;
+    I2C_Write(SIM_ADDRESS, tos, 3, Sim_Callback);
+    Sim_Run();
+    SIM_CHECK(sim_done_count == 1 && sim_done[0].status == I2C_XFER_OK,
+              "completed after a retry");
+    SIM_CHECK(i2c_env.error_count == 1, "one failed attempt");
+    SIM_CHECK(sim_slave.reg[3][0] == 0x60, "TOS written");
+}
+
+/* Persistent bus error: bus recovered before each retry, completed with
+ * I2C_XFER_BUS_ERROR */
+static void Test_Bus_Error(void)
+{
+    uint8_t conf_ptr[1] = { 0x01 };
+    uint8_t conf[1];
+
+    Sim_Start("bus error");
+    I2C_Recovery_Config(11, 12, 0);
+    sim_dio_data.ALIAS[12] = 1;
+    sim_slave.bus_error = 0xFF;
+    I2C_WriteRead(SIM_ADDRESS, conf_ptr, 1, conf, 1, Sim_Callback);
+    Sim_Run();
+    SIM_CHECK(sim_done_count == 1 &&
+              sim_done[0].status == I2C_XFER_BUS_ERROR, "bus error status");
+    SIM_CHECK(sim_recoveries == 1 + I2C_RETRY_MAX, "bus recovered");
+
+    sim_slave.bus_error = 0;
+    I2C_WriteRead(SIM_ADDRESS, conf_ptr, 1, conf, 1, Sim_Callback);
+    Sim_Run();
+    SIM_CHECK(sim_done_count == 2 && sim_done[1].status == I2C_XFER_OK &&
+              conf[0] == 0x20, "transaction after the bus error");
+}
+
+/* Stalled bus: the deadline aborts the transaction, retried once with
+ * success, then always stalled: both queued transactions complete with
+ * I2C_XFER_TIMEOUT */
+static void Test_Timeout(void)
+{
+    uint8_t temp_ptr[1] = { 0x00 };
+    uint8_t temp[2];
+    uint8_t trigger[2] = { 0x04, 0x01 };
+
+    Sim_Start("timeout");
+    sim_slave.stall = 1;
+    I2C_WriteRead(SIM_ADDRESS, temp_ptr, 1, temp, 2, Sim_Callback);
+    Sim_Run();
+    SIM_CHECK(sim_done_count == 1 && sim_done[0].status == I2C_XFER_OK &&
+              sim_timeouts == 1, "completed after a timeout");
+
+    sim_slave.stall = 0xFF;
+    I2C_WriteRead(SIM_ADDRESS, temp_ptr, 1, temp, 2, Sim_Callback);
+    I2C_Write(SIM_ADDRESS, trigger, 2, Sim_Callback);
+    Sim_Run();
+    SIM_CHECK(sim_done_count == 3 && sim_done[1].status == I2C_XFER_TIMEOUT &&
+              sim_done[2].status == I2C_XFER_TIMEOUT, "timeout status");
+    SIM_CHECK(sim_timeouts == 1 + 2 * (1 + I2C_RETRY_MAX),
+              "deadline per attempt");
+
+    sim_slave.stall = 0;
+    I2C_Write(SIM_ADDRESS, trigger, 2, Sim_Callback);
+    Sim_Run();
+    SIM_CHECK(sim_done_count == 4 && sim_done[3].status == I2C_XFER_OK,
+              "transaction after the timeout");
+}
+
+/* Read-only transaction queued from a completion callback */
+static uint8_t chain_rx[2];
+
+static void Sim_Callback_Chain(void)
+{
+    Sim_Callback();
+    SIM_CHECK(I2C_Read(SIM_ADDRESS, chain_rx, 2, Sim_Callback) ==
+              I2C_XFER_OK, "queue from the callback");
+}
+
+static void Test_Chain(void)
+{
+    uint8_t tos_ptr[1] = { 0x03 };
+
+    Sim_Start("chain");
+    I2C_Write(SIM_ADDRESS, tos_ptr, 1, Sim_Callback_Chain);
+    Sim_Run();
+    SIM_CHECK(sim_done_count == 2 && sim_done[1].rx_buffer == chain_rx &&
+              sim_done[1].status == I2C_XFER_OK, "chained transaction");
+    SIM_CHECK(chain_rx[0] == 0x50 && chain_rx[1] == 0x00, "chained read");
+}
+
+/* Benchmark runs per transaction; the fastest run is kept */
+#define BENCH_RUNS                      1000
+
+/* NCT375 transactions of 1, 2 and 3 bytes: register pointer write, one-shot
+ * trigger, temperature read (pointer write and 2-byte read) */
+static void Bench(void)
+{
+    static uint8_t temp_ptr[1] = { 0x00 };
+    static uint8_t trigger[2] = { 0x04, 0x01 };
+    static uint8_t temp[2];
+    static const char *const names[3] =
+    {
+        "pointer write", "trigger write", "temperature read"
+    };
+
+    /* Interrupts of the interface and of the DMA channel per engine. CM3:
+     * address, each byte and the stop condition (also after the last byte
+     * read). DMA: the stop interrupt of each sequence, and the DMA
+     * interrupt that marks the last byte of a sequence of 2 bytes or
+     * more. */
+    static const uint8_t expected[I2C_ENGINE_NB][3][2] =
+    {
+        { { 2, 0 }, { 3, 0 }, { 6, 0 } },
+        { { 1, 0 }, { 1, 1 }, { 2, 1 } }
+    };
+    uint8_t engine;
+    uint64_t ticks;
+    uint64_t best;
+    uint64_t start;
+    uint32_t irqs = 0;
+    uint32_t dma_irqs = 0;
+    uint32_t run;
+    uint8_t length;
+
+    Sim_Start("benchmark");
+
+    /* Cost of reading the time base, subtracted from each measurement */
+    sim_ticks_overhead = UINT64_MAX;
+    for (run = 0; run < BENCH_RUNS; run++)
+    {
+        start = SIM_TICKS();
+        ticks = SIM_TICKS() - start;
+        if (ticks < sim_ticks_overhead)
+        {
+            sim_ticks_overhead = ticks;
+        }
+    }
+
+    printf("%-5s %-17s %-6s %6s %6s %14s\n", "bytes", "transaction",
+           "engine", "I2C", "DMA", SIM_TICKS_UNIT);
+    for (length = 1; length <= 3; length++)
+    {
+        best = UINT64_MAX;
+        for (run = 0; run < BENCH_RUNS; run++)
+        {
+            sim_irqs = 0;
+            sim_dma_irqs = 0;
+            sim_isr_ticks = 0;
+
+            /* Start of the transaction, then the interrupt handlers */
+            start = SIM_TICKS();
+            if (length == 1)
+            {
+                I2C_Write(SIM_ADDRESS, temp_ptr, 1, NULL);
+            }
+            else if (length == 2)
+            {
+                I2C_Write(SIM_ADDRESS, trigger, 2, NULL);
+            }
+            else
+            {
+                I2C_WriteRead(SIM_ADDRESS, temp_ptr, 1, temp, 2, NULL);
+            }
+            ticks = SIM_TICKS() - start - sim_ticks_overhead;
+            Sim_Run();
+            ticks += sim_isr_ticks;
+
+            SIM_CHECK(run == 0 || (sim_irqs == irqs &&
+                                   sim_dma_irqs == dma_irqs),
+                      "same interrupts in every run");
+            irqs = sim_irqs;
+            dma_irqs = sim_dma_irqs;
+            if (ticks < best)
+            {
+                best = ticks;
+            }
+        }
+        SIM_CHECK(i2c_env.error_count == 0 &&
+                  (length < 3 || (temp[0] == 0x19 && temp[1] == 0x40)),
+                  "benchmark transactions completed");
+        engine = (I2C_DMA_ENABLE && length >= I2C_DMA_MIN_LENGTH) ?
+                 I2C_ENGINE_DMA : I2C_ENGINE_CM3;
+        SIM_CHECK(irqs == expected[engine][length - 1][0] &&
+                  dma_irqs == expected[engine][length - 1][1],
+                  "interrupts per transaction");
+        printf("%-5u %-17s %-6s %6u %6u %14llu\n", length, names[length - 1],
+               (engine == I2C_ENGINE_DMA) ? "DMA" : "CM3", irqs, dma_irqs,
+               (unsigned long long)best);
+    }
+}
+
+int main(void)
+{
+    Test_Batch();
+    Test_Nack_Address();
+    Test_Nack_Data();
+    Test_Bus_Error();
+    Test_Timeout();
+    Test_Chain();
+
+    /* The tests use transactions of 1 to 3 bytes */
+    sim_test = "engine";
+    SIM_CHECK((sim_dma_xfers > 0) == (I2C_DMA_ENABLE && I2C_DMA_MIN_LENGTH <=
+              3), "DMA engine used");
+
+    if (I2C_DMA_ENABLE)
+    {
+        printf("i2c_sim (DMA engine from %u bytes): ", I2C_DMA_MIN_LENGTH);
+    }
+    else
+    {
+        printf("i2c_sim (CM3 engine): ");
+    }
+    printf("%u transactions, %u checks passed\n", sim_xfers, sim_checks);
+
+    Bench();
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------------
+ * job_schedule_sim.c
+ * - Host simulation of the wake-coalescing job scheduler. Runs a job table
+ *   through one hour of wake-ups and reports the number of wake-ups, the
+ *   number of wake windows with periodic work and the awake time, with and
+ *   without coalescing (slack) and latency overlap.
+ *
+ *   Build and run on the host:
+ *     cc -Wall -o job_schedule_sim tools/job_schedule_sim.c \
+ *        code/job_schedule.c
+ *     ./job_schedule_sim <interval_ms> <base_us> <job> [<job> ...]
+ *
+ *   interval_ms - Wake-up (advertising) interval in ms
+ *   base_us     - Awake time of a wake-up without jobs in us
+ *   job         - period:slack:offset:cost_us[:a], with the 'a' suffix for
+ *                 asynchronous jobs
+ *
+ *   Example, the default application job table at a 2 s interval:
+ *     ./job_schedule_sim 2000 1500 1:0:0:4000:a 10:3:9:6400:a 20:5:19:20 \
+ *        1:0:0:300
+ * ------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/job_schedule.h"
+
+/* Completion flag used to mark the asynchronous jobs */
+static volatile bool sim_pending;
+
+struct sim_result
+{
+    uint32_t wakes;
+    uint32_t windows;
+    uint64_t awake_us;
+};
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Run(const struct job_desc *jobs, uint8_t nb,
+ *                                     uint32_t wakes, uint32_t base_us,
+ *                                     bool overlap, struct sim_result *res)
+ * ----------------------------------------------------------------------------
+ * Description   : Run a job table through a number of wake-ups
+ * Inputs        : - jobs       - Job table
+ *                 - nb         - Number of jobs
+ *                 - wakes      - Number of wake-ups
+ *                 - base_us    - Awake time of a wake-up without jobs
+ *                 - overlap    - Overlap the asynchronous job latencies
+ * Outputs       : - res        - Simulation result
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Run(const struct job_desc *jobs, uint8_t nb, uint32_t wakes,
+                    uint32_t base_us, bool overlap, struct sim_result *res)
+{
+    struct job_schedule_tag sched;
+    uint32_t cost;
+    uint8_t due;
+    uint32_t w;
+    uint8_t i;
+
+    memset(res, 0, sizeof(*res));
+    Job_Schedule_Initialize(&sched, jobs, nb);
+
+    for (w = 0; w < wakes; w++)
+    {
+        due = Job_Schedule_Select(&sched);
+
+        if (overlap)
+        {
+            cost = Job_Schedule_Cost(&sched, due);
+        }
+        else
+        {
+            cost = 0;
+            for (i = 0; i < nb; i++)
+            {
+                if (due & (1U << i))
+                {
+                    cost += jobs[i].cost_us;
+                }
+            }
+        }
+
+        for (i = 0; i < nb; i++)
+        {
+            if ((due & (1U << i)) && jobs[i].period > 1)
+            {
+                res->windows++;
+                break;
+            }
+        }
+
+        res->wakes++;
+        res->awake_us += base_us + cost;
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Print(const char *name,
+ *                                       const struct sim_result *res)
+ * ----------------------------------------------------------------------------
+ * Description   : Print a simulation result
+ * Inputs        : - name       - Name of the configuration
+ *                 - res        - Simulation result
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Print(const char *name, const struct sim_result *res)
+{
+    printf("%-26s %8lu %8lu %12.1f\n", name, (unsigned long)res->wakes,
+           (unsigned long)res->windows, res->awake_us / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+    struct job_desc jobs[JOB_SCHEDULE_MAX];
+    struct job_desc no_slack[JOB_SCHEDULE_MAX];
+    struct sim_result res;
+    unsigned int period, slack, offset, cost;
+    char async;
+    uint32_t interval_ms;
+    uint32_t base_us;
+    uint32_t wakes;
+    uint8_t nb = 0;
+    int i;
+
+    if (argc < 4 || argc - 3 > JOB_SCHEDULE_MAX)
+    {
+        fprintf(stderr, "usage: %s <interval_ms> <base_us> "
+                "period:slack:offset:cost_us[:a] ... (at most %d jobs)\n",
+                argv[0], JOB_SCHEDULE_MAX);
+        return 1;
+    }
+
+    interval_ms = strtoul(argv[1], NULL, 0);
+    base_us = strtoul(argv[2], NULL, 0);
+    if (interval_ms == 0)
+    {
+        fprintf(stderr, "invalid interval\n");
+        return 1;
+    }
+
+    for (i = 3; i < argc; i++)
+    {
+        async = 0;
+        if (sscanf(argv[i], "%u:%u:%u:%u:%c", &period, &slack, &offset,
+                   &cost, &async) < 4 || period == 0 || slack >= period ||
+            period > UINT16_MAX || offset > UINT16_MAX || cost > UINT16_MAX)
+        {
+            fprintf(stderr, "invalid job: %s\n", argv[i]);
+            return 1;
+        }
+
+        memset(&jobs[nb], 0, sizeof(jobs[nb]));
+        jobs[nb].pending = (async == 'a') ? &sim_pending : NULL;
+        jobs[nb].period = period;
+        jobs[nb].slack = slack;
+        jobs[nb].offset = offset;
+        jobs[nb].cost_us = cost;
+        no_slack[nb] = jobs[nb];
+        no_slack[nb].slack = 0;
+        nb++;
+    }
+
+    wakes = 3600000UL / interval_ms;
+
+    printf("Per hour, %lu ms wake-up interval:\n", (unsigned long)interval_ms);
+    printf("%-26s %8s %8s %12s\n", "", "wakes", "windows", "awake [ms]");
+
+    Sim_Run(jobs, nb, wakes, base_us, true, &res);
+    Sim_Print("coalesced, overlapped", &res);
+    Sim_Run(no_slack, nb, wakes, base_us, true, &res);
+    Sim_Print("no slack, overlapped", &res);
+    Sim_Run(no_slack, nb, wakes, base_us, false, &res);
+    Sim_Print("no slack, sequential", &res);
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+/* ----------------------------------------------------------------------------
+ * nct375_conv_test.c
+ * - Host test of the NCT375 temperature conversion of include/nct375.h,
+ *   over all 4096 codes of the 12-bit temperature register and all values
+ *   of the unused LSB bits D3..D0 (65536 register pairs):
+ *     NCT375_TEMP_FIXED  - has to be the code (two's complement, 1/16 C)
+ *                          in signed 8.8 fixed-point, D3..D0 ignored
+ *   The reference formula is computed in floating point. The codes in the
+ *   operating range of the sensor have to differ from NCT375_TEMP_INVALID.
+ *
+ * - Benchmark of NCT375_TEMP_FIXED against the previous conversion path
+ *   (code * 10000 / 16 in NCT375_Received_Temperature, then split into
+ *   the integer part and the 1/256 fraction of the TLM frame by divisions
+ *   by 10000 in the advertising data update), register pair to 8.8
+ *   fixed-point, over the 4096 codes. Both run as out-of-line functions;
+ *   the time per conversion is measured on the host and the cycles are
+ *   derived from it at the host clock given as argument (in MHz, default
+ *   none). The results of the previous path are compared for the codes
+ *   it handled (0 to 127.9375 C).
+ *
+ *   Build and run on the host:
+ *     cc -Wall -O2 -o nct375_conv_test tools/nct375_conv_test.c -lm
+ *     ./nct375_conv_test [host_mhz]
+ * ------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "../include/nct375.h"
+
+/* Operating range of the sensor (C) */
+#define NCT375_RANGE_MIN                -55.0
+#define NCT375_RANGE_MAX                125.0
+
+/* Passes over the 4096 codes per benchmark */
+#define BENCH_PASSES                    2000
+
+/* Register pairs of the 4096 codes, D3..D0 cleared */
+static uint8_t bench_msb[4096];
+static uint8_t bench_lsb[4096];
+
+/* Sum of the benchmark results, kept so that the loops are not removed */
+volatile int32_t bench_sink;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static int16_t Conv_Fixed(uint8_t msb, uint8_t lsb)
+ * ----------------------------------------------------------------------------
+ * Description   : Current conversion, register pair to 8.8 fixed-point
+ * Inputs        : - msb, lsb   - Temperature register pair
+ * Outputs       : return value - Temperature, signed 8.8 fixed-point
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static __attribute__((noinline)) int16_t Conv_Fixed(uint8_t msb, uint8_t lsb)
+{
+    return NCT375_TEMP_FIXED(msb, lsb);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static int16_t Conv_Legacy(uint8_t msb, uint8_t lsb)
+ * ----------------------------------------------------------------------------
+ * Description   : Previous conversion, register pair to 1/10000 C, then to
+ *                 the 8.8 fixed-point of the TLM frame
+ * Inputs        : - msb, lsb   - Temperature register pair
+ * Outputs       : return value - Temperature, signed 8.8 fixed-point
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static __attribute__((noinline)) int16_t Conv_Legacy(uint8_t msb, uint8_t lsb)
+{
+    int32_t temp = msb;
+    bool sgn = temp > 127;
+    uint32_t temperature;
+    uint8_t temp1;
+    uint32_t temp2_long;
+
+    temp = (temp << 4);
+    temp += (lsb >> 4);
+    if (sgn)
+    {
+        temp -= 4096;
+    }
+    temp *= 10000;
+    temp /= 16;
+    temperature = (uint32_t)temp;
+
+    temp1 = temperature / 10000;
+    temp2_long = ((temperature % 10000) * 256) / 10000;
+
+    return (int16_t)((temp1 << 8) | (uint8_t)temp2_long);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static double Bench(int16_t (*conv)(uint8_t, uint8_t))
+ * ----------------------------------------------------------------------------
+ * Description   : Time a conversion over BENCH_PASSES passes of the codes
+ * Inputs        : - conv       - Conversion
+ * Outputs       : return value - Time per conversion in ns
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static double Bench(int16_t (*conv)(uint8_t, uint8_t))
+{
+    struct timespec start;
+    struct timespec end;
+    int32_t sum = 0;
+    uint32_t pass;
+    uint32_t code;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        for (code = 0; code < 4096; code++)
+        {
+            sum += conv(bench_msb[code], bench_lsb[code]);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    bench_sink = sum;
+
+    return ((end.tv_sec - start.tv_sec) * 1e9 +
+            (end.tv_nsec - start.tv_nsec)) / (BENCH_PASSES * 4096.0);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t code;
+    uint32_t nibble;
+    uint8_t msb;
+    uint8_t lsb;
+    int32_t sign_code;
+    double celsius;
+    double host_mhz = (argc > 1) ? atof(argv[1]) : 0;
+    double ns_fixed;
+    double ns_legacy;
+    int16_t fixed;
+    uint32_t legacy_match = 0;
+    uint32_t legacy_codes = 0;
+
+    for (code = 0; code < 4096; code++)
+    {
+        /* Reference: 12-bit two's complement code, 0.0625 C per LSB */
+        sign_code = (code & 0x800) ? (int32_t)code - 4096 : (int32_t)code;
+        celsius = sign_code * 0.0625;
+
+        for (nibble = 0; nibble < 16; nibble++)
+        {
+            msb = (uint8_t)(code >> 4);
+            lsb = (uint8_t)((code << 4) | nibble);
+
+            fixed = NCT375_TEMP_FIXED(msb, lsb);
+            if (fixed / 256.0 != celsius)
+            {
+                printf("FAIL: NCT375_TEMP_FIXED(0x%02X, 0x%02X) = %d "
+                       "(%.4f C), expected %.4f C\n", msb, lsb, fixed,
+                       fixed / 256.0, celsius);
+                return 1;
+            }
+        }
+
+        if (fixed == NCT375_TEMP_INVALID)
+        {
+            if (celsius >= NCT375_RANGE_MIN && celsius <= NCT375_RANGE_MAX)
+            {
+                printf("FAIL: code 0x%03X (%.4f C) reads as "
+                       "NCT375_TEMP_INVALID\n", code, celsius);
+                return 1;
+            }
+            printf("code 0x%03X (%.4f C, out of the sensor range) reads as "
+                   "NCT375_TEMP_INVALID\n", code, celsius);
+        }
+
+        bench_msb[code] = (uint8_t)(code >> 4);
+        bench_lsb[code] = (uint8_t)(code << 4);
+        if (celsius >= 0)
+        {
+            legacy_codes++;
+            legacy_match += (Conv_Legacy(bench_msb[code], bench_lsb[code]) ==
+                             fixed);
+        }
+    }
+
+    printf("4096 codes, 65536 register pairs: NCT375_TEMP_FIXED exact\n");
+
+    ns_fixed = Bench(Conv_Fixed);
+    ns_legacy = Bench(Conv_Legacy);
+    printf("previous path: %u of %u codes >= 0 C identical\n",
+           legacy_match, legacy_codes);
+    printf("NCT375_TEMP_FIXED: %.2f ns, previous path: %.2f ns per "
+           "conversion (x%.1f)\n", ns_fixed, ns_legacy, ns_legacy / ns_fixed);
+    if (host_mhz > 0)
+    {
+        printf("at %.0f MHz: %.1f and %.1f cycles per conversion\n", host_mhz,
+               ns_fixed * host_mhz / 1000, ns_legacy * host_mhz / 1000);
+    }
+
+    return 0;
+}
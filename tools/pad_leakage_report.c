@@ -0,0 +1,231 @@
+/* ----------------------------------------------------------------------------
+ * pad_leakage_report.c
+ * - Host leakage budget of the pad policy table (code/pad_policy_table.c,
+ *   built with the options of include/pad_policy.h and include/nct375.h).
+ *   For each pad, the sleep and wake states are listed with their current
+ *   on VDDO:
+ *     - the leakage of the pad
+ *     - the current of an enabled pull against the level held by the
+ *       external load (sensor bus clamped by an unpowered sensor or held
+ *       low)
+ *     - the LED current of an output driving the LED
+ *     - a floating input (no pull, no load) is flagged with an estimate of
+ *       its input buffer current
+ *   The sensor supply output is excluded (see tools/sensor_power_energy.c).
+ *   The sleep budget is given with the sensor bus idle, the sensor
+ *   unpowered (SENSOR_POWER_GATING) and the bus held low, the last one
+ *   also for the wake states kept during sleep (no pad policy), and the
+ *   idle budget is averaged over an advertising interval.
+ *
+ *   Build and run on the host:
+ *     cc -Wall -o pad_leakage_report tools/pad_leakage_report.c \
+ *        code/pad_policy_table.c
+ *     ./pad_leakage_report [<interval_ms> <awake_ms>]
+ *
+ *   interval_ms  - Wake-up (advertising) interval in ms (default 2000)
+ *   awake_ms     - Awake time per wake-up in ms (default 3)
+ *
+ *   The electrical values are placeholders of the right order of magnitude;
+ *   use the datasheet values of the SoC and the board.
+ * ------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/pad_policy.h"
+
+/* VDDO (V), pull resistances (kOhm) and leakage of a pad (uA) */
+#define PAD_VDDO_V                      3.0
+#define PAD_WEAK_PULL_KOHM              250.0
+#define PAD_STRONG_PULL_KOHM            10.0
+#define PAD_LEAK_UA                     0.01
+
+/* Input buffer current of a floating input (uA) */
+#define PAD_FLOATING_UA                 10.0
+
+/* LED forward voltage (V) and series resistance (kOhm) */
+#define LED_FORWARD_V                   1.9
+#define LED_SERIES_KOHM                 1.0
+
+/* Level of a sensor bus line clamped by the input diodes of the unpowered
+ * sensor (V) */
+#define SENSOR_CLAMP_V                  0.6
+
+/* Sensor bus conditions: idle (released high), sensor unpowered, held low
+ * (sensor or stuck transaction) */
+#define BUS_IDLE                        0
+#define BUS_UNPOWERED                   1
+#define BUS_LOW                         2
+
+static const char *pad_mode_name[] = { "disable", "input", "output", "owned" };
+static const char *pad_pull_name[] = { "none", "weak-up", "weak-down",
+                                       "strong-up" };
+
+/* ----------------------------------------------------------------------------
+ * Function      : static double Pad_Current(const struct pad_policy_tag *pad,
+ *                                           const struct pad_state_tag
+ *                                           *state,
+ *                                           uint8_t bus, bool *floating)
+ * ----------------------------------------------------------------------------
+ * Description   : Current on VDDO of a pad in a state
+ * Inputs        : - pad        - Pad of the table
+ *                 - state      - Sleep or wake state of the pad
+ *                 - bus        - Sensor bus condition
+ * Outputs       : return value - Current in uA
+ *                 - floating   - Set if the pad is a floating input
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static double Pad_Current(const struct pad_policy_tag *pad,
+                          const struct pad_state_tag *state, uint8_t bus,
+                          bool *floating)
+{
+    double current = PAD_LEAK_UA;
+    double pull_kohm = 0;
+    double load_v = -1;
+
+    *floating = false;
+    if (pad->load == PAD_LOAD_SENSOR_SUPPLY)
+    {
+        return 0;
+    }
+
+    if ((state->mode == PAD_MODE_OUTPUT || state->mode == PAD_MODE_OWNED) &&
+        state->level && pad->load == PAD_LOAD_LED)
+    {
+        current += 1000.0 * (PAD_VDDO_V - LED_FORWARD_V) / LED_SERIES_KOHM;
+    }
+
+    /* Level held by the external load, if any */
+    if (pad->load == PAD_LOAD_SENSOR_BUS && bus == BUS_UNPOWERED)
+    {
+        load_v = SENSOR_CLAMP_V;
+    }
+    else if (pad->load == PAD_LOAD_SENSOR_BUS && bus == BUS_LOW)
+    {
+        load_v = 0;
+    }
+
+    if (state->pull == PAD_PULL_WEAK_UP || state->pull == PAD_PULL_WEAK_DOWN)
+    {
+        pull_kohm = PAD_WEAK_PULL_KOHM;
+    }
+    else if (state->pull == PAD_PULL_STRONG_UP)
+    {
+        pull_kohm = PAD_STRONG_PULL_KOHM;
+    }
+
+    if (pull_kohm > 0 && load_v >= 0)
+    {
+        if (state->pull == PAD_PULL_WEAK_DOWN)
+        {
+            current += 1000.0 * load_v / pull_kohm;
+        }
+        else
+        {
+            current += 1000.0 * (PAD_VDDO_V - load_v) / pull_kohm;
+        }
+    }
+    else if (pull_kohm == 0 && state->mode == PAD_MODE_INPUT &&
+             pad->load == PAD_LOAD_NONE)
+    {
+        *floating = true;
+        current += PAD_FLOATING_UA;
+    }
+
+    return current;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static double Pad_Sleep_Current(
+ *                                     const struct pad_policy_tag *pad,
+ *                                     uint8_t bus, bool *floating)
+ * ----------------------------------------------------------------------------
+ * Description   : Current of a pad during sleep, as applied by
+ *                 Pad_Policy_Sleep
+ * Inputs        : - pad        - Pad of the table
+ *                 - bus        - Sensor bus condition
+ * Outputs       : return value - Current in uA
+ *                 - floating   - Set if the pad is a floating input
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static double Pad_Sleep_Current(const struct pad_policy_tag *pad,
+                                uint8_t bus, bool *floating)
+{
+    static const struct pad_state_tag unpowered =
+    {
+        PAD_MODE_DISABLE, PAD_PULL_NONE, PAD_DRIVE_2X, 0
+    };
+
+    if (pad->load == PAD_LOAD_SENSOR_BUS && bus == BUS_UNPOWERED)
+    {
+        return Pad_Current(pad, &unpowered, bus, floating);
+    }
+    return Pad_Current(pad, &pad->sleep, bus, floating);
+}
+
+int main(int argc, char *argv[])
+{
+    const struct pad_policy_tag *pad;
+    double interval = 2000;
+    double awake = 3;
+    double sleep_ua = 0;
+    double sleep_off_ua = 0;
+    double sleep_low_ua = 0;
+    double wake_ua = 0;
+    double wake_low_ua = 0;
+    double current;
+    bool floating;
+    bool floating_any = false;
+    uint8_t i;
+
+    if (argc > 2)
+    {
+        interval = atof(argv[1]);
+        awake = atof(argv[2]);
+    }
+    if (interval <= 0 || awake < 0 || awake >= interval)
+    {
+        fprintf(stderr, "usage: %s [<interval_ms> <awake_ms>], with awake_ms "
+                "below interval_ms\n", argv[0]);
+        return 1;
+    }
+
+    printf("profile: %s, %u pads\n",
+           (PAD_POLICY_PRODUCTION) ? "production" : "development",
+           pad_policy_count);
+    printf("%-13s %3s  %-8s %-10s %10s  %-8s %-10s %10s\n", "pad", "dio",
+           "sleep", "pull", "uA", "wake", "pull", "uA");
+    for (i = 0; i < pad_policy_count; i++)
+    {
+        pad = &pad_policy[i];
+
+        current = Pad_Sleep_Current(pad, BUS_IDLE, &floating);
+        sleep_ua += current;
+        floating_any |= floating;
+        printf("%-13s %3u  %-8s %-10s %9.3f%s ", pad->name, pad->dio,
+               pad_mode_name[pad->sleep.mode], pad_pull_name[pad->sleep.pull],
+               current, floating ? "!" : " ");
+        sleep_off_ua += Pad_Sleep_Current(pad, BUS_UNPOWERED, &floating);
+        sleep_low_ua += Pad_Sleep_Current(pad, BUS_LOW, &floating);
+
+        wake_low_ua += Pad_Current(pad, &pad->wake, BUS_LOW, &floating);
+        current = Pad_Current(pad, &pad->wake, BUS_IDLE, &floating);
+        wake_ua += current;
+        floating_any |= floating;
+        printf("%-8s %-10s %9.3f%s\n", pad_mode_name[pad->wake.mode],
+               pad_pull_name[pad->wake.pull], current, floating ? "!" : " ");
+    }
+
+    printf("sleep: %.3f uA (sensor unpowered: %.3f uA), awake: %.3f uA\n",
+           sleep_ua, sleep_off_ua, wake_ua);
+    printf("sleep with the sensor bus held low: %.3f uA (wake states kept: "
+           "%.3f uA)\n", sleep_low_ua, wake_low_ua);
+    printf("average over %.0f ms with %.1f ms awake: %.3f uA\n", interval,
+           awake, (sleep_ua * (interval - awake) + wake_ua * awake) /
+           interval);
+    if (floating_any)
+    {
+        printf("! floating input, add a pull or disable the pad\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,206 @@
+/* ----------------------------------------------------------------------------
+ * sensor_power_energy.c
+ * - Host estimate of the sensor supply charge per sample for the sensor
+ *   power modes of the application:
+ *     normal     - continuous conversions (NCT375_PowerUp)
+ *     one-shot   - shutdown between one-shot conversions, pipelined
+ *                  (NCT375_ONEShot_ModeOn, ONE_SHOT_PIPELINED)
+ *     power-down - continuous conversions from the wake-up before the
+ *                  sample, shutdown in between (NCT375_PowerUp /
+ *                  NCT375_PowerDown around each sample)
+ *     gated      - supply switched off between samples (sensor_power.h),
+ *                  including the charge of the sensor decoupling capacitor
+ *   The I2C transactions of each mode are counted at the SoC active current.
+ *
+ *   Build and run on the host:
+ *     cc -Wall -o sensor_power_energy tools/sensor_power_energy.c
+ *     ./sensor_power_energy <interval_ms> <sample_wakes> [<i_conv_ua>
+ *        <i_sd_ua> <t_conv_ms> <startup_ms>]
+ *
+ *   interval_ms  - Wake-up (advertising) interval in ms
+ *   sample_wakes - Sample period in wake-ups
+ *   i_conv_ua    - Sensor current while converting in uA (default 200)
+ *   i_sd_ua      - Sensor shutdown current in uA (default 3)
+ *   t_conv_ms    - Conversion time in ms (default 60)
+ *   startup_ms   - Power-on to end of first conversion in ms
+ *                  (SENSOR_POWER_STARTUP_MS, default 100)
+ *
+ *   The sensor defaults are placeholders of the right order of magnitude;
+ *   use the datasheet values of the fitted sensor.
+ * ------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* SoC active current during an I2C transaction (mA) and transaction
+ * duration (us, 2 to 3 bytes at 100 kHz) */
+#define SOC_ACTIVE_MA                   3.0
+#define I2C_XFER_US                     300.0
+
+/* Sensor decoupling capacitor (nF) and supply voltage (V) */
+#define SENSOR_DECOUPLING_NF            100.0
+#define SENSOR_SUPPLY_V                 3.0
+
+struct sensor
+{
+    /* Converting and shutdown currents (uA), conversion and start-up times
+     * (ms) */
+    double i_conv;
+    double i_sd;
+    double t_conv;
+    double startup;
+};
+
+struct mode
+{
+    const char *name;
+
+    /* Sensor charge and I2C transactions per sample */
+    double sensor_uc;
+    unsigned int xfers;
+};
+
+/* ----------------------------------------------------------------------------
+ * Function      : static unsigned int Energy_Lead(const struct sensor *sensor,
+ *                                                 double interval)
+ * ----------------------------------------------------------------------------
+ * Description   : Number of wake-ups the supply is switched on before the
+ *                 sample with power gating
+ * Inputs        : - sensor     - Sensor parameters
+ *                 - interval   - Wake-up interval in ms
+ * Outputs       : return value - Number of wake-ups
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static unsigned int Energy_Lead(const struct sensor *sensor, double interval)
+{
+    return (unsigned int)((sensor->startup + interval - 1) / interval);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Energy_Modes(const struct sensor *sensor,
+ *                                          double interval,
+ *                                          unsigned int wakes,
+ *                                          struct mode *modes)
+ * ----------------------------------------------------------------------------
+ * Description   : Estimate the charge per sample of each mode
+ * Inputs        : - sensor     - Sensor parameters
+ *                 - interval   - Wake-up interval in ms
+ *                 - wakes      - Sample period in wake-ups
+ * Outputs       : - modes      - Normal, one-shot, power-down and gated
+ * Assumptions   : interval >= sensor->t_conv
+ * ------------------------------------------------------------------------- */
+static void Energy_Modes(const struct sensor *sensor, double interval,
+                         unsigned int wakes, struct mode *modes)
+{
+    /* Times in ms, charges in uC (uA * s) */
+    double period = interval * wakes;
+    unsigned int lead = Energy_Lead(sensor, interval);
+
+    modes[0].name = "normal";
+    modes[0].sensor_uc = sensor->i_conv * period / 1000.0;
+    modes[0].xfers = 1;
+
+    /* Temperature read and trigger of the next conversion */
+    modes[1].name = "one-shot";
+    modes[1].sensor_uc = (sensor->i_conv * sensor->t_conv +
+                          sensor->i_sd * (period - sensor->t_conv)) / 1000.0;
+    modes[1].xfers = 2;
+
+    /* Power-up write one wake-up before the sample, read and power-down
+     * write; continuous conversions with a sample on each wake-up */
+    modes[2].name = "power-down";
+    if (wakes > 1)
+    {
+        modes[2].sensor_uc = (sensor->i_conv * interval +
+                              sensor->i_sd * (period - interval)) / 1000.0;
+        modes[2].xfers = 3;
+    }
+    else
+    {
+        modes[2].sensor_uc = modes[0].sensor_uc;
+        modes[2].xfers = 1;
+    }
+
+    /* Supply on from the end of the wake-up lead wake-ups before the sample
+     * to the end of the sampling wake-up, converting continuously; always
+     * on if that covers the whole period */
+    modes[3].name = "gated";
+    if (lead < wakes)
+    {
+        modes[3].sensor_uc = sensor->i_conv * interval * lead / 1000.0 +
+                             SENSOR_DECOUPLING_NF * SENSOR_SUPPLY_V / 1000.0;
+    }
+    else
+    {
+        modes[3].sensor_uc = modes[0].sensor_uc;
+    }
+    modes[3].xfers = 1;
+}
+
+int main(int argc, char *argv[])
+{
+    struct sensor sensor = { 200.0, 3.0, 60.0, 100.0 };
+    struct mode modes[4];
+    double interval;
+    double xfer_uc;
+    double total_uc;
+    double gated_uc;
+    unsigned int wakes;
+    unsigned int n;
+    unsigned int i;
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <interval_ms> <sample_wakes> [<i_conv_ua> "
+                "<i_sd_ua> <t_conv_ms> <startup_ms>]\n", argv[0]);
+        return 1;
+    }
+    interval = atof(argv[1]);
+    wakes = (unsigned int)atoi(argv[2]);
+    if (argc > 6)
+    {
+        sensor.i_conv = atof(argv[3]);
+        sensor.i_sd = atof(argv[4]);
+        sensor.t_conv = atof(argv[5]);
+        sensor.startup = atof(argv[6]);
+    }
+    if (interval <= 0 || wakes == 0 || interval < sensor.t_conv)
+    {
+        fprintf(stderr, "the interval has to be at least the conversion time "
+                "and sample_wakes at least 1\n");
+        return 1;
+    }
+
+    xfer_uc = SOC_ACTIVE_MA * 1000.0 * I2C_XFER_US / 1e6;
+    Energy_Modes(&sensor, interval, wakes, modes);
+
+    printf("interval %.0f ms, sample every %u wake-ups (%.1f s), "
+           "gating lead %u wake-up(s)\n", interval, wakes,
+           interval * wakes / 1000.0, Energy_Lead(&sensor, interval));
+    printf("%-11s %12s %12s %12s %12s\n", "mode", "sensor uC", "I2C uC",
+           "total uC", "avg uA");
+    for (i = 0; i < 4; i++)
+    {
+        total_uc = modes[i].sensor_uc + modes[i].xfers * xfer_uc;
+        printf("%-11s %12.2f %12.2f %12.2f %12.3f\n", modes[i].name,
+               modes[i].sensor_uc, modes[i].xfers * xfer_uc, total_uc,
+               total_uc * 1000.0 / (interval * wakes));
+    }
+
+    /* Shortest sample period for which gating takes less than the
+     * one-shot mode */
+    for (n = 1; n <= 100000; n++)
+    {
+        Energy_Modes(&sensor, interval, n, modes);
+        gated_uc = modes[3].sensor_uc + modes[3].xfers * xfer_uc;
+        if (gated_uc < modes[1].sensor_uc + modes[1].xfers * xfer_uc)
+        {
+            printf("gated below one-shot from %u wake-ups per sample "
+                   "(%.1f s)\n", n, interval * n / 1000.0);
+            return 0;
+        }
+    }
+    printf("gated above one-shot up to 100000 wake-ups per sample\n");
+
+    return 0;
+}
@@ -0,0 +1,772 @@
+/* ----------------------------------------------------------------------------
+ * rsl10.h (host shim)
+ * - Minimal stand-in for the RSL10 SDK header, limited to the registers and
+ *   system functions used by the firmware, so that code/i2c.c can be built
+ *   on the host by tools/i2c_sim.c and the application by tools/wake_sim.c.
+ *   The registers are plain variables, defined by the simulation that uses
+ *   them; the interrupt controller state is kept in sim_nvic. The
+ *   functions declared here without a body (Sys_I2C_*, Sys_DMA_*,
+ *   Sys_DIO_*, Sys_PowerModes_*, Sys_Delay_ProgramROM, Flash_*, Sim_WFI)
+ *   are implemented by the simulation (I2C interface and slave model,
+ *   simulated clock); the others only access the registers. The register
+ *   bit positions and field values are not the ones of the device.
+ * ------------------------------------------------------------------------- */
+
+#ifndef RSL10_H
+#define RSL10_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* ----------------------------------------------------------------------------
+ * Core and interrupts
+ * ------------------------------------------------------------------------- */
+typedef enum
+{
+    SysTick_IRQn = -1,
+    I2C_IRQn = 0,
+    DMA2_IRQn = 1,
+    ADC_BATMON_IRQn = 2,
+    AUDIOSINK_PERIOD_IRQn = 3,
+    BLE_EVENT_IRQn = 4,
+    BLE_RX_IRQn = 5,
+    BLE_CRYPT_IRQn = 6,
+    BLE_ERROR_IRQn = 7,
+    BLE_SW_IRQn = 8,
+    BLE_GROSSTGTIM_IRQn = 9,
+    BLE_FINETGTIM_IRQn = 10,
+    BLE_CSCNT_IRQn = 11,
+    BLE_SLP_IRQn = 12,
+    SIM_IRQ_NB = 13
+} IRQn_Type;
+
+extern uint32_t SystemCoreClock;
+
+/* Interrupt controller: enabled and pending interrupts (bit per IRQn) and
+ * priorities; the system exceptions (IRQn < 0) are not recorded */
+struct sim_nvic_tag
+{
+    uint32_t enabled;
+    uint32_t pending;
+    uint8_t priority[SIM_IRQ_NB];
+};
+extern struct sim_nvic_tag sim_nvic;
+
+static inline void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+    {
+        sim_nvic.enabled |= 1U << irq;
+    }
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+    {
+        sim_nvic.enabled &= ~(1U << irq);
+    }
+}
+
+static inline void NVIC_SetPendingIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+    {
+        sim_nvic.pending |= 1U << irq;
+    }
+}
+
+static inline void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+    {
+        sim_nvic.pending &= ~(1U << irq);
+    }
+}
+
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+    if (irq >= 0)
+    {
+        sim_nvic.priority[irq] = (uint8_t)priority;
+    }
+}
+
+static inline uint32_t NVIC_GetPriority(IRQn_Type irq)
+{
+    return (irq >= 0) ? sim_nvic.priority[irq] : 0;
+}
+
+static inline void Sys_NVIC_DisableAllInt(void)
+{
+    sim_nvic.enabled = 0;
+}
+
+static inline void Sys_NVIC_ClearAllPendingInt(void)
+{
+    sim_nvic.pending = 0;
+}
+
+/* The interrupt handlers are called by the simulation, never preempted */
+#define PRIMASK_ENABLE_INTERRUPTS       0
+#define PRIMASK_DISABLE_INTERRUPTS      1
+#define FAULTMASK_ENABLE_INTERRUPTS     0
+#define FAULTMASK_DISABLE_INTERRUPTS    1
+
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __set_FAULTMASK(uint32_t faultmask) { (void)faultmask; }
+static inline void __disable_irq(void) { }
+static inline void __enable_irq(void) { }
+
+/* Wait for interrupt: the simulation advances its clock to the next event
+ * and calls the interrupt handlers raised by it */
+void Sim_WFI(void);
+#define SYS_WAIT_FOR_INTERRUPT          Sim_WFI()
+
+struct sim_systick_tag
+{
+    uint32_t CTRL;
+    uint32_t LOAD;
+    uint32_t VAL;
+};
+extern struct sim_systick_tag sim_systick;
+#define SysTick                         (&sim_systick)
+#define SysTick_CTRL_ENABLE_Msk         (1U << 0)
+#define SysTick_CTRL_TICKINT_Msk        (1U << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk      (1U << 2)
+
+struct sim_core_debug_tag
+{
+    uint32_t DEMCR;
+};
+extern struct sim_core_debug_tag sim_core_debug;
+#define CoreDebug                       (&sim_core_debug)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1U << 24)
+
+struct sim_dwt_tag
+{
+    uint32_t CTRL;
+    uint32_t CYCCNT;
+};
+extern struct sim_dwt_tag sim_dwt;
+#define DWT                             (&sim_dwt)
+#define DWT_CTRL_CYCCNTENA_Msk          (1U << 0)
+
+/* Busy wait of the given number of SYSCLK cycles */
+void Sys_Delay_ProgramROM(uint32_t cycles);
+
+static inline void Sys_Watchdog_Refresh(void) { }
+
+#define ERRNO_NO_ERROR                  0
+
+/* ----------------------------------------------------------------------------
+ * Memory map and power modes
+ * ------------------------------------------------------------------------- */
+#define DRAM0_TOP                       0x20001FFF
+#define DRAM2_TOP                       0x20005FFF
+#define POWER_MODE_WAKEUP_INFO_SIZE     0x60
+
+#define PROM_POWER_ENABLE               (1U << 0)
+#define DRAM0_POWER_ENABLE              (1U << 1)
+#define DRAM1_POWER_ENABLE              (1U << 2)
+#define DRAM2_POWER_ENABLE              (1U << 3)
+#define BB_DRAM0_POWER_ENABLE           (1U << 4)
+
+#define POWER_MODE_SLEEP                1
+
+struct sleep_mode_env_tag
+{
+    uint32_t wakeup_ctrl;
+    uint32_t mem_power_cfg;
+};
+
+struct sleep_mode_init_env_tag
+{
+    uint32_t rtc_ctrl;
+    uint32_t wakeup_cfg;
+    uint32_t app_addr;
+    uint32_t wakeup_addr;
+    uint32_t mem_power_cfg_wakeup;
+    uint32_t DMA_channel_RF;
+};
+
+/* Sleep mode entry and the restore steps of the wake-up; the application
+ * wake-up address (app_addr) is not used on the host */
+void Sys_PowerModes_Sleep_Init(struct sleep_mode_init_env_tag *init_env);
+void Sys_PowerModes_Sleep_Init_2Mbps(struct sleep_mode_init_env_tag
+                                     *init_env);
+void Sys_PowerModes_Sleep(struct sleep_mode_env_tag *env);
+void Sys_PowerModes_Wakeup(void);
+void Sys_PowerModes_Wakeup_2Mbps(void);
+
+/* ----------------------------------------------------------------------------
+ * Analog control system: supplies, oscillators, RTC and wake-up
+ * ------------------------------------------------------------------------- */
+struct sim_acs_vtrim_tag
+{
+    uint8_t VTRIM_BYTE;
+};
+
+struct sim_acs_vcc_ctrl_tag
+{
+    uint8_t VTRIM_BYTE;
+    uint8_t ICH_TRIM_BYTE;
+    uint32_t BUCK_ENABLE_ALIAS;
+};
+
+struct sim_acs_vddrf_ctrl_tag
+{
+    uint8_t VTRIM_BYTE;
+    uint32_t ENABLE_ALIAS;
+    uint32_t CLAMP_ALIAS;
+    uint32_t READY_ALIAS;
+};
+
+struct sim_acs_vddpa_ctrl_tag
+{
+    uint8_t VTRIM_BYTE;
+    uint32_t ENABLE_ALIAS;
+    uint32_t VDDPA_SW_CTRL_ALIAS;
+};
+
+struct sim_acs_vdda_cp_ctrl_tag
+{
+    uint8_t PTRIM_BYTE;
+};
+
+struct sim_acs_rcosc_ctrl_tag
+{
+    uint8_t FTRIM_32K_BYTE;
+};
+
+struct sim_acs_xtal32k_ctrl_tag
+{
+    uint8_t CLOAD_TRIM_BYTE;
+    uint32_t ENABLE_ALIAS;
+    uint32_t EN_AMPL_CTRL_ALIAS;
+    uint32_t READY_ALIAS;
+};
+
+struct sim_acs_rtc_cfg_tag
+{
+    uint32_t START_VALUE;
+};
+
+struct sim_acs_rtc_count_tag
+{
+    uint32_t VALUE;
+};
+
+struct sim_acs_wakeup_ctrl_tag
+{
+    uint8_t PADS_RETENTION_EN_BYTE;
+};
+
+struct sim_acs_wakeup_state_tag
+{
+    uint32_t BB_TIMER_EVENT_ALIAS;
+    uint32_t RTC_ALARM_EVENT_ALIAS;
+};
+
+extern struct sim_acs_vtrim_tag sim_acs_bg_ctrl;
+extern struct sim_acs_vcc_ctrl_tag sim_acs_vcc_ctrl;
+extern struct sim_acs_vtrim_tag sim_acs_vddc_ctrl;
+extern struct sim_acs_vtrim_tag sim_acs_vddm_ctrl;
+extern struct sim_acs_vddrf_ctrl_tag sim_acs_vddrf_ctrl;
+extern struct sim_acs_vddpa_ctrl_tag sim_acs_vddpa_ctrl;
+extern struct sim_acs_vdda_cp_ctrl_tag sim_acs_vdda_cp_ctrl;
+extern struct sim_acs_rcosc_ctrl_tag sim_acs_rcosc_ctrl;
+extern struct sim_acs_xtal32k_ctrl_tag sim_acs_xtal32k_ctrl;
+extern struct sim_acs_rtc_cfg_tag sim_acs_rtc_cfg;
+extern struct sim_acs_rtc_count_tag sim_acs_rtc_count;
+extern struct sim_acs_wakeup_ctrl_tag sim_acs_wakeup_ctrl;
+extern struct sim_acs_wakeup_state_tag sim_acs_wakeup_state;
+
+#define ACS_BG_CTRL                     (&sim_acs_bg_ctrl)
+#define ACS_VCC_CTRL                    (&sim_acs_vcc_ctrl)
+#define ACS_VDDC_CTRL                   (&sim_acs_vddc_ctrl)
+#define ACS_VDDM_CTRL                   (&sim_acs_vddm_ctrl)
+#define ACS_VDDRF_CTRL                  (&sim_acs_vddrf_ctrl)
+#define ACS_VDDPA_CTRL                  (&sim_acs_vddpa_ctrl)
+#define ACS_VDDA_CP_CTRL                (&sim_acs_vdda_cp_ctrl)
+#define ACS_RCOSC_CTRL                  (&sim_acs_rcosc_ctrl)
+#define ACS_XTAL32K_CTRL                (&sim_acs_xtal32k_ctrl)
+#define ACS_RTC_CFG                     (&sim_acs_rtc_cfg)
+#define ACS_RTC_COUNT                   (&sim_acs_rtc_count)
+#define ACS_WAKEUP_CTRL                 (&sim_acs_wakeup_ctrl)
+#define ACS_WAKEUP_STATE                (&sim_acs_wakeup_state)
+
+#define ACS_BG_CTRL_VTRIM_Mask          0x3F
+#define ACS_VCC_CTRL_VTRIM_Mask         0x1F
+#define ACS_VCC_CTRL_VTRIM_BYTE_Pos     0
+#define ACS_VDDC_CTRL_VTRIM_Mask        0x3F
+#define ACS_VDDM_CTRL_VTRIM_Mask        0x3F
+#define ACS_VDDRF_CTRL_VTRIM_Mask       0x3F
+#define ACS_VDDPA_CTRL_VTRIM_Mask       0x1F
+
+#define VCC_BUCK_BITBAND                1
+#define VCC_LDO_BITBAND                 0
+#define VCC_ICHTRIM_80MA_BYTE           0x0F
+#define VDDA_PTRIM_16MA_BYTE            0x03
+#define VDDRF_ENABLE_BITBAND            1
+#define VDDRF_DISABLE_BITBAND           0
+#define VDDRF_DISABLE_HIZ_BITBAND       0
+#define VDDRF_READY_BITBAND             1
+#define VDDPA_ENABLE_BITBAND            1
+#define VDDPA_DISABLE_BITBAND           0
+#define VDDPA_SW_HIZ_BITBAND            0
+#define VDDPA_SW_VDDRF_BITBAND          1
+
+#define RC_OSC_ENABLE                   (1U << 0)
+#define RC_OSC_NOM                      (0U << 1)
+#define XTAL32K_ENABLE_BITBAND          1
+#define XTAL32K_AMPL_CTRL_ENABLE_BITBAND 1
+#define XTAL32K_OK_BITBAND              1
+
+#define RTC_CLK_SRC_RC_OSC              (0U << 0)
+#define RTC_CLK_SRC_XTAL32K             (1U << 0)
+#define RTC_CLK_SRC_GPIO0               (2U << 0)
+#define RTC_ALARM_DISABLE               (0U << 2)
+#define RTC_ALARM_ZERO                  (1U << 2)
+#define RTC_ENABLE                      (1U << 4)
+
+#define WAKEUP_DELAY_32                 (5U << 0)
+#define WAKEUP_WAKEUP_PAD_RISING        (0U << 3)
+#define WAKEUP_DIO0_DISABLE             (0U << 4)
+#define WAKEUP_DIO1_DISABLE             (0U << 5)
+#define WAKEUP_DIO2_DISABLE             (0U << 6)
+#define WAKEUP_DIO3_DISABLE             (0U << 7)
+#define WAKEUP_DIO3_ENABLE              (1U << 7)
+#define WAKEUP_DIO3_RISING              (0U << 11)
+#define WAKEUP_DIO3_FALLING             (1U << 11)
+
+#define PADS_RETENTION_ENABLE           (1U << 0)
+#define PADS_RETENTION_DISABLE_BYTE     0
+#define BOOT_FLASH_APP_REBOOT_DISABLE   (0U << 1)
+#define BOOT_CUSTOM                     (0U << 2)
+#define WAKEUP_DCDC_OVERLOAD_CLEAR      (1U << 8)
+#define WAKEUP_PAD_EVENT_CLEAR          (1U << 9)
+#define WAKEUP_RTC_ALARM_CLEAR          (1U << 10)
+#define WAKEUP_BB_TIMER_CLEAR           (1U << 11)
+#define WAKEUP_DIO0_EVENT_CLEAR         (1U << 12)
+#define WAKEUP_DIO1_EVENT_CLEAR         (1U << 13)
+#define WAKEUP_DIO2_EVENT_CLEAR         (1U << 14)
+#define WAKEUP_DIO3_EVENT_CLEAR         (1U << 15)
+
+/* Calibrated supply configuration from the manufacturing records (NVR) */
+static inline unsigned int Sys_Power_DCDCCalibratedConfig(uint16_t target)
+{
+    (void)target;
+    return ERRNO_NO_ERROR;
+}
+
+static inline unsigned int Sys_Power_VDDRFCalibratedConfig(uint16_t target)
+{
+    (void)target;
+    return ERRNO_NO_ERROR;
+}
+
+static inline unsigned int Sys_Power_VDDPACalibratedConfig(uint16_t target)
+{
+    (void)target;
+    return ERRNO_NO_ERROR;
+}
+
+static inline unsigned int Sys_Power_VDDCCalibratedConfig(uint16_t target)
+{
+    (void)target;
+    return ERRNO_NO_ERROR;
+}
+
+static inline unsigned int Sys_Power_VDDMCalibratedConfig(uint16_t target)
+{
+    (void)target;
+    return ERRNO_NO_ERROR;
+}
+
+static inline void Sys_Clocks_Osc32kHz(uint32_t cfg) { (void)cfg; }
+
+static inline unsigned int Sys_Clocks_OscRCCalibratedConfig(uint16_t target)
+{
+    (void)target;
+    return ERRNO_NO_ERROR;
+}
+
+/* RTC counter, counting down from ACS_RTC_CFG->START_VALUE */
+static inline uint32_t Sys_RTC_Value(void)
+{
+    return ACS_RTC_COUNT->VALUE;
+}
+
+/* NVR4 manufacturing records: all erased */
+static inline unsigned int Sys_ReadNVR4(unsigned int addr, unsigned int length,
+                                        unsigned int *data)
+{
+    (void)addr;
+    while (length-- > 0)
+    {
+        *data++ = 0xFFFFFFFF;
+    }
+    return ERRNO_NO_ERROR;
+}
+
+/* ----------------------------------------------------------------------------
+ * Clocks, RF front-end, baseband interface and flash
+ * ------------------------------------------------------------------------- */
+struct sim_clk_tag
+{
+    uint32_t DIV_CFG0;
+};
+
+struct sim_clk_div_cfg2_tag
+{
+    uint8_t DCCLK_BYTE;
+};
+
+struct sim_clk_sys_cfg_tag
+{
+    uint8_t SYSCLK_SRC_SEL_BYTE;
+};
+
+struct sim_rf_tag
+{
+    uint32_t XTAL_CTRL;
+};
+
+struct sim_rf_reg2f_tag
+{
+    uint8_t CK_DIV_1_6_CK_DIV_1_6_BYTE;
+};
+
+struct sim_rf_reg39_tag
+{
+    uint32_t ANALOG_INFO_CLK_DIG_READY_ALIAS;
+};
+
+struct sim_sysctrl_rf_power_cfg_tag
+{
+    uint32_t RF_POWER_ALIAS;
+};
+
+struct sim_sysctrl_rf_access_cfg_tag
+{
+    uint32_t RF_ACCESS_ALIAS;
+};
+
+struct sim_bbif_tag
+{
+    uint32_t CTRL;
+};
+
+struct sim_flash_tag
+{
+    uint32_t DELAY_CTRL;
+    uint32_t ECC_STATUS;
+};
+
+extern struct sim_clk_tag sim_clk;
+extern struct sim_clk_div_cfg2_tag sim_clk_div_cfg2;
+extern struct sim_clk_sys_cfg_tag sim_clk_sys_cfg;
+extern struct sim_rf_tag sim_rf;
+extern struct sim_rf_reg2f_tag sim_rf_reg2f;
+extern struct sim_rf_reg39_tag sim_rf_reg39;
+extern struct sim_sysctrl_rf_power_cfg_tag sim_sysctrl_rf_power_cfg;
+extern struct sim_sysctrl_rf_access_cfg_tag sim_sysctrl_rf_access_cfg;
+extern struct sim_bbif_tag sim_bbif;
+extern struct sim_flash_tag sim_flash;
+
+#define CLK                             (&sim_clk)
+#define CLK_DIV_CFG2                    (&sim_clk_div_cfg2)
+#define CLK_SYS_CFG                     (&sim_clk_sys_cfg)
+#define RF                              (&sim_rf)
+#define RF_REG2F                        (&sim_rf_reg2f)
+#define RF_REG39                        (&sim_rf_reg39)
+#define SYSCTRL_RF_POWER_CFG            (&sim_sysctrl_rf_power_cfg)
+#define SYSCTRL_RF_ACCESS_CFG           (&sim_sysctrl_rf_access_cfg)
+#define BBIF                            (&sim_bbif)
+#define FLASH                           (&sim_flash)
+
+#define JTCK_PRESCALE_1                 (0U << 0)
+#define EXTCLK_PRESCALE_1               (0U << 8)
+#define SYSCLK_CLKSRC_RCCLK             (0U << 16)
+#define SYSCLK_CLKSRC_RFCLK             (1U << 16)
+#define SYSCLK_CLKSRC_RFCLK_BYTE        1
+#define SLOWCLK_PRESCALE_8              (7U << 0)
+#define BBCLK_PRESCALE_1                (0U << 8)
+#define USRCLK_PRESCALE_1               (0U << 16)
+#define DCCLK_PRESCALE_2_BYTE           1
+#define CK_DIV_1_6_PRESCALE_6_BYTE      5
+#define XTAL_CTRL_DISABLE_OSCILLATOR    (1U << 0)
+#define XTAL_CTRL_REG_VALUE_SEL_INTERNAL (1U << 1)
+#define ANALOG_INFO_CLK_DIG_READY_BITBAND 1
+#define RF_POWER_ENABLE_BITBAND         1
+#define RF_ACCESS_ENABLE_BITBAND        1
+#define BB_CLK_ENABLE                   (1U << 0)
+#define BBCLK_DIVIDER_8                 (7U << 1)
+#define BB_DEEP_SLEEP                   (0U << 4)
+#define BB_WAKEUP                       (1U << 4)
+#define DEFAULT_READ_MARGIN             (0U << 4)
+#define FLASH_DELAY_FOR_SYSCLK_8MHZ     2
+#define FLASH_ECC_COR_ERROR_CNT_CLEAR   (1U << 0)
+#define FLASH_ECC_UNCOR_ERROR_CNT_CLEAR (1U << 1)
+
+static inline void Sys_Clocks_SystemClkConfig(uint32_t cfg) { (void)cfg; }
+
+static inline unsigned int Sys_RFFE_SetTXPower(int8_t tx_power)
+{
+    (void)tx_power;
+    return ERRNO_NO_ERROR;
+}
+
+#define FLASH_ERR_NONE                  0
+
+unsigned int Flash_WriteWordPair(unsigned int addr, unsigned int word0,
+                                 unsigned int word1);
+unsigned int Flash_EraseSector(unsigned int addr);
+
+/* ----------------------------------------------------------------------------
+ * ADC and battery monitor
+ * ------------------------------------------------------------------------- */
+struct sim_adc_tag
+{
+    uint32_t CFG;
+    uint32_t INPUT_SEL[8];
+    uint32_t DATA_TRIM_CH[8];
+    uint32_t BATMON_INT_ENABLE;
+    uint32_t BATMON_STATUS;
+};
+extern struct sim_adc_tag sim_adc;
+#define ADC                             (&sim_adc)
+
+/* ADC_CFG: mode, prescaler of SLOWCLK (sample period of the channels),
+ * battery divider */
+#define ADC_MODE_Mask                   (3U << 0)
+#define ADC_DISABLE                     (0U << 0)
+#define ADC_NORMAL                      (1U << 0)
+#define ADC_CONTINUOUS                  (2U << 0)
+#define ADC_PRESCALE_Pos                4
+#define ADC_PRESCALE_Mask               (0xFU << ADC_PRESCALE_Pos)
+#define ADC_PRESCALE_200                (1U << ADC_PRESCALE_Pos)
+#define ADC_PRESCALE_1600               (4U << ADC_PRESCALE_Pos)
+#define ADC_PRESCALE_6400               (6U << ADC_PRESCALE_Pos)
+#define ADC_VBAT_DIV2_NORMAL            (0U << 8)
+#define ADC_VBAT_DIV2_DUTY              (1U << 8)
+
+#define ADC_NEG_INPUT_GND               (0U << 0)
+#define ADC_POS_INPUT_VBAT_DIV2         (1U << 4)
+
+/* ADC_BATMON_INT_ENABLE; ADC_BATMON_STATUS */
+#define INT_DIS_ADC                     (0U << 0)
+#define INT_EBL_ADC                     (1U << 0)
+#define INT_DIS_BATMON_ALARM            (0U << 1)
+#define INT_EBL_BATMON_ALARM            (1U << 1)
+#define ADC_INT_CH0                     (0U << 4)
+#define ADC_READY_TRUE                  (1U << 0)
+
+static inline void Sys_ADC_Set_Config(uint32_t cfg)
+{
+    ADC->CFG = cfg;
+}
+
+static inline void Sys_ADC_InputSelectConfig(uint32_t num, uint32_t cfg)
+{
+    ADC->INPUT_SEL[num] = cfg;
+}
+
+static inline void Sys_ADC_Set_BATMONIntConfig(uint32_t cfg)
+{
+    ADC->BATMON_INT_ENABLE = cfg;
+}
+
+static inline void Sys_ADC_Clear_BATMONStatus(void)
+{
+    ADC->BATMON_STATUS = 0;
+}
+
+/* ----------------------------------------------------------------------------
+ * Audiosink (RC oscillator period measurement)
+ * ------------------------------------------------------------------------- */
+struct sim_audiosink_tag
+{
+    uint32_t CFG;
+    uint32_t PERIOD_CNT;
+};
+
+struct sim_audiosink_ctrl_tag
+{
+    uint32_t PERIOD_CNT_START_ALIAS;
+};
+
+extern struct sim_audiosink_tag sim_audiosink;
+extern struct sim_audiosink_ctrl_tag sim_audiosink_ctrl;
+#define AUDIOSINK                       (&sim_audiosink)
+#define AUDIOSINK_CTRL                  (&sim_audiosink_ctrl)
+
+#define AUDIO_SINK_PERIODS_16           15
+#define AUDIOSINK_CLK_SRC_STANDBYCLK    (2U << 0)
+
+static inline void Sys_Audiosink_ResetCounters(void)
+{
+    AUDIOSINK->PERIOD_CNT = 0;
+}
+
+static inline void Sys_Audiosink_InputClock(uint32_t cfg0, uint32_t clk_src)
+{
+    (void)cfg0;
+    (void)clk_src;
+}
+
+static inline void Sys_Audiosink_Config(uint32_t periods, uint32_t phase,
+                                        uint32_t period)
+{
+    (void)phase;
+    (void)period;
+    AUDIOSINK->CFG = periods;
+}
+
+static inline uint32_t Sys_Audiosink_PeriodCounter(void)
+{
+    return AUDIOSINK->PERIOD_CNT;
+}
+
+/* ----------------------------------------------------------------------------
+ * DIO
+ * ------------------------------------------------------------------------- */
+#define DIO_MODE_GPIO_OUT_0             0x01
+#define DIO_MODE_INPUT                  0x02
+#define DIO_MODE_GPIO_OUT_1             0x03
+#define DIO_MODE_DISABLE                0x04
+#define DIO_NO_PULL                     0x00
+#define DIO_WEAK_PULL_UP                0x08
+#define DIO_STRONG_PULL_UP              0x10
+#define DIO_WEAK_PULL_DOWN              0x18
+#define DIO_LPF_DISABLE                 0x00
+#define DIO_LPF_ENABLE                  0x20
+#define DIO_2X_DRIVE                    0x00
+#define DIO_3X_DRIVE                    0x40
+#define DIO_5X_DRIVE                    0x80
+#define DIO_6X_DRIVE                    0xC0
+#define PAD_LOW_DRIVE                   0x00
+
+struct sim_dio_tag
+{
+    uint32_t CFG[16];
+    uint32_t PAD_CFG;
+};
+extern struct sim_dio_tag sim_dio;
+#define DIO                             (&sim_dio)
+
+struct sim_dio_data_tag
+{
+    uint32_t ALIAS[16];
+};
+extern struct sim_dio_data_tag sim_dio_data;
+#define DIO_DATA                        (&sim_dio_data)
+
+void Sys_DIO_Config(uint32_t dio, uint32_t config);
+void Sys_I2C_DIOConfig(uint32_t config, uint32_t scl, uint32_t sda);
+
+static inline void Sys_GPIO_Set_Low(uint32_t dio)
+{
+    DIO_DATA->ALIAS[dio] = 0;
+}
+
+static inline void Sys_GPIO_Set_High(uint32_t dio)
+{
+    DIO_DATA->ALIAS[dio] = 1;
+}
+
+static inline void Sys_GPIO_Toggle(uint32_t dio)
+{
+    DIO_DATA->ALIAS[dio] ^= 1;
+}
+
+/* ----------------------------------------------------------------------------
+ * I2C interface
+ * ------------------------------------------------------------------------- */
+struct sim_i2c_tag
+{
+    uint32_t CTRL0;
+    uint32_t DATA;
+    uint32_t STATUS;
+};
+extern struct sim_i2c_tag sim_i2c;
+#define I2C                             (&sim_i2c)
+
+struct sim_i2c_ctrl1_tag
+{
+    uint32_t LAST_DATA_ALIAS;
+};
+extern struct sim_i2c_ctrl1_tag sim_i2c_ctrl1;
+#define I2C_CTRL1                       (&sim_i2c_ctrl1)
+#define I2C_LAST_DATA_BITBAND           1
+
+#define I2C_CTRL0_SPEED_Pos             8
+#define I2C_CTRL0_SPEED_Mask            (0xFFU << I2C_CTRL0_SPEED_Pos)
+#define I2C_CONTROLLER_CM3              (0U << 0)
+#define I2C_CONTROLLER_DMA              (1U << 0)
+#define I2C_AUTO_ACK_DISABLE            (0U << 1)
+#define I2C_AUTO_ACK_ENABLE             (1U << 1)
+#define I2C_STOP_INT_ENABLE             (1U << 2)
+#define I2C_SAMPLE_CLK_ENABLE           (1U << 3)
+#define I2C_SLAVE_DISABLE               (0U << 4)
+
+#define I2C_STATUS_BUS_ERROR_Pos        0
+#define I2C_STATUS_ERROR_Pos            1
+#define I2C_STATUS_ACK_STATUS_Pos       2
+#define I2C_STATUS_READ_WRITE_Pos       3
+#define I2C_STATUS_BUFFER_FULL_Pos      4
+#define I2C_STATUS_STOP_DETECT_Pos      5
+
+#define I2C_HAS_ACK                     (0U << I2C_STATUS_ACK_STATUS_Pos)
+#define I2C_HAS_NACK                    (1U << I2C_STATUS_ACK_STATUS_Pos)
+#define I2C_IS_WRITE                    (0U << I2C_STATUS_READ_WRITE_Pos)
+#define I2C_IS_READ                     (1U << I2C_STATUS_READ_WRITE_Pos)
+#define I2C_BUFFER_FULL                 (1U << I2C_STATUS_BUFFER_FULL_Pos)
+
+void Sys_I2C_Config(uint32_t config);
+void Sys_I2C_Reset(void);
+void Sys_I2C_StartWrite(uint32_t address);
+void Sys_I2C_StartRead(uint32_t address);
+void Sys_I2C_ACK(void);
+void Sys_I2C_NackAndStop(void);
+uint32_t Sys_I2C_Get_Status(void);
+
+/* ----------------------------------------------------------------------------
+ * DMA
+ * ------------------------------------------------------------------------- */
+#define DMA_ENABLE                      (1U << 0)
+#define DMA_COMPLETE_INT_DISABLE        (0U << 1)
+#define DMA_COMPLETE_INT_ENABLE         (1U << 1)
+#define DMA_COUNTER_INT_DISABLE         (0U << 2)
+#define DMA_COUNTER_INT_ENABLE          (1U << 2)
+#define DMA_START_INT_DISABLE           0
+#define DMA_ERROR_INT_DISABLE           0
+#define DMA_DISABLE_INT_DISABLE         0
+#define DMA_TRANSFER_M_TO_P             (0U << 3)
+#define DMA_TRANSFER_P_TO_M             (1U << 3)
+#define DMA_DEST_I2C                    0
+#define DMA_SRC_I2C                     0
+#define DMA_LITTLE_ENDIAN               0
+#define DMA_PRIORITY_0                  0
+#define DMA_SRC_WORD_SIZE_8             0
+#define DMA_DEST_WORD_SIZE_8            0
+#define DMA_SRC_ADDR_INC                0
+#define DMA_SRC_ADDR_STATIC             0
+#define DMA_DEST_ADDR_INC               0
+#define DMA_DEST_ADDR_STATIC            0
+
+#define DMA_COMPLETE_INT_STATUS         (1U << 0)
+#define DMA_COUNTER_INT_STATUS          (1U << 1)
+
+void Sys_DMA_ChannelConfig(uint32_t num, uint32_t cfg, uint32_t transfer_length,
+                           uint32_t counter_int, uint32_t src_addr,
+                           uint32_t dest_addr);
+void Sys_DMA_ChannelDisable(uint32_t num);
+void Sys_DMA_ClearChannelStatus(uint32_t num);
+uint32_t Sys_DMA_Get_ChannelStatus(uint32_t num);
+
+#endif /* RSL10_H */
@@ -0,0 +1,587 @@
+/* ----------------------------------------------------------------------------
+ * rsl10_ble.h (host shim)
+ * - Minimal stand-in for the Bluetooth stack API of the RSL10 SDK, limited to
+ *   what the application uses: task identifiers, the GAPM, GAPC, GATTM and
+ *   GATTC messages and their parameters (same field names and types as the
+ *   stack, message identifier values are not the ones of the stack),
+ *   attribute permissions, the profile environment access and the stack
+ *   control functions. The functions are implemented by the simulation
+ *   (tools/wake_sim.c), which also answers the commands as the stack.
+ * ------------------------------------------------------------------------- */
+
+#ifndef RSL10_BLE_H
+#define RSL10_BLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <rsl10_ke.h>
+
+/* ----------------------------------------------------------------------------
+ * Tasks
+ * ------------------------------------------------------------------------- */
+/* Task types (instances of the kernel) */
+enum
+{
+    TASK_GAPM,
+    TASK_GAPC,
+    TASK_GATTM,
+    TASK_GATTC,
+    TASK_BASS,
+    TASK_APP,
+    TASK_MAX
+};
+
+/* Task identifiers (message identifier ranges, profile identifiers) */
+enum
+{
+    TASK_ID_GAPM = 4,
+    TASK_ID_GAPC = 14,
+    TASK_ID_GATTM = 11,
+    TASK_ID_GATTC = 12,
+    TASK_ID_BASS = 34,
+    TASK_ID_APP = 40
+};
+
+/* ----------------------------------------------------------------------------
+ * Common definitions
+ * ------------------------------------------------------------------------- */
+#define BD_ADDR_LEN                     6
+#define KEY_LEN                         0x10
+#define ADV_DATA_LEN                    0x1F
+#define SCAN_RSP_DATA_LEN               0x1F
+#define BLE_MIN_OCTETS                  27
+#define BLE_MIN_TIME                    328
+#define ATT_DEFAULT_MTU                 23
+#define GAP_INVALID_CONIDX              0xFF
+
+typedef struct bd_addr
+{
+    uint8_t addr[BD_ADDR_LEN];
+} bd_addr_t;
+
+struct gap_sec_key
+{
+    uint8_t key[KEY_LEN];
+};
+
+/* Default public address of the stack */
+extern const struct bd_addr co_default_bdaddr;
+
+/* Error codes */
+#define GAP_ERR_NO_ERROR                0x00
+#define GAP_ERR_INVALID_PARAM           0x40
+#define GAP_ERR_NOT_SUPPORTED           0x42
+#define GAP_ERR_COMMAND_DISALLOWED      0x43
+#define GAP_ERR_CANCELED                0x44
+#define GAP_ERR_INSUFF_RESOURCES        0x4C
+#define GAP_ERR_DISCONNECTED            0x46
+#define ATT_ERR_NO_ERROR                0x00
+#define ATT_ERR_INVALID_HANDLE          0x01
+#define ATT_ERR_READ_NOT_PERMITTED      0x02
+#define ATT_ERR_WRITE_NOT_PERMITTED     0x03
+#define ATT_ERR_INVALID_OFFSET          0x07
+#define ATT_ERR_INVALID_ATTRIBUTE_VAL_LEN 0x0D
+
+/* ----------------------------------------------------------------------------
+ * Attributes
+ * ------------------------------------------------------------------------- */
+#define ATT_UUID_16_LEN                 2
+#define ATT_UUID_32_LEN                 4
+#define ATT_UUID_128_LEN                16
+#define ATT_CCC_STOP_NTFIND             0x0000
+#define ATT_CCC_START_NTF               0x0001
+#define ATT_CCC_START_IND               0x0002
+#define ATT_UNIT_PERCENTAGE             0x27AD
+
+/* Permission fields: PERM(access, right) gives the field value at its
+ * position */
+enum attm_uuid_len
+{
+    PERM_UUID_16 = 0,
+    PERM_UUID_32 = 1,
+    PERM_UUID_128 = 2
+};
+
+#define PERM_RIGHT_DISABLE              0
+#define PERM_RIGHT_ENABLE               1
+#define PERM_RIGHT_UNAUTH               1
+#define PERM_RIGHT_AUTH                 2
+#define PERM_RIGHT_UUID_16              PERM_UUID_16
+#define PERM_RIGHT_UUID_32              PERM_UUID_32
+#define PERM_RIGHT_UUID_128             PERM_UUID_128
+
+#define PERM_POS_RD                     0
+#define PERM_MASK_RD                    0x0001
+#define PERM_POS_WRITE_COMMAND          2
+#define PERM_MASK_WRITE_COMMAND         0x0004
+#define PERM_POS_WRITE_REQ              3
+#define PERM_MASK_WRITE_REQ             0x0008
+#define PERM_POS_NTF                    6
+#define PERM_MASK_NTF                   0x0040
+#define PERM_POS_RI                     15
+#define PERM_MASK_RI                    0x8000
+#define PERM_POS_UUID_LEN               13
+#define PERM_MASK_UUID_LEN              0x6000
+#define PERM_POS_SVC_AUTH               2
+#define PERM_MASK_SVC_AUTH              0x0C
+#define PERM_POS_SVC_UUID_LEN           5
+#define PERM_MASK_SVC_UUID_LEN          0x60
+
+#define PERM(access, right)                                                   \
+    (((PERM_RIGHT_ ## right) << (PERM_POS_ ## access)) &                      \
+     (PERM_MASK_ ## access))
+
+/* ----------------------------------------------------------------------------
+ * GAP manager (GAPM)
+ * ------------------------------------------------------------------------- */
+enum gapm_msg_id
+{
+    GAPM_CMP_EVT = TASK_FIRST_MSG(TASK_ID_GAPM),
+    GAPM_RESET_CMD,
+    GAPM_SET_DEV_CONFIG_CMD,
+    GAPM_CANCEL_CMD,
+    GAPM_START_ADVERTISE_CMD,
+    GAPM_UPDATE_ADVERTISE_DATA_CMD,
+    GAPM_PROFILE_TASK_ADD_CMD,
+    GAPM_PROFILE_ADDED_IND
+};
+
+/* GAPM operations */
+enum gapm_operation
+{
+    GAPM_NO_OP = 0x00,
+    GAPM_RESET = 0x01,
+    GAPM_CANCEL = 0x02,
+    GAPM_SET_DEV_CONFIG = 0x03,
+    GAPM_ADV_NON_CONN = 0x0D,
+    GAPM_ADV_UNDIRECT = 0x0E,
+    GAPM_ADV_DIRECT = 0x0F,
+    GAPM_UPDATE_ADVERTISE_DATA = 0x12,
+    GAPM_PROFILE_TASK_ADD = 0x1B
+};
+
+/* Device configuration */
+#define GAP_ROLE_NONE                   0x00
+#define GAP_ROLE_OBSERVER               0x01
+#define GAP_ROLE_BROADCASTER            0x02
+#define GAP_ROLE_CENTRAL                0x05
+#define GAP_ROLE_PERIPHERAL             0x0A
+#define GAPM_CFG_ADDR_PUBLIC            0x00
+#define GAPM_CFG_ADDR_PRIVATE           0x01
+#define GAPM_PAIRING_DISABLE            0x00
+#define GAPM_WRITE_DISABLE              0x00
+#define GAP_RATE_ANY                    0x00
+
+/* Advertising */
+#define GAPM_STATIC_ADDR                0x00
+#define GAP_NON_DISCOVERABLE            0x00
+#define GAP_GEN_DISCOVERABLE            0x01
+#define GAP_LIM_DISCOVERABLE            0x02
+#define GAP_BROADCASTER_MODE            0x03
+#define ADV_ALLOW_SCAN_ANY_CON_ANY      0x00
+
+struct gapm_cmp_evt
+{
+    uint8_t operation;
+    uint8_t status;
+};
+
+struct gapm_reset_cmd
+{
+    uint8_t operation;
+};
+
+struct gapm_set_dev_config_cmd
+{
+    uint8_t operation;
+    uint8_t role;
+    uint16_t renew_dur;
+    bd_addr_t addr;
+    struct gap_sec_key irk;
+    uint8_t addr_type;
+    uint8_t pairing_mode;
+    uint16_t gap_start_hdl;
+    uint16_t gatt_start_hdl;
+    uint16_t att_cfg;
+    uint16_t sugg_max_tx_octets;
+    uint16_t sugg_max_tx_time;
+    uint16_t max_mtu;
+    uint16_t max_mps;
+    uint8_t max_nb_lecb;
+    uint8_t audio_cfg;
+    uint8_t tx_pref_rates;
+    uint8_t rx_pref_rates;
+};
+
+struct gapm_cancel_cmd
+{
+    uint8_t operation;
+};
+
+struct gapm_air_operation
+{
+    uint8_t code;
+    uint8_t addr_src;
+    uint16_t state;
+};
+
+struct gapm_adv_host
+{
+    uint8_t mode;
+    uint8_t adv_filt_policy;
+    uint8_t adv_data_len;
+    uint8_t adv_data[ADV_DATA_LEN - 3];
+    uint8_t scan_rsp_data_len;
+    uint8_t scan_rsp_data[SCAN_RSP_DATA_LEN];
+};
+
+struct gapm_start_advertise_cmd
+{
+    struct gapm_air_operation op;
+    uint16_t intv_min;
+    uint16_t intv_max;
+    uint8_t channel_map;
+    union
+    {
+        struct gapm_adv_host host;
+    } info;
+};
+
+struct gapm_update_advertise_data_cmd
+{
+    uint8_t operation;
+    uint8_t adv_data_len;
+    uint8_t adv_data[ADV_DATA_LEN - 3];
+    uint8_t scan_rsp_data_len;
+    uint8_t scan_rsp_data[SCAN_RSP_DATA_LEN];
+};
+
+struct gapm_profile_task_add_cmd
+{
+    uint8_t operation;
+    uint8_t sec_lvl;
+    uint16_t prf_task_id;
+    uint16_t app_task;
+    uint16_t start_hdl;
+    uint8_t param[__ARRAY_EMPTY];
+};
+
+struct gapm_profile_added_ind
+{
+    uint16_t prf_task_id;
+    uint16_t prf_task_nb;
+    uint16_t start_hdl;
+};
+
+/* ----------------------------------------------------------------------------
+ * GAP controller (GAPC)
+ * ------------------------------------------------------------------------- */
+enum gapc_msg_id
+{
+    GAPC_CMP_EVT = TASK_FIRST_MSG(TASK_ID_GAPC),
+    GAPC_CONNECTION_REQ_IND,
+    GAPC_CONNECTION_CFM,
+    GAPC_DISCONNECT_IND,
+    GAPC_GET_DEV_INFO_REQ_IND,
+    GAPC_GET_DEV_INFO_CFM,
+    GAPC_PARAM_UPDATE_REQ_IND,
+    GAPC_PARAM_UPDATE_CFM,
+    GAPC_PARAM_UPDATED_IND,
+    GAPC_SET_LE_PKT_SIZE_CMD,
+    GAPC_LE_PKT_SIZE_IND
+};
+
+enum gapc_operation
+{
+    GAPC_NO_OP = 0x00,
+    GAPC_SET_LE_PKT_SIZE = 0x1C
+};
+
+enum gapc_dev_info
+{
+    GAPC_DEV_NAME,
+    GAPC_DEV_APPEARANCE,
+    GAPC_DEV_SLV_PREF_PARAMS
+};
+
+#define GAP_AUTH_REQ_NO_MITM_NO_BOND    0x00
+
+struct gapc_cmp_evt
+{
+    uint8_t operation;
+    uint8_t status;
+};
+
+struct gapc_connection_req_ind
+{
+    uint16_t conhdl;
+    uint16_t con_interval;
+    uint16_t con_latency;
+    uint16_t sup_to;
+    uint8_t clk_accuracy;
+    uint8_t peer_addr_type;
+    bd_addr_t peer_addr;
+};
+
+struct gapc_connection_cfm
+{
+    struct gap_sec_key lcsrk;
+    uint32_t lsign_counter;
+    struct gap_sec_key rcsrk;
+    uint32_t rsign_counter;
+    uint8_t auth;
+    uint8_t svc_changed_ind_enable;
+};
+
+struct gapc_disconnect_ind
+{
+    uint16_t conhdl;
+    uint8_t reason;
+};
+
+struct gapc_get_dev_info_req_ind
+{
+    uint8_t req;
+};
+
+struct gap_dev_name
+{
+    uint16_t length;
+    uint8_t value[__ARRAY_EMPTY];
+};
+
+struct gap_slv_pref
+{
+    uint16_t con_intv_min;
+    uint16_t con_intv_max;
+    uint16_t slave_latency;
+    uint16_t conn_timeout;
+};
+
+struct gapc_get_dev_info_cfm
+{
+    uint8_t req;
+    union gapc_dev_info_val
+    {
+        uint16_t appearance;
+        struct gap_slv_pref slv_params;
+        struct gap_dev_name name;
+    } info;
+};
+
+struct gapc_param_update_req_ind
+{
+    uint16_t intv_min;
+    uint16_t intv_max;
+    uint16_t latency;
+    uint16_t time_out;
+};
+
+struct gapc_param_update_cfm
+{
+    bool accept;
+    uint16_t ce_len_min;
+    uint16_t ce_len_max;
+};
+
+struct gapc_param_updated_ind
+{
+    uint16_t con_interval;
+    uint16_t con_latency;
+    uint16_t sup_to;
+};
+
+struct gapc_set_le_pkt_size_cmd
+{
+    uint8_t operation;
+    uint16_t tx_octets;
+    uint16_t tx_time;
+};
+
+struct gapc_le_pkt_size_ind
+{
+    uint16_t max_tx_octets;
+    uint16_t max_tx_time;
+    uint16_t max_rx_octets;
+    uint16_t max_rx_time;
+};
+
+/* ----------------------------------------------------------------------------
+ * GATT manager (GATTM) and controller (GATTC)
+ * ------------------------------------------------------------------------- */
+enum gattm_msg_id
+{
+    GATTM_ADD_SVC_REQ = TASK_FIRST_MSG(TASK_ID_GATTM),
+    GATTM_ADD_SVC_RSP
+};
+
+enum gattc_msg_id
+{
+    GATTC_CMP_EVT = TASK_FIRST_MSG(TASK_ID_GATTC),
+    GATTC_EXC_MTU_CMD,
+    GATTC_MTU_CHANGED_IND,
+    GATTC_SEND_EVT_CMD,
+    GATTC_READ_REQ_IND,
+    GATTC_READ_CFM,
+    GATTC_WRITE_REQ_IND,
+    GATTC_WRITE_CFM
+};
+
+enum gattc_operation
+{
+    GATTC_NO_OP = 0x00,
+    GATTC_MTU_EXCH = 0x01,
+    GATTC_NOTIFY = 0x12,
+    GATTC_INDICATE = 0x13
+};
+
+struct gattm_att_desc
+{
+    uint8_t uuid[ATT_UUID_128_LEN];
+    uint16_t perm;
+    uint16_t max_len;
+    uint16_t ext_perm;
+};
+
+struct gattm_svc_desc
+{
+    uint16_t start_hdl;
+    uint16_t task_id;
+    uint8_t perm;
+    uint8_t nb_att;
+    uint8_t uuid[ATT_UUID_128_LEN];
+    struct gattm_att_desc atts[__ARRAY_EMPTY];
+};
+
+struct gattm_add_svc_req
+{
+    struct gattm_svc_desc svc_desc;
+};
+
+struct gattm_add_svc_rsp
+{
+    uint16_t start_hdl;
+    uint8_t status;
+};
+
+struct gattc_cmp_evt
+{
+    uint8_t operation;
+    uint8_t status;
+    uint16_t seq_num;
+};
+
+struct gattc_exc_mtu_cmd
+{
+    uint8_t operation;
+    uint16_t seq_num;
+};
+
+struct gattc_mtu_changed_ind
+{
+    uint16_t mtu;
+    uint16_t seq_num;
+};
+
+struct gattc_send_evt_cmd
+{
+    uint8_t operation;
+    uint16_t seq_num;
+    uint16_t handle;
+    uint16_t length;
+    uint8_t value[__ARRAY_EMPTY];
+};
+
+struct gattc_read_req_ind
+{
+    uint16_t handle;
+};
+
+struct gattc_read_cfm
+{
+    uint16_t handle;
+    uint16_t length;
+    uint8_t status;
+    uint8_t value[__ARRAY_EMPTY];
+};
+
+struct gattc_write_req_ind
+{
+    uint16_t handle;
+    uint16_t offset;
+    uint16_t length;
+    uint8_t value[__ARRAY_EMPTY];
+};
+
+struct gattc_write_cfm
+{
+    uint16_t handle;
+    uint8_t status;
+};
+
+/* ----------------------------------------------------------------------------
+ * Profiles
+ * ------------------------------------------------------------------------- */
+typedef struct prf_env
+{
+    ke_task_id_t app_task;
+    ke_task_id_t prf_task;
+} prf_env_t;
+
+struct prf_char_pres_fmt
+{
+    uint16_t unit;
+    uint16_t description;
+    uint8_t format;
+    int8_t exponent;
+    uint8_t name_space;
+};
+
+/* Environment of a profile task added with GAPM_PROFILE_TASK_ADD_CMD */
+void *prf_env_get(uint16_t prf_id);
+ke_task_id_t prf_src_task_get(prf_env_t *env, uint8_t conidx);
+
+#define PRF_ENV_GET(prf, type)                                                \
+    ((struct type ## _env_tag *)prf_env_get(TASK_ID_ ## prf))
+
+/* ----------------------------------------------------------------------------
+ * Stack control, device parameters and sleep
+ * ------------------------------------------------------------------------- */
+/* Source of the device parameters (Device_Param_Prepare) */
+enum
+{
+    FLASH_PROVIDED_or_DFLT = 0,
+    APP_PROVIDED = 1
+};
+
+typedef struct
+{
+    uint8_t device_param_src_type;
+    uint8_t bleAddress[BD_ADDR_LEN];
+    uint16_t clockAccuracy;
+    uint16_t adv_ifs;
+} app_device_param_t;
+
+#define PARAM_ID_PUBLIC_BLE_ADDRESS     0x01
+
+/* Low-level driver sleep parameters: wake-up time before the next event
+ * (TWOSC, in us) */
+struct lld_sleep_params_t
+{
+    uint16_t twosc;
+};
+
+void BLE_InitNoTL(uint8_t error);
+void BLE_Reset(void);
+bool BLE_Is_Awake(void);
+void BLE_Is_Awake_Flag_Set(void);
+void BLE_LLD_Sleep_Params_Set(struct lld_sleep_params_t params);
+void BLE_Power_Mode_Enter(void *power_mode_env, uint8_t power_mode);
+uint8_t Device_Param_Read(uint8_t param_id, uint8_t *buf);
+void LowPowerClock_Source_Set(uint8_t source);
+void RTCCLK_Period_Value_Set(float period);
+
+/* Called by the stack from BLE_InitNoTL, provided by the application */
+extern void Device_Param_Prepare(app_device_param_t *param);
+
+#endif /* RSL10_BLE_H */
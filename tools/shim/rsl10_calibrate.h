@@ -0,0 +1,25 @@
+/* ----------------------------------------------------------------------------
+ * rsl10_calibrate.h (host shim)
+ * - Minimal stand-in for the calibration library of the RSL10 SDK (used by
+ *   the application with CALIB_RECORD = USER_CALIB only). Not implemented
+ *   on the host.
+ * ------------------------------------------------------------------------- */
+
+#ifndef RSL10_CALIBRATE_H
+#define RSL10_CALIBRATE_H
+
+#include <stdint.h>
+
+void Calibrate_Power_Initialize(void);
+unsigned int Calibrate_Power_VDDRF(uint32_t adc_num, uint32_t *adc_ptr,
+                                   uint32_t target);
+unsigned int Calibrate_Power_VDDPA(uint32_t adc_num, uint32_t *adc_ptr,
+                                   uint32_t target);
+unsigned int Calibrate_Power_VDDC(uint32_t adc_num, uint32_t *adc_ptr,
+                                  uint32_t target);
+unsigned int Calibrate_Power_VDDM(uint32_t adc_num, uint32_t *adc_ptr,
+                                  uint32_t target);
+unsigned int Calibrate_Power_DCDC(uint32_t adc_num, uint32_t *adc_ptr,
+                                  uint32_t target);
+
+#endif /* RSL10_CALIBRATE_H */
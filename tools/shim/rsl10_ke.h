@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------
+ * rsl10_ke.h (host shim)
+ * - Minimal stand-in for the kernel API of the RSL10 SDK: task and message
+ *   types, message allocation and sending, task creation and the scheduler.
+ *   The functions are implemented by the simulation (tools/wake_sim.c), which
+ *   queues the messages and dispatches them from Kernel_Schedule to the
+ *   handler table of the destination task or to the simulated stack.
+ * ------------------------------------------------------------------------- */
+
+#ifndef RSL10_KE_H
+#define RSL10_KE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define __ARRAY_EMPTY
+
+typedef uint16_t ke_msg_id_t;
+typedef uint16_t ke_task_id_t;
+typedef uint8_t ke_state_t;
+
+typedef int (*ke_msg_func_t)(ke_msg_id_t const msg_id, void const *param,
+                             ke_task_id_t const dest_id,
+                             ke_task_id_t const src_id);
+
+struct ke_msg_handler
+{
+    ke_msg_id_t id;
+    ke_msg_func_t func;
+};
+
+struct ke_state_handler
+{
+    const struct ke_msg_handler *msg_table;
+    uint16_t msg_cnt;
+};
+
+struct ke_task_desc
+{
+    const struct ke_state_handler *state_handler;
+    const struct ke_state_handler *default_handler;
+    ke_state_t *state;
+    uint16_t state_max;
+    uint16_t idx_max;
+};
+
+#define KE_STATE_HANDLER(hdl)           { hdl, sizeof(hdl) / sizeof(hdl[0]) }
+#define KE_STATE_HANDLER_NONE           { NULL, 0 }
+
+/* Message handler status */
+enum ke_msg_status_tag
+{
+    KE_MSG_CONSUMED = 0,
+    KE_MSG_NO_FREE,
+    KE_MSG_SAVED
+};
+
+#define KE_MSG_DEFAULT_HANDLER          0xFFFF
+
+/* Task identifiers: task type in the LSB, instance index in the MSB */
+#define KE_BUILD_ID(type, index)        ((ke_task_id_t)(((index) << 8) | \
+                                                        (type)))
+#define KE_TYPE_GET(ke_task_id)         ((ke_task_id) & 0xFF)
+#define KE_IDX_GET(ke_task_id)          (((ke_task_id) >> 8) & 0xFF)
+#define TASK_NONE                       0xFF
+
+/* First message identifier of a task */
+#define TASK_FIRST_MSG(task)            ((ke_msg_id_t)((task) << 10))
+
+void *ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                   ke_task_id_t const src_id, uint16_t const param_len);
+void ke_msg_send(void const *param_ptr);
+void ke_msg_free(void const *param_ptr);
+
+#define KE_MSG_ALLOC(id, dest, src, param_str)                                \
+    ((struct param_str *)ke_msg_alloc(id, dest, src,                          \
+                                      sizeof(struct param_str)))
+#define KE_MSG_ALLOC_DYN(id, dest, src, param_str, length)                    \
+    ((struct param_str *)ke_msg_alloc(id, dest, src,                          \
+                                      sizeof(struct param_str) + (length)))
+
+uint8_t ke_task_create(uint8_t task_type,
+                       struct ke_task_desc const *p_task_desc);
+void ke_state_set(ke_task_id_t const id, ke_state_t const state_id);
+ke_state_t ke_state_get(ke_task_id_t const id);
+
+/* true if no kernel event or message is pending (sleep allowed) */
+bool ke_sleep_check(void);
+
+void Kernel_Init(uint32_t error);
+void Kernel_Schedule(void);
+
+/* Critical section of the stack; the interrupt handlers are called by the
+ * simulation, never preempted */
+#define GLOBAL_INT_DISABLE()            do                                    \
+                                        {                                     \
+                                            uint32_t sim_int_rest =           \
+                                                __get_PRIMASK();              \
+                                            __set_PRIMASK(1)
+#define GLOBAL_INT_RESTORE()                __set_PRIMASK(sim_int_rest);      \
+                                        } while (0)
+
+#endif /* RSL10_KE_H */
@@ -0,0 +1,15 @@
+/* ----------------------------------------------------------------------------
+ * rsl10_map_nvr.h (host shim)
+ * - Minimal stand-in for the NVR memory map of the RSL10 SDK, limited to
+ *   the manufacturing records read with Sys_ReadNVR4 (all erased on the
+ *   host)
+ * ------------------------------------------------------------------------- */
+
+#ifndef RSL10_MAP_NVR_H
+#define RSL10_MAP_NVR_H
+
+#define NVR4_BASE                       0x00081800
+#define MANU_INFO_BANDGAP               (NVR4_BASE + 0x00)
+#define MANU_INFO_OSC_32K               (NVR4_BASE + 0x2C)
+
+#endif /* RSL10_MAP_NVR_H */
@@ -0,0 +1,82 @@
+/* ----------------------------------------------------------------------------
+ * rsl10_profiles.h (host shim)
+ * - Minimal stand-in for the profile API of the RSL10 SDK, limited to the
+ *   battery service server (BASS) used by the application: database
+ *   configuration, messages and environment. The profile task is simulated
+ *   by tools/wake_sim.c.
+ * ------------------------------------------------------------------------- */
+
+#ifndef RSL10_PROFILES_H
+#define RSL10_PROFILES_H
+
+#include <stdint.h>
+#include <rsl10_ble.h>
+
+/* ----------------------------------------------------------------------------
+ * Battery service server (BASS)
+ * ------------------------------------------------------------------------- */
+#define BASS_NB_BAS_INSTANCES_MAX       2
+
+/* Features of a battery service instance */
+enum bass_features
+{
+    BAS_BATT_LVL_NTF_NOT_SUP = 0,
+    BAS_BATT_LVL_NTF_SUP = 1
+};
+
+enum bass_msg_id
+{
+    BASS_ENABLE_REQ = TASK_FIRST_MSG(TASK_ID_BASS),
+    BASS_ENABLE_RSP,
+    BASS_BATT_LEVEL_UPD_REQ,
+    BASS_BATT_LEVEL_UPD_RSP,
+    BASS_BATT_LEVEL_NTF_CFG_IND
+};
+
+struct bass_db_cfg
+{
+    uint8_t bas_nb;
+    uint8_t features[BASS_NB_BAS_INSTANCES_MAX];
+    struct prf_char_pres_fmt batt_level_pres_format[BASS_NB_BAS_INSTANCES_MAX];
+};
+
+struct bass_enable_req
+{
+    uint8_t conidx;
+    uint8_t ntf_cfg;
+    uint8_t old_batt_lvl[BASS_NB_BAS_INSTANCES_MAX];
+};
+
+struct bass_enable_rsp
+{
+    uint8_t conidx;
+    uint8_t status;
+};
+
+struct bass_batt_level_upd_req
+{
+    uint8_t bas_instance;
+    uint8_t batt_level;
+};
+
+struct bass_batt_level_upd_rsp
+{
+    uint8_t status;
+};
+
+struct bass_batt_level_ntf_cfg_ind
+{
+    uint8_t conidx;
+    uint8_t ntf_cfg;
+};
+
+/* Environment of the profile task (PRF_ENV_GET(BASS, bass)) */
+struct bass_env_tag
+{
+    prf_env_t prf_env;
+    uint16_t start_hdl;
+    uint8_t svc_nb;
+    uint8_t features[BASS_NB_BAS_INSTANCES_MAX];
+};
+
+#endif /* RSL10_PROFILES_H */
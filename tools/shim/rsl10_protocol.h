@@ -0,0 +1,12 @@
+/* ----------------------------------------------------------------------------
+ * rsl10_protocol.h (host shim)
+ * - Stand-in for the protocol header of the RSL10 SDK; the application uses
+ *   none of its definitions beyond those of rsl10_ble.h
+ * ------------------------------------------------------------------------- */
+
+#ifndef RSL10_PROTOCOL_H
+#define RSL10_PROTOCOL_H
+
+#include <rsl10_ble.h>
+
+#endif /* RSL10_PROTOCOL_H */
@@ -0,0 +1,446 @@
+/* ----------------------------------------------------------------------------
+ * sim_i2c.c
+ * - Host model of the I2C interface, of its DMA channel and of an
+ *   NCT375-like slave, see sim_i2c.h
+ * ------------------------------------------------------------------------- */
+
+#include <string.h>
+#include "sim_i2c.h"
+
+/* I2C->DATA content when no byte has been received or written */
+#define SIM_DATA_NONE                   0xFFFFFFFF
+
+/* Bus phases */
+#define SIM_PHASE_IDLE                  0
+#define SIM_PHASE_WRITE                 1
+#define SIM_PHASE_READ                  2
+#define SIM_PHASE_READ_LAST             3
+
+#define SIM_STOP                        (1U << I2C_STATUS_STOP_DETECT_Pos)
+#define SIM_BUS_ERROR                   (1U << I2C_STATUS_BUS_ERROR_Pos)
+
+/* Registers of the interface */
+struct sim_i2c_tag sim_i2c;
+struct sim_i2c_ctrl1_tag sim_i2c_ctrl1;
+
+struct sim_slave_tag sim_slave;
+const char *sim_test;
+uint32_t sim_checks;
+bool sim_dma_mode;
+uint32_t sim_dma_xfers;
+uint32_t sim_recoveries;
+uint32_t sim_bytes;
+uint32_t sim_irqs;
+uint32_t sim_dma_irqs;
+uint64_t sim_isr_ticks;
+uint64_t sim_ticks_overhead;
+
+static uint8_t sim_phase;
+static bool sim_acked;
+
+/* Pending interrupt of the interface */
+static bool sim_irq_pending;
+static uint32_t sim_irq_status;
+static uint32_t sim_irq_data;
+
+/* DMA channel of the interface: channel enabled, direction, transfer
+ * length, counter interrupt and status */
+static bool sim_dma_enabled;
+static bool sim_dma_rx;
+static uint32_t sim_dma_cfg;
+static uint32_t sim_dma_length;
+static uint32_t sim_dma_counter;
+static uint32_t sim_dma_status;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Raise(uint32_t status, uint32_t data)
+ * ----------------------------------------------------------------------------
+ * Description   : Raise the interrupt of the interface
+ * Inputs        : - status     - I2C->STATUS while the interrupt is handled
+ *                 - data       - I2C->DATA (received byte)
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Raise(uint32_t status, uint32_t data)
+{
+    SIM_CHECK(!sim_irq_pending, "interrupt raised while one is pending");
+    sim_irq_pending = true;
+    sim_irq_status = status;
+    sim_irq_data = data;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Address(uint32_t address, uint32_t rw)
+ * ----------------------------------------------------------------------------
+ * Description   : Address phase of a write or read sequence
+ * Inputs        : - address    - Slave address sent by the master
+ *                 - rw         - I2C_IS_WRITE or I2C_IS_READ
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Address(uint32_t address, uint32_t rw)
+{
+    bool ack = (address == SIM_ADDRESS);
+
+    sim_slave.starts++;
+    sim_slave.index = 0;
+    sim_bytes++;
+    sim_acked = false;
+    I2C->DATA = SIM_DATA_NONE;
+    sim_phase = (rw == I2C_IS_WRITE) ? SIM_PHASE_WRITE : SIM_PHASE_READ;
+
+    if (sim_slave.stall > 0)
+    {
+        sim_slave.stall--;
+        sim_phase = SIM_PHASE_IDLE;
+        return;
+    }
+    if (sim_slave.bus_error > 0)
+    {
+        sim_slave.bus_error--;
+        Sim_Raise(rw | SIM_BUS_ERROR, SIM_DATA_NONE);
+        return;
+    }
+    if (ack && sim_slave.nack_address > 0)
+    {
+        sim_slave.nack_address--;
+        ack = false;
+    }
+
+    /* With DMA transfers, the address acknowledge raises no interrupt */
+    if (!ack || !sim_dma_mode)
+    {
+        Sim_Raise(rw | (ack ? I2C_HAS_ACK : I2C_HAS_NACK), SIM_DATA_NONE);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Sim_Slave_Write(uint32_t byte)
+ * ----------------------------------------------------------------------------
+ * Description   : Byte received by the slave: register pointer, then
+ *                 register content
+ * Inputs        : - byte       - Byte written by the master
+ * Outputs       : return value - false if the slave does not acknowledge
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Sim_Slave_Write(uint32_t byte)
+{
+    if (sim_slave.nack_data > 0)
+    {
+        sim_slave.nack_data--;
+        return false;
+    }
+    if (sim_slave.index == 0)
+    {
+        sim_slave.pointer = byte & 0x07;
+    }
+    else if (sim_slave.index <= 2)
+    {
+        sim_slave.reg[sim_slave.pointer][sim_slave.index - 1] = byte;
+        if (sim_slave.index == 1 && sim_slave.pointer == SIM_REG_ONE_SHOT)
+        {
+            sim_slave.one_shots++;
+        }
+    }
+    sim_slave.index++;
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint8_t Sim_Slave_Read(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Byte sent by the slave: next byte of the register
+ * Inputs        : None
+ * Outputs       : return value - Byte read by the master
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint8_t Sim_Slave_Read(void)
+{
+    return sim_slave.reg[sim_slave.pointer][sim_slave.index++ % 2];
+}
+
+void Sys_I2C_StartWrite(uint32_t address)
+{
+    Sim_Address(address, I2C_IS_WRITE);
+}
+
+void Sys_I2C_StartRead(uint32_t address)
+{
+    Sim_Address(address, I2C_IS_READ);
+}
+
+void Sys_I2C_Reset(void)
+{
+    sim_phase = SIM_PHASE_IDLE;
+    sim_irq_pending = false;
+    sim_acked = false;
+    I2C->DATA = SIM_DATA_NONE;
+    I2C_CTRL1->LAST_DATA_ALIAS = 0;
+}
+
+void Sys_I2C_ACK(void)
+{
+    sim_acked = true;
+}
+
+void Sys_I2C_NackAndStop(void)
+{
+    sim_phase = SIM_PHASE_IDLE;
+}
+
+uint32_t Sys_I2C_Get_Status(void)
+{
+    return I2C->STATUS;
+}
+
+void Sys_I2C_Config(uint32_t config)
+{
+    I2C->CTRL0 = config;
+    sim_dma_mode = ((config & I2C_CONTROLLER_DMA) != 0);
+}
+
+void Sys_I2C_DIOConfig(uint32_t config, uint32_t scl, uint32_t sda)
+{
+    DIO->CFG[scl] = config;
+    DIO->CFG[sda] = config;
+    sim_recoveries++;
+}
+
+void Sys_DIO_Config(uint32_t dio, uint32_t config)
+{
+    DIO->CFG[dio] = config;
+}
+
+void Sys_DMA_ChannelConfig(uint32_t num, uint32_t cfg, uint32_t transfer_length,
+                           uint32_t counter_int, uint32_t src_addr,
+                           uint32_t dest_addr)
+{
+    /* The addresses are truncated to 32 bits on the host: the buffers of the
+     * transaction in progress (i2c_env) are used instead */
+    (void)num;
+    (void)src_addr;
+    (void)dest_addr;
+    sim_dma_enabled = true;
+    sim_dma_rx = ((cfg & DMA_TRANSFER_P_TO_M) != 0);
+    sim_dma_cfg = cfg;
+    sim_dma_length = transfer_length;
+    sim_dma_counter = counter_int;
+    sim_dma_status = 0;
+}
+
+void Sys_DMA_ChannelDisable(uint32_t num)
+{
+    (void)num;
+    sim_dma_enabled = false;
+}
+
+void Sys_DMA_ClearChannelStatus(uint32_t num)
+{
+    (void)num;
+    sim_dma_status = 0;
+}
+
+uint32_t Sys_DMA_Get_ChannelStatus(uint32_t num)
+{
+    (void)num;
+    return sim_dma_status;
+}
+
+#if (I2C_DMA_ENABLE)
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_DMA_IRQ(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Interrupt of the DMA channel
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_DMA_IRQ(void)
+{
+    uint64_t start = SIM_TICKS();
+
+    I2C_DMA_IRQHandler();
+    sim_isr_ticks += SIM_TICKS() - start - sim_ticks_overhead;
+    sim_dma_irqs++;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Dma(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Transfer of a write or read sequence by the DMA channel.
+ *                 The complete (write) or counter (read) interrupt of the
+ *                 channel has to set the last data flag before the last
+ *                 byte; the sequence ends with the stop interrupt, or with a
+ *                 NACK interrupt if a written byte is not acknowledged.
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The address has been acknowledged
+ * ------------------------------------------------------------------------- */
+static void Sim_Dma(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < sim_dma_length; i++)
+    {
+        if (!sim_dma_rx && i == sim_dma_length - 1 &&
+            (sim_dma_cfg & DMA_COMPLETE_INT_ENABLE))
+        {
+            sim_dma_status |= DMA_COMPLETE_INT_STATUS;
+            Sim_DMA_IRQ();
+        }
+        else if (sim_dma_rx && i == sim_dma_counter && i > 0 &&
+                 (sim_dma_cfg & DMA_COUNTER_INT_ENABLE))
+        {
+            sim_dma_status |= DMA_COUNTER_INT_STATUS;
+            Sim_DMA_IRQ();
+        }
+        if (i == sim_dma_length - 1)
+        {
+            SIM_CHECK(I2C_CTRL1->LAST_DATA_ALIAS != 0, "last data flag set "
+                      "before the last byte");
+        }
+
+        sim_bytes++;
+        if (sim_dma_rx)
+        {
+            i2c_env.rx_buffer[i] = Sim_Slave_Read();
+        }
+        else if (!Sim_Slave_Write(i2c_env.tx_buffer[i]))
+        {
+            sim_dma_enabled = false;
+            Sim_Raise(I2C_IS_WRITE | I2C_HAS_NACK, SIM_DATA_NONE);
+            return;
+        }
+    }
+
+    /* Stop condition; the last byte read is not acknowledged by the master
+     * and has been emptied from the buffer by the channel */
+    sim_dma_enabled = false;
+    sim_dma_xfers++;
+    sim_phase = SIM_PHASE_IDLE;
+    I2C_CTRL1->LAST_DATA_ALIAS = 0;
+    Sim_Raise((sim_dma_rx ? (I2C_IS_READ | I2C_HAS_NACK) :
+               (I2C_IS_WRITE | I2C_HAS_ACK)) | SIM_STOP, SIM_DATA_NONE);
+}
+#endif
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Bus(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Advance the bus after the interrupt handler: transmit the
+ *                 byte written to I2C->DATA, receive the next byte once
+ *                 acknowledged, or generate the stop condition after the last
+ *                 byte received
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Bus(void)
+{
+    uint32_t byte;
+    bool last = (I2C_CTRL1->LAST_DATA_ALIAS != 0);
+
+    if (sim_dma_mode)
+    {
+        return;
+    }
+
+    if (sim_phase == SIM_PHASE_WRITE && I2C->DATA != SIM_DATA_NONE)
+    {
+        byte = I2C->DATA & 0xFF;
+        I2C->DATA = SIM_DATA_NONE;
+        sim_bytes++;
+        if (!Sim_Slave_Write(byte))
+        {
+            Sim_Raise(I2C_IS_WRITE | I2C_HAS_NACK, SIM_DATA_NONE);
+            return;
+        }
+
+        /* Stop condition after the last byte */
+        if (last)
+        {
+            I2C_CTRL1->LAST_DATA_ALIAS = 0;
+            Sim_Raise(I2C_IS_WRITE | I2C_HAS_ACK | SIM_STOP, SIM_DATA_NONE);
+        }
+        else
+        {
+            Sim_Raise(I2C_IS_WRITE | I2C_HAS_ACK, SIM_DATA_NONE);
+        }
+    }
+    else if (sim_phase == SIM_PHASE_READ && sim_acked)
+    {
+        sim_acked = false;
+        byte = Sim_Slave_Read();
+        sim_bytes++;
+
+        /* The master does not acknowledge the last byte */
+        if (last)
+        {
+            I2C_CTRL1->LAST_DATA_ALIAS = 0;
+            sim_phase = SIM_PHASE_READ_LAST;
+            Sim_Raise(I2C_IS_READ | I2C_BUFFER_FULL | I2C_HAS_NACK, byte);
+        }
+        else
+        {
+            Sim_Raise(I2C_IS_READ | I2C_BUFFER_FULL | I2C_HAS_ACK, byte);
+        }
+    }
+    else if (sim_phase == SIM_PHASE_READ_LAST && !sim_irq_pending)
+    {
+        sim_phase = SIM_PHASE_IDLE;
+        Sim_Raise(I2C_IS_READ | I2C_HAS_NACK | SIM_STOP, SIM_DATA_NONE);
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool Sim_I2C_Pending(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Check for a pending interrupt of the interface or a DMA
+ *                 transfer ready to move its bytes
+ * Inputs        : None
+ * Outputs       : return value - true if Sim_I2C_Step has work to do
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+bool Sim_I2C_Pending(void)
+{
+    return sim_irq_pending || (I2C_DMA_ENABLE && sim_dma_mode &&
+                               sim_dma_enabled &&
+                               sim_phase != SIM_PHASE_IDLE);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : bool Sim_I2C_Step(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Handle the pending interrupt of the interface and advance
+ *                 the bus, or move the bytes of the DMA transfer
+ * Inputs        : None
+ * Outputs       : return value - false if nothing was pending
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+bool Sim_I2C_Step(void)
+{
+    uint64_t start;
+
+    if (sim_irq_pending)
+    {
+        sim_irq_pending = false;
+        I2C->STATUS = sim_irq_status;
+        I2C->DATA = sim_irq_data;
+        start = SIM_TICKS();
+        I2C_IRQHandler();
+        sim_isr_ticks += SIM_TICKS() - start - sim_ticks_overhead;
+        sim_irqs++;
+        Sim_Bus();
+        return true;
+    }
+#if (I2C_DMA_ENABLE)
+    if (sim_dma_mode && sim_dma_enabled && sim_phase != SIM_PHASE_IDLE)
+    {
+        Sim_Dma();
+        return true;
+    }
+#endif
+
+    return false;
+}
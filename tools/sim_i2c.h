@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * sim_i2c.h
+ * - Host model of the I2C interface, of its DMA channel and of an
+ *   NCT375-like slave, behind the Sys_I2C_*, Sys_DMA_* and Sys_DIO_*
+ *   functions of tools/shim/rsl10.h (tools/sim_i2c.c). Shared by the I2C
+ *   library test (tools/i2c_sim.c) and the wake cycle simulator
+ *   (tools/wake_sim.c). The interrupts of the interface are raised one at a
+ *   time; Sim_I2C_Step calls I2C_IRQHandler for the pending one, or moves
+ *   the bytes of a DMA transfer.
+ * ------------------------------------------------------------------------- */
+
+#ifndef SIM_I2C_H
+#define SIM_I2C_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <i2c.h>
+
+/* Host time base of the benchmarks: time stamp counter, or ns */
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SIM_TICKS()                     __rdtsc()
+#define SIM_TICKS_UNIT                  "TSC ticks"
+#else
+#include <time.h>
+static inline uint64_t Sim_Ticks(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#define SIM_TICKS()                     Sim_Ticks()
+#define SIM_TICKS_UNIT                  "ns"
+#endif
+
+#define SIM_ADDRESS                     0x48
+
+/* One-shot register of the slave */
+#define SIM_REG_ONE_SHOT                4
+
+#define SIM_CHECK(cond, msg)                                                  \
+    do                                                                        \
+    {                                                                         \
+        if (!(cond))                                                          \
+        {                                                                     \
+            printf("FAIL: %s: %s (line %d)\n", sim_test, msg, __LINE__);      \
+            exit(1);                                                          \
+        }                                                                     \
+        sim_checks++;                                                         \
+    } while (0)
+
+/* NCT375-like slave: the first byte written sets the register pointer, the
+ * next ones are written to the register; reads return the register */
+struct sim_slave_tag
+{
+    uint8_t reg[8][2];
+    uint8_t pointer;
+    uint8_t index;
+
+    /* Faults to inject: number of address phases not acknowledged, of data
+     * bytes not acknowledged, of address phases with a bus error and of
+     * address phases without any response (stalled bus) */
+    uint8_t nack_address;
+    uint8_t nack_data;
+    uint8_t bus_error;
+    uint8_t stall;
+
+    /* Number of address phases, and of writes to the one-shot register */
+    uint32_t starts;
+    uint32_t one_shots;
+};
+
+extern struct sim_slave_tag sim_slave;
+
+/* Name of the test in progress and number of checks passed (SIM_CHECK) */
+extern const char *sim_test;
+extern uint32_t sim_checks;
+
+/* Interface configured for DMA transfers; DMA transfers completed; bus
+ * recoveries (Sys_I2C_DIOConfig calls); bytes clocked on the bus,
+ * address bytes included */
+extern bool sim_dma_mode;
+extern uint32_t sim_dma_xfers;
+extern uint32_t sim_recoveries;
+extern uint32_t sim_bytes;
+
+/* Interrupts of the interface and of the DMA channel, and host time spent
+ * in the interrupt handlers (less the cost of reading the time base) */
+extern uint32_t sim_irqs;
+extern uint32_t sim_dma_irqs;
+extern uint64_t sim_isr_ticks;
+extern uint64_t sim_ticks_overhead;
+
+/* true if an interrupt of the interface is pending or a DMA transfer is
+ * ready to move its bytes */
+bool Sim_I2C_Pending(void);
+
+/* Handle the pending interrupt of the interface, then advance the bus, or
+ * move the bytes of the DMA transfer; false if nothing was pending */
+bool Sim_I2C_Step(void);
+
+#endif /* SIM_I2C_H */
@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------------
+ * tlm_layout_test.c
+ * - Host test of the Eddystone TLM advertising data (code/
+ *   eddystone_tlm_frame.c), byte by byte against the frame layout of the
+ *   Eddystone TLM specification:
+ *     0..3    service list AD structure (16-bit UUID 0xFEAA)
+ *     4..7    service data AD structure header (length 17, UUID 0xFEAA)
+ *     8, 9    frame type 0x20 (TLM), version 0x00
+ *     10..11  VBATT, battery voltage in mV, big-endian
+ *     12..13  TEMP, signed 8.8 fixed-point degrees Celsius, big-endian
+ *     14..17  ADV_CNT, advertising PDU count, big-endian
+ *     18..21  SEC_CNT, time since power-up in 0.1 s, big-endian
+ *   The reference frames are written out independently of the offsets of
+ *   include/eddystone_tlm.h.
+ *
+ *   Build and run on the host (tools/shim/rsl10.h stands in for the SDK):
+ *     cc -Wall -Itools/shim -o tlm_layout_test tools/tlm_layout_test.c \
+ *        code/eddystone_tlm_frame.c
+ *     ./tlm_layout_test
+ * ------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "../include/eddystone_tlm.h"
+
+/* Frame fields encoded, and expected advertising data */
+struct test_frame
+{
+    uint16_t vbatt_mv;
+    uint16_t temp;
+    uint32_t adv_cnt;
+    uint32_t sec_cnt;
+    uint8_t adv_data[22];
+};
+
+#define TEST_HEADER                     0x03, 0x03, 0xAA, 0xFE, \
+                                        0x11, 0x16, 0xAA, 0xFE, \
+                                        0x20, 0x00
+
+static const struct test_frame test_frames[] =
+{
+    /* Template, temperature not supported */
+    { 0, 0x8000, 0, 0,
+      { TEST_HEADER, 0x00, 0x00, 0x80, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+
+    /* 3000 mV, 25.5 C, distinct bytes in every counter */
+    { 3000, 0x1980, 0x01020304, 0xA1B2C3D4,
+      { TEST_HEADER, 0x0B, 0xB8, 0x19, 0x80,
+        0x01, 0x02, 0x03, 0x04, 0xA1, 0xB2, 0xC3, 0xD4 } },
+
+    /* -1.5 C; every field shrinks, no stale byte may remain */
+    { 2100, 0xFE80, 0x000000FF, 0x00000100,
+      { TEST_HEADER, 0x08, 0x34, 0xFE, 0x80,
+        0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x01, 0x00 } },
+
+    /* All ones */
+    { 0xFFFF, 0xFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+      { TEST_HEADER, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } },
+};
+
+#define TEST_FRAMES                     (sizeof(test_frames) / \
+                                         sizeof(test_frames[0]))
+
+/* ----------------------------------------------------------------------------
+ * Function      : static bool Test_Compare(const char *name,
+ *                                          const uint8_t *expected)
+ * ----------------------------------------------------------------------------
+ * Description   : Compare the advertising data to the expected frame
+ * Inputs        : - name       - Name of the frame, for the report
+ *                 - expected   - Expected advertising data
+ * Outputs       : return value - false on the first mismatch
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static bool Test_Compare(const char *name, const uint8_t *expected)
+{
+    uint8_t i;
+
+    for (i = 0; i < EDDYSTONE_TLM_ADV_DATA_LEN; i++)
+    {
+        if (eddystone_tlm.adv_data[i] != expected[i])
+        {
+            printf("FAIL: %s: byte %u is 0x%02X, expected 0x%02X\n", name, i,
+                   eddystone_tlm.adv_data[i], expected[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(void)
+{
+    char name[32];
+    uint8_t i;
+
+    /* The AD structures fill the advertising data exactly */
+    if (EDDYSTONE_TLM_ADV_DATA_LEN != sizeof(test_frames[0].adv_data))
+    {
+        printf("FAIL: advertising data length %u, expected %u\n",
+               EDDYSTONE_TLM_ADV_DATA_LEN,
+               (unsigned)sizeof(test_frames[0].adv_data));
+        return 1;
+    }
+
+    /* Template, before the first update */
+    if (!Test_Compare("template", test_frames[0].adv_data))
+    {
+        return 1;
+    }
+
+    /* Each frame is patched over the previous one */
+    for (i = 0; i < TEST_FRAMES; i++)
+    {
+        snprintf(name, sizeof(name), "frame %u", i);
+        Eddystone_TLM_Encode(test_frames[i].vbatt_mv, test_frames[i].temp,
+                             test_frames[i].adv_cnt, test_frames[i].sec_cnt);
+        if (!Test_Compare(name, test_frames[i].adv_data))
+        {
+            return 1;
+        }
+    }
+
+    printf("%u frames: VBATT@10, TEMP@12, ADV_CNT@14, SEC_CNT@18, "
+           "big-endian\n", (unsigned)(TEST_FRAMES + 1));
+
+    return 0;
+}
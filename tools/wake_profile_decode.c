@@ -0,0 +1,182 @@
+/* ----------------------------------------------------------------------------
+ * wake_profile_decode.c
+ * - Host decoder of the wake-window profiler (include/wake_profile.h). The
+ *   input is an image of wake_profile read back from the target with the
+ *   debugger, e.g. with GDB:
+ *     dump binary memory wake_profile.bin &wake_profile (&wake_profile)+1
+ *   The image is decoded with the target layout (little-endian, 32-bit
+ *   fields, 64-bit sums aligned to 8 bytes), independently of the host
+ *   struct layout:
+ *     0       magic, head, last, wakes
+ *     16      sum[WAKE_PHASE_NB]         uint64_t
+ *             max[WAKE_PHASE_NB]         uint32_t
+ *             overlapped                 uint32_t
+ *             ring[WAKE_PROFILE_RECORDS] wake_id, cycles[WAKE_PHASE_NB]
+ *   Printed: the per-phase breakdown over all completed wake cycles (mean
+ *   and maximum cycles, share of the mean wake cycle, mean time at the
+ *   SYSCLK frequency) and the records of the ring, oldest first.
+ *
+ *   Build and run on the host (tools/shim/rsl10.h stands in for the SDK):
+ *     cc -Wall -Itools/shim -o wake_profile_decode tools/wake_profile_decode.c
+ *     ./wake_profile_decode wake_profile.bin [<sysclk_mhz>]
+ *
+ *   sysclk_mhz   - SYSCLK frequency in MHz (default 8)
+ * ------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../include/wake_profile.h"
+
+/* Offsets and size of the image */
+#define IMG_SUM                         16
+#define IMG_MAX                         (IMG_SUM + 8 * WAKE_PHASE_NB)
+#define IMG_OVERLAPPED                  (IMG_MAX + 4 * WAKE_PHASE_NB)
+#define IMG_RING                        (IMG_OVERLAPPED + 4)
+#define IMG_RECORD                      (4 * (1 + WAKE_PHASE_NB))
+#define IMG_SIZE                        (IMG_RING + IMG_RECORD * \
+                                         WAKE_PROFILE_RECORDS)
+
+/* Phase names, in the order of enum wake_phase */
+static const char *const phase_names[] =
+{
+    "wakeup",
+    "ble_wait",
+    "periph",
+    "jobs_start",
+    "jobs_async",
+    "jobs_sync",
+    "schedule"
+};
+
+_Static_assert(sizeof(phase_names) / sizeof(phase_names[0]) == WAKE_PHASE_NB,
+               "phase_names does not match enum wake_phase");
+
+static uint8_t img[IMG_SIZE];
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint32_t Img_U32(uint32_t offset)
+ * ----------------------------------------------------------------------------
+ * Description   : Read a little-endian 32-bit field of the image
+ * Inputs        : - offset     - Offset of the field
+ * Outputs       : return value - Field value
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint32_t Img_U32(uint32_t offset)
+{
+    return (uint32_t)img[offset] | (uint32_t)img[offset + 1] << 8 |
+           (uint32_t)img[offset + 2] << 16 | (uint32_t)img[offset + 3] << 24;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint64_t Img_U64(uint32_t offset)
+ * ----------------------------------------------------------------------------
+ * Description   : Read a little-endian 64-bit field of the image
+ * Inputs        : - offset     - Offset of the field
+ * Outputs       : return value - Field value
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint64_t Img_U64(uint32_t offset)
+{
+    return (uint64_t)Img_U32(offset) | (uint64_t)Img_U32(offset + 4) << 32;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *file;
+    size_t length;
+    double mhz = 8.0;
+    double mean[WAKE_PHASE_NB];
+    double total = 0;
+    uint32_t head;
+    uint32_t wakes;
+    uint32_t record;
+    uint32_t offset;
+    uint8_t i;
+    uint8_t n;
+
+    if (argc < 2)
+    {
+        printf("usage: %s <image> [<sysclk_mhz>]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 2)
+    {
+        mhz = atof(argv[2]);
+    }
+
+    file = fopen(argv[1], "rb");
+    if (file == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    length = fread(img, 1, sizeof(img), file);
+    fclose(file);
+    if (length < IMG_SIZE)
+    {
+        printf("%s: %u bytes, a wake_profile image is %u bytes\n", argv[1],
+               (unsigned)length, (unsigned)IMG_SIZE);
+        return 1;
+    }
+
+    if (Img_U32(0) != WAKE_PROFILE_MAGIC)
+    {
+        printf("%s: magic 0x%08X, expected 0x%08X (profiler disabled, not "
+               "initialized or other layout)\n", argv[1], Img_U32(0),
+               WAKE_PROFILE_MAGIC);
+        return 1;
+    }
+    head = Img_U32(4);
+    wakes = Img_U32(12);
+    if (head >= WAKE_PROFILE_RECORDS)
+    {
+        printf("%s: ring index %u out of range\n", argv[1], head);
+        return 1;
+    }
+
+    /* Per-phase breakdown */
+    printf("%u wake cycles, %u with the asynchronous jobs overlapped\n",
+           wakes, Img_U32(IMG_OVERLAPPED));
+    if (wakes > 0)
+    {
+        for (i = 0; i < WAKE_PHASE_NB; i++)
+        {
+            mean[i] = (double)Img_U64(IMG_SUM + 8 * i) / wakes;
+            total += mean[i];
+        }
+
+        printf("%-12s %12s %12s %7s %10s\n", "phase", "mean cycles",
+               "max cycles", "share", "mean us");
+        for (i = 0; i < WAKE_PHASE_NB; i++)
+        {
+            printf("%-12s %12.1f %12u %6.1f%% %10.1f\n", phase_names[i],
+                   mean[i], Img_U32(IMG_MAX + 4 * i),
+                   (total > 0) ? 100.0 * mean[i] / total : 0.0,
+                   mean[i] / mhz);
+        }
+        printf("%-12s %12.1f %12s %6.1f%% %10.1f\n", "total", total, "",
+               100.0, total / mhz);
+    }
+
+    /* Ring, oldest record first; the record at head is being filled */
+    printf("\n%-10s", "wake_id");
+    for (i = 0; i < WAKE_PHASE_NB; i++)
+    {
+        printf(" %10s", phase_names[i]);
+    }
+    printf("\n");
+    for (n = 1; n <= WAKE_PROFILE_RECORDS; n++)
+    {
+        record = (head + n) % WAKE_PROFILE_RECORDS;
+        offset = IMG_RING + IMG_RECORD * record;
+        printf("%-10u", Img_U32(offset));
+        for (i = 0; i < WAKE_PHASE_NB; i++)
+        {
+            printf(" %10u", Img_U32(offset + 4 + 4 * i));
+        }
+        printf("%s\n", (record == head) ? "  (current)" : "");
+    }
+
+    return 0;
+}
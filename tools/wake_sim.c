@@ -0,0 +1,1190 @@
+/* ----------------------------------------------------------------------------
+ * wake_sim.c
+ * - Host simulation of the wake cycles of the application: app.c and all
+ *   the modules of code/ (except the flash port) are built against the host
+ *   shim of the SDK (tools/shim) and run on a simulated clock. The
+ *   simulation provides:
+ *     - the clock: microseconds since reset, the RTC counter (32768 Hz) of
+ *       App_Jobs_Elapsed and the busy waits of Sys_Delay_ProgramROM;
+ *     - the I2C interface, its DMA channel and the NCT375 (tools/sim_i2c.c),
+ *       with 9 SCL periods per byte at the speed of I2C->CTRL0 and a
+ *       one-shot conversion completing SIM_NCT375_CONV_US after its
+ *       trigger (temperature ramp);
+ *     - the ADC: one VBAT/2 sample (SIM_VBAT_MV) per prescaled SLOWCLK
+ *       period while its interrupt is enabled;
+ *     - the kernel: message queue, dispatch to the handler table of the
+ *       application task and a stack answering the GAPM and GATTM commands
+ *       of the application; the advertising data update is recorded and
+ *       checked against the advertising event it was made for;
+ *     - the baseband: wake-up the TWOSC parameter (BLE_LLD_Sleep_Params_Set)
+ *       before each advertising event, awake TWOSC after the wake-up, and
+ *       sleep (BLE_Power_Mode_Enter) as soon as no message is pending;
+ *     - the flash of the key/value store, in RAM (SIM_FLASH_*_US per
+ *       operation).
+ *   SYS_WAIT_FOR_INTERRUPT advances the clock to the next event (end of the
+ *   bytes clocked on the bus, ADC sample, baseband awake) and calls its
+ *   interrupt handler. The CPU time of the code is not simulated: a wake
+ *   window lasts as long as its waits.
+ * - Each wake cycle runs Wakeup_From_Sleep_Application, Continue_Application
+ *   and Main_Loop until the sleep request. The work of the window (simulated
+ *   duration, interrupts, I2C address phases and bytes, ADC samples, kernel
+ *   messages, advertising data updates, flash operations) is reported per
+ *   set of periodic jobs run, with the number of wake cycles simulated per
+ *   second of host time.
+ * - Checks at each wake cycle: one advertising data update, ADV_CNT
+ *   incremented by one, TEMP equal to the last conversion of the slave once
+ *   read, VBATT equal to SIM_VBAT_MV once measured, no I2C error, and the
+ *   late commits counted by the application (app_jobs_stats.late) equal to
+ *   the updates made after their advertising event.
+ *
+ *   Build and run on the host (tools/shim stands in for the SDK):
+ *     cc -Wall -O2 -Wno-pointer-to-int-cast -Wno-unused-parameter \
+ *        -Dmain=App_Main -Itools/shim -Iinclude -include rsl10.h \
+ *        -Wno-return-type -Wno-type-limits -o wake_sim tools/wake_sim.c \
+ *        tools/sim_i2c.c app.c $(ls code/[!f]*.c code/flash_kv.c)
+ *     ./wake_sim [<wakes>]
+ *
+ *   wakes - Number of wake cycles (default 10000)
+ * ------------------------------------------------------------------------- */
+
+#include <setjmp.h>
+#include <time.h>
+#include <app.h>
+#include "sim_i2c.h"
+
+/* The application entry point is renamed App_Main by the build */
+#undef main
+extern int App_Main(void);
+
+/* Battery voltage seen by the ADC, in mV, and corresponding ADC sample:
+ * VBATT = 2 * sample * 2000 / 16384 (Measure_Battery_Level,
+ * Advertising_Data_Encode) */
+#define SIM_VBAT_MV                     3000
+#define SIM_VBAT_SAMPLE                 (SIM_VBAT_MV * 16384 / 4000)
+
+/* NCT375 one-shot conversion time, and first temperature and step of the
+ * ramp of conversions, in 1/16 C */
+#define SIM_NCT375_CONV_US              30000
+#define SIM_TEMP_START                  (25 * 16)
+#define SIM_TEMP_STEP                   3
+#define SIM_TEMP_RANGE                  (40 * 16)
+
+/* Assumed duration of a word pair program and of a page erase */
+#define SIM_FLASH_WRITE_US              50
+#define SIM_FLASH_ERASE_US              20000
+
+/* Consecutive sleep requests refused before the simulation stops */
+#define SIM_REFUSALS_MAX                1000
+
+/* Messages dispatched by one Kernel_Schedule call before the simulation
+ * stops */
+#define SIM_DISPATCH_MAX                1000
+
+/* Event sources of SYS_WAIT_FOR_INTERRUPT */
+#define SIM_EVENT_NONE                  0
+#define SIM_EVENT_I2C                   1
+#define SIM_EVENT_ADC                   2
+#define SIM_EVENT_BLE                   3
+#define SIM_EVENT_SYSTICK               4
+
+/* Counters of the work of a wake window */
+enum sim_count
+{
+    SIM_CNT_I2C_IRQ,
+    SIM_CNT_DMA_IRQ,
+    SIM_CNT_ADC_IRQ,
+    SIM_CNT_TIMEOUT,
+    SIM_CNT_I2C_START,
+    SIM_CNT_I2C_BYTE,
+    SIM_CNT_MSG,
+    SIM_CNT_UPDATE,
+    SIM_CNT_LATE,
+    SIM_CNT_FLASH_WRITE,
+    SIM_CNT_FLASH_ERASE,
+    SIM_CNT_NB
+};
+
+static const char *const sim_count_name[SIM_CNT_NB] =
+{
+    "i2c", "dma", "adc", "tmo", "adr", "bytes", "msgs", "upd", "late",
+    "fl_wr", "fl_er"
+};
+
+/* Windows with the same set of periodic jobs */
+struct sim_window_tag
+{
+    uint32_t wakes;
+    uint64_t time_sum;
+    uint32_t time_max;
+    uint64_t count[SIM_CNT_NB];
+};
+
+/* Kernel message: header followed by the parameters */
+struct sim_msg
+{
+    struct sim_msg *next;
+    ke_msg_id_t id;
+    ke_task_id_t dest_id;
+    ke_task_id_t src_id;
+    uint16_t param_len;
+    uint64_t param[];
+};
+
+/* Advertising of the simulated stack: started, interval, next event and
+ * event the current wake-up is made for (0: none), data of the last
+ * update */
+struct sim_adv_tag
+{
+    bool active;
+    uint8_t operation;
+    uint32_t interval;
+    uint64_t next;
+    uint64_t target;
+    uint32_t events;
+    uint32_t skipped;
+    uint32_t adv_cnt;
+    bool updated;
+};
+
+/* Registers of the shim */
+uint32_t SystemCoreClock = RFCLK_FREQ;
+struct sim_nvic_tag sim_nvic;
+struct sim_systick_tag sim_systick;
+struct sim_core_debug_tag sim_core_debug;
+struct sim_dwt_tag sim_dwt;
+struct sim_acs_vtrim_tag sim_acs_bg_ctrl;
+struct sim_acs_vcc_ctrl_tag sim_acs_vcc_ctrl;
+struct sim_acs_vtrim_tag sim_acs_vddc_ctrl;
+struct sim_acs_vtrim_tag sim_acs_vddm_ctrl;
+struct sim_acs_vddrf_ctrl_tag sim_acs_vddrf_ctrl;
+struct sim_acs_vddpa_ctrl_tag sim_acs_vddpa_ctrl;
+struct sim_acs_vdda_cp_ctrl_tag sim_acs_vdda_cp_ctrl;
+struct sim_acs_rcosc_ctrl_tag sim_acs_rcosc_ctrl;
+struct sim_acs_xtal32k_ctrl_tag sim_acs_xtal32k_ctrl;
+struct sim_acs_rtc_cfg_tag sim_acs_rtc_cfg;
+struct sim_acs_rtc_count_tag sim_acs_rtc_count;
+struct sim_acs_wakeup_ctrl_tag sim_acs_wakeup_ctrl;
+struct sim_acs_wakeup_state_tag sim_acs_wakeup_state;
+struct sim_clk_tag sim_clk;
+struct sim_clk_div_cfg2_tag sim_clk_div_cfg2;
+struct sim_clk_sys_cfg_tag sim_clk_sys_cfg;
+struct sim_rf_tag sim_rf;
+struct sim_rf_reg2f_tag sim_rf_reg2f;
+struct sim_rf_reg39_tag sim_rf_reg39;
+struct sim_sysctrl_rf_power_cfg_tag sim_sysctrl_rf_power_cfg;
+struct sim_sysctrl_rf_access_cfg_tag sim_sysctrl_rf_access_cfg;
+struct sim_bbif_tag sim_bbif;
+struct sim_flash_tag sim_flash;
+struct sim_adc_tag sim_adc;
+struct sim_audiosink_tag sim_audiosink;
+struct sim_audiosink_ctrl_tag sim_audiosink_ctrl;
+struct sim_dio_tag sim_dio;
+struct sim_dio_data_tag sim_dio_data;
+
+/* Default public address of the stack */
+const struct bd_addr co_default_bdaddr = { { 0x01, 0x00, 0x00, 0xCA, 0xEA,
+                                             0x80 } };
+
+/* Clock, in us since reset; end of the bytes clocked on the bus; pending
+ * ADC sample and NCT375 conversion (0: none); baseband awake time */
+static uint64_t sim_now;
+static uint64_t sim_bus_free;
+static uint32_t sim_bus_bytes;
+static uint64_t sim_adc_due;
+static uint64_t sim_conv_due;
+static uint32_t sim_one_shots;
+static uint64_t sim_awake_at;
+static bool sim_in_handler;
+
+/* Temperature of the next conversion (1/16 C) and conversions completed */
+static int16_t sim_temp = SIM_TEMP_START;
+static uint32_t sim_conversions;
+
+/* Interrupt counters not kept by the I2C model */
+static uint32_t sim_adc_irqs;
+static uint32_t sim_timeouts;
+
+/* Kernel: message queue, application task, messages dispatched */
+static struct sim_msg *sim_msg_head;
+static struct sim_msg *sim_msg_tail;
+static const struct ke_task_desc *sim_task_app;
+static ke_state_t sim_task_state[TASK_MAX];
+static uint32_t sim_msgs;
+
+/* Stack: advertising, updates made after their event, TWOSC parameter,
+ * handles, battery profile, updates refused before advertising, sleep
+ * requests refused in a row */
+static struct sim_adv_tag sim_adv;
+static uint32_t sim_late;
+static uint16_t sim_twosc = TWOSC;
+static uint16_t sim_next_hdl = 1;
+static struct bass_env_tag sim_bass_env;
+static uint32_t sim_refused;
+static uint32_t sim_refusals;
+static jmp_buf sim_sleep;
+
+/* Flash of the key/value store */
+static uint8_t sim_kv_flash[FLASH_KV_PAGES * FLASH_KV_PAGE_SIZE];
+static uint32_t sim_flash_writes;
+static uint32_t sim_flash_erases;
+
+/* Wake windows, by set of periodic jobs run, and counters at the start of
+ * the window */
+static struct sim_window_tag sim_window[1U << JOB_SCHEDULE_MAX];
+static uint32_t sim_window_count[SIM_CNT_NB];
+static uint64_t sim_window_start;
+static uint32_t sim_late_start;
+static uint32_t sim_overruns;
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Counters(uint32_t *count)
+ * ----------------------------------------------------------------------------
+ * Description   : Read the counters of the work of the wake windows
+ * Inputs        : - count      - Counters (SIM_CNT_NB)
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Counters(uint32_t *count)
+{
+    count[SIM_CNT_I2C_IRQ] = sim_irqs;
+    count[SIM_CNT_DMA_IRQ] = sim_dma_irqs;
+    count[SIM_CNT_ADC_IRQ] = sim_adc_irqs;
+    count[SIM_CNT_TIMEOUT] = sim_timeouts;
+    count[SIM_CNT_I2C_START] = sim_slave.starts;
+    count[SIM_CNT_I2C_BYTE] = sim_bytes;
+    count[SIM_CNT_MSG] = sim_msgs;
+    count[SIM_CNT_UPDATE] = sim_adv.adv_cnt;
+    count[SIM_CNT_LATE] = sim_late;
+    count[SIM_CNT_FLASH_WRITE] = sim_flash_writes;
+    count[SIM_CNT_FLASH_ERASE] = sim_flash_erases;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Advance(uint64_t time)
+ * ----------------------------------------------------------------------------
+ * Description   : Advance the clock, complete the NCT375 conversion due and
+ *                 update the RTC counter
+ * Inputs        : - time       - New time, in us
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Advance(uint64_t time)
+{
+    uint64_t ticks;
+    uint64_t period;
+    uint16_t reg;
+
+    if (time > sim_now)
+    {
+        sim_now = time;
+    }
+
+    if (sim_conv_due != 0 && sim_conv_due <= sim_now)
+    {
+        /* Temperature register: 12-bit code in D15..D4 */
+        reg = (uint16_t)(sim_temp << 4);
+        sim_slave.reg[0][0] = (uint8_t)(reg >> 8);
+        sim_slave.reg[0][1] = (uint8_t)reg;
+        sim_temp += SIM_TEMP_STEP;
+        if (sim_temp >= SIM_TEMP_START + SIM_TEMP_RANGE)
+        {
+            sim_temp = SIM_TEMP_START;
+        }
+        sim_conv_due = 0;
+        sim_conversions++;
+    }
+
+    /* The RTC counts down from its start value, then reloads it */
+    ticks = sim_now * APP_JOBS_RTC_CLK_HZ / 1000000;
+    period = (uint64_t)ACS_RTC_CFG->START_VALUE + 1;
+    ACS_RTC_COUNT->VALUE = ACS_RTC_CFG->START_VALUE -
+                           (uint32_t)(ticks % period);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Update(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Account the bytes clocked on the bus and the conversions
+ *                 triggered since the last call, and arm or disarm the ADC
+ *                 sample
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Update(void)
+{
+    uint32_t speed;
+    uint32_t prescale;
+    bool adc;
+
+    if (sim_bytes != sim_bus_bytes)
+    {
+        /* 9 SCL periods per byte, SCL = SYSCLK / (3 * (speed + 1)) */
+        speed = (I2C->CTRL0 & I2C_CTRL0_SPEED_Mask) >> I2C_CTRL0_SPEED_Pos;
+        if (sim_bus_free < sim_now)
+        {
+            sim_bus_free = sim_now;
+        }
+        sim_bus_free += (uint64_t)(sim_bytes - sim_bus_bytes) * 9 * 3 *
+                        (speed + 1) * 1000000 / SystemCoreClock;
+        sim_bus_bytes = sim_bytes;
+    }
+
+    if (sim_slave.one_shots != sim_one_shots)
+    {
+        sim_conv_due = sim_bus_free + SIM_NCT375_CONV_US;
+        sim_one_shots = sim_slave.one_shots;
+    }
+
+    /* A sample every 200 * 2^(prescale - 1) SLOWCLK periods (1 MHz) */
+    adc = ((ADC->CFG & ADC_MODE_Mask) != ADC_DISABLE &&
+           (ADC->BATMON_INT_ENABLE & INT_EBL_ADC) != 0 &&
+           (sim_nvic.enabled & (1U << ADC_BATMON_IRQn)) != 0);
+    if (!adc)
+    {
+        sim_adc_due = 0;
+    }
+    else if (sim_adc_due == 0)
+    {
+        prescale = (ADC->CFG & ADC_PRESCALE_Mask) >> ADC_PRESCALE_Pos;
+        sim_adc_due = sim_now + (200U << (prescale - 1));
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint8_t Sim_Next_Event(uint64_t *time)
+ * ----------------------------------------------------------------------------
+ * Description   : Find the next event raising an interrupt
+ * Inputs        : - time       - Time of the event, in us
+ * Outputs       : return value - Event source (SIM_EVENT_*)
+ * Assumptions   : Sim_Update has been called
+ * ------------------------------------------------------------------------- */
+static uint8_t Sim_Next_Event(uint64_t *time)
+{
+    uint8_t event = SIM_EVENT_NONE;
+
+    *time = UINT64_MAX;
+    if (Sim_I2C_Pending())
+    {
+        *time = (sim_bus_free > sim_now) ? sim_bus_free : sim_now;
+        event = SIM_EVENT_I2C;
+    }
+    if (sim_adc_due != 0 && sim_adc_due < *time)
+    {
+        *time = sim_adc_due;
+        event = SIM_EVENT_ADC;
+    }
+    if (sim_awake_at > sim_now && sim_awake_at < *time)
+    {
+        *time = sim_awake_at;
+        event = SIM_EVENT_BLE;
+    }
+    if (event == SIM_EVENT_NONE && i2c_env.busy &&
+        (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+    {
+        /* Stalled bus: the deadline of the transaction */
+        *time = sim_now + (uint64_t)(SysTick->LOAD + 1) * 1000000 /
+                          SystemCoreClock;
+        event = SIM_EVENT_SYSTICK;
+    }
+
+    return event;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Event_Run(uint8_t event, uint64_t time)
+ * ----------------------------------------------------------------------------
+ * Description   : Advance the clock to an event and call its interrupt
+ *                 handler
+ * Inputs        : - event      - Event source (SIM_EVENT_*)
+ *                 - time       - Time of the event, in us
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Event_Run(uint8_t event, uint64_t time)
+{
+    Sim_Advance(time);
+
+    sim_in_handler = true;
+    switch (event)
+    {
+        case SIM_EVENT_I2C:
+        {
+            Sim_I2C_Step();
+        }
+        break;
+
+        case SIM_EVENT_ADC:
+        {
+            ADC->DATA_TRIM_CH[0] = SIM_VBAT_SAMPLE;
+            ADC->BATMON_STATUS |= ADC_READY_TRUE;
+            sim_adc_due = 0;
+            sim_adc_irqs++;
+            ADC_BATMON_IRQHandler();
+        }
+        break;
+
+        case SIM_EVENT_SYSTICK:
+        {
+            sim_timeouts++;
+            I2C_Timeout_IRQHandler();
+        }
+        break;
+
+        default:
+        {
+            /* Baseband awake: the interrupt only wakes up the core */
+        }
+        break;
+    }
+    sim_in_handler = false;
+
+    Sim_Update();
+}
+
+void Sim_WFI(void)
+{
+    uint64_t time;
+    uint8_t event;
+
+    Sim_Update();
+    event = Sim_Next_Event(&time);
+    SIM_CHECK(event != SIM_EVENT_NONE, "wait for interrupt without any "
+              "event");
+    Sim_Event_Run(event, time);
+}
+
+void Sys_Delay_ProgramROM(uint32_t cycles)
+{
+    uint64_t end = sim_now + (uint64_t)cycles * 1000000 / SystemCoreClock;
+    uint64_t time;
+    uint8_t event;
+
+    /* The interrupts raised during the delay are handled, unless the delay
+     * is made by an interrupt handler */
+    Sim_Update();
+    while (!sim_in_handler)
+    {
+        event = Sim_Next_Event(&time);
+        if (event == SIM_EVENT_NONE || event == SIM_EVENT_BLE || time > end)
+        {
+            break;
+        }
+        Sim_Event_Run(event, time);
+    }
+    Sim_Advance(end);
+}
+
+/* ----------------------------------------------------------------------------
+ * Kernel
+ * ------------------------------------------------------------------------- */
+void Kernel_Init(uint32_t error)
+{
+    struct sim_msg *msg;
+
+    while (sim_msg_head != NULL)
+    {
+        msg = sim_msg_head;
+        sim_msg_head = msg->next;
+        free(msg);
+    }
+    sim_msg_tail = NULL;
+}
+
+void *ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                   ke_task_id_t const src_id, uint16_t const param_len)
+{
+    struct sim_msg *msg = calloc(1, sizeof(struct sim_msg) + param_len);
+
+    SIM_CHECK(msg != NULL, "message allocation");
+    msg->id = id;
+    msg->dest_id = dest_id;
+    msg->src_id = src_id;
+    msg->param_len = param_len;
+
+    return msg->param;
+}
+
+void ke_msg_send(void const *param_ptr)
+{
+    struct sim_msg *msg = (struct sim_msg *)((uint8_t *)param_ptr -
+                                             offsetof(struct sim_msg, param));
+
+    msg->next = NULL;
+    if (sim_msg_tail == NULL)
+    {
+        sim_msg_head = msg;
+    }
+    else
+    {
+        sim_msg_tail->next = msg;
+    }
+    sim_msg_tail = msg;
+}
+
+void ke_msg_free(void const *param_ptr)
+{
+    free((uint8_t *)param_ptr - offsetof(struct sim_msg, param));
+}
+
+uint8_t ke_task_create(uint8_t task_type,
+                       struct ke_task_desc const *p_task_desc)
+{
+    if (task_type == TASK_APP)
+    {
+        sim_task_app = p_task_desc;
+    }
+
+    return 0;
+}
+
+void ke_state_set(ke_task_id_t const id, ke_state_t const state_id)
+{
+    sim_task_state[KE_TYPE_GET(id) % TASK_MAX] = state_id;
+}
+
+ke_state_t ke_state_get(ke_task_id_t const id)
+{
+    return sim_task_state[KE_TYPE_GET(id) % TASK_MAX];
+}
+
+bool ke_sleep_check(void)
+{
+    return (sim_msg_head == NULL);
+}
+
+void *prf_env_get(uint16_t prf_id)
+{
+    return (prf_id == TASK_ID_BASS) ? &sim_bass_env : NULL;
+}
+
+ke_task_id_t prf_src_task_get(prf_env_t *env, uint8_t conidx)
+{
+    return KE_BUILD_ID(env->prf_task, conidx);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Cmp_Evt(uint8_t operation, uint8_t status,
+ *                                         ke_task_id_t dest_id)
+ * ----------------------------------------------------------------------------
+ * Description   : Send a GAPM complete event
+ * Inputs        : - operation  - Operation completed
+ *                 - status     - Completion status
+ *                 - dest_id    - Task of the command
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Cmp_Evt(uint8_t operation, uint8_t status,
+                        ke_task_id_t dest_id)
+{
+    struct gapm_cmp_evt *evt = KE_MSG_ALLOC(GAPM_CMP_EVT, dest_id, TASK_GAPM,
+                                            gapm_cmp_evt);
+
+    evt->operation = operation;
+    evt->status = status;
+    ke_msg_send(evt);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static uint32_t Sim_Adv_Cnt(const uint8_t *data)
+ * ----------------------------------------------------------------------------
+ * Description   : Read the ADV_CNT field of TLM advertising data
+ * Inputs        : - data       - Advertising data
+ * Outputs       : return value - ADV_CNT
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static uint32_t Sim_Adv_Cnt(const uint8_t *data)
+{
+    return ((uint32_t)data[EDDYSTONE_TLM_ADV_CNT_OFFSET] << 24) |
+           ((uint32_t)data[EDDYSTONE_TLM_ADV_CNT_OFFSET + 1] << 16) |
+           ((uint32_t)data[EDDYSTONE_TLM_ADV_CNT_OFFSET + 2] << 8) |
+           data[EDDYSTONE_TLM_ADV_CNT_OFFSET + 3];
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Adv_Update(
+ *                     const struct gapm_update_advertise_data_cmd *cmd)
+ * ----------------------------------------------------------------------------
+ * Description   : Check the advertising data update of a wake-up against
+ *                 the readings of the simulation and count it late if it
+ *                 is made after the advertising event of the wake-up
+ * Inputs        : - cmd        - Update command
+ * Outputs       : None
+ * Assumptions   : Advertising has been started
+ * ------------------------------------------------------------------------- */
+static void Sim_Adv_Update(const struct gapm_update_advertise_data_cmd *cmd)
+{
+    const uint8_t *data = cmd->adv_data;
+    uint16_t vbatt;
+    int16_t temp;
+    uint32_t adv_cnt;
+
+    SIM_CHECK(cmd->adv_data_len == EDDYSTONE_TLM_ADV_DATA_LEN,
+              "advertising data length");
+    vbatt = (data[EDDYSTONE_TLM_VBATT_OFFSET] << 8) |
+            data[EDDYSTONE_TLM_VBATT_OFFSET + 1];
+    temp = (int16_t)((data[EDDYSTONE_TLM_TEMP_OFFSET] << 8) |
+                     data[EDDYSTONE_TLM_TEMP_OFFSET + 1]);
+    adv_cnt = Sim_Adv_Cnt(data);
+
+    if (sim_adv.target != 0)
+    {
+        SIM_CHECK(!sim_adv.updated, "more than one update in the wake-up");
+        SIM_CHECK(adv_cnt == sim_adv.adv_cnt + 1, "ADV_CNT not incremented "
+                  "by one");
+        if (nct375.samples != 0)
+        {
+            SIM_CHECK(temp == NCT375_TEMP_FIXED(sim_slave.reg[0][0],
+                                                sim_slave.reg[0][1]),
+                      "TEMP is not the last conversion");
+        }
+        if (ble_env.batt_lvl != 0)
+        {
+            SIM_CHECK(vbatt == SIM_VBAT_MV, "VBATT is not the battery "
+                      "voltage");
+        }
+        if (sim_now > sim_adv.target)
+        {
+            sim_late++;
+        }
+        sim_adv.updated = true;
+    }
+    sim_adv.adv_cnt = adv_cnt;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Stack(struct sim_msg *msg)
+ * ----------------------------------------------------------------------------
+ * Description   : Answer a message sent to the stack as the GAPM, GATTM
+ *                 and profile tasks do
+ * Inputs        : - msg        - Message
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Stack(struct sim_msg *msg)
+{
+    switch (msg->id)
+    {
+        case GAPM_RESET_CMD:
+        {
+            Sim_Cmp_Evt(GAPM_RESET, GAP_ERR_NO_ERROR, msg->src_id);
+        }
+        break;
+
+        case GAPM_SET_DEV_CONFIG_CMD:
+        {
+            Sim_Cmp_Evt(GAPM_SET_DEV_CONFIG, GAP_ERR_NO_ERROR, msg->src_id);
+        }
+        break;
+
+        case GAPM_PROFILE_TASK_ADD_CMD:
+        {
+            const struct gapm_profile_task_add_cmd *cmd =
+                (const struct gapm_profile_task_add_cmd *)msg->param;
+            struct gapm_profile_added_ind *ind;
+
+            sim_bass_env.prf_env.app_task = cmd->app_task;
+            sim_bass_env.prf_env.prf_task = TASK_BASS;
+            sim_bass_env.start_hdl = sim_next_hdl;
+            sim_bass_env.svc_nb = 1;
+            sim_next_hdl += 8;
+
+            ind = KE_MSG_ALLOC(GAPM_PROFILE_ADDED_IND, msg->src_id, TASK_GAPM,
+                               gapm_profile_added_ind);
+            ind->prf_task_id = cmd->prf_task_id;
+            ind->prf_task_nb = TASK_BASS;
+            ind->start_hdl = sim_bass_env.start_hdl;
+            ke_msg_send(ind);
+            Sim_Cmp_Evt(GAPM_PROFILE_TASK_ADD, GAP_ERR_NO_ERROR, msg->src_id);
+        }
+        break;
+
+        case GATTM_ADD_SVC_REQ:
+        {
+            struct gattm_add_svc_rsp *rsp = KE_MSG_ALLOC(GATTM_ADD_SVC_RSP,
+                                                         msg->src_id,
+                                                         TASK_GATTM,
+                                                         gattm_add_svc_rsp);
+
+            rsp->start_hdl = sim_next_hdl;
+            rsp->status = ATT_ERR_NO_ERROR;
+            sim_next_hdl += 16;
+            ke_msg_send(rsp);
+        }
+        break;
+
+        case GAPM_START_ADVERTISE_CMD:
+        {
+            const struct gapm_start_advertise_cmd *cmd =
+                (const struct gapm_start_advertise_cmd *)msg->param;
+
+            /* First event one interval from now; the wake-up in progress,
+             * if any, is no longer made for an event */
+            sim_adv.active = true;
+            sim_adv.operation = cmd->op.code;
+            sim_adv.interval = (uint32_t)cmd->intv_min * 625;
+            sim_adv.next = sim_now + sim_adv.interval;
+            sim_adv.target = 0;
+            sim_adv.adv_cnt = Sim_Adv_Cnt(cmd->info.host.adv_data);
+        }
+        break;
+
+        case GAPM_UPDATE_ADVERTISE_DATA_CMD:
+        {
+            if (sim_adv.active)
+            {
+                Sim_Adv_Update((const struct gapm_update_advertise_data_cmd *)
+                               msg->param);
+                Sim_Cmp_Evt(GAPM_UPDATE_ADVERTISE_DATA, GAP_ERR_NO_ERROR,
+                            msg->src_id);
+            }
+            else
+            {
+                sim_refused++;
+                Sim_Cmp_Evt(GAPM_UPDATE_ADVERTISE_DATA,
+                            GAP_ERR_COMMAND_DISALLOWED, msg->src_id);
+            }
+        }
+        break;
+
+        case GAPM_CANCEL_CMD:
+        {
+            if (sim_adv.active)
+            {
+                sim_adv.active = false;
+                Sim_Cmp_Evt(sim_adv.operation, GAP_ERR_CANCELED, msg->src_id);
+            }
+            Sim_Cmp_Evt(GAPM_CANCEL, GAP_ERR_NO_ERROR, msg->src_id);
+        }
+        break;
+
+        default:
+        {
+            /* Connection and profile messages: not answered */
+        }
+        break;
+    }
+}
+
+void Kernel_Schedule(void)
+{
+    const struct ke_state_handler *handler;
+    ke_msg_func_t func;
+    struct sim_msg *msg;
+    uint32_t dispatched = 0;
+    uint16_t i;
+    int status;
+
+    while (sim_msg_head != NULL)
+    {
+        SIM_CHECK(++dispatched < SIM_DISPATCH_MAX, "kernel message loop");
+        msg = sim_msg_head;
+        sim_msg_head = msg->next;
+        if (sim_msg_head == NULL)
+        {
+            sim_msg_tail = NULL;
+        }
+        sim_msgs++;
+
+        if (KE_TYPE_GET(msg->dest_id) != TASK_APP)
+        {
+            Sim_Stack(msg);
+            free(msg);
+            continue;
+        }
+
+        /* Handler of the message, else the default handler of the table */
+        SIM_CHECK(sim_task_app != NULL, "application task not created");
+        handler = sim_task_app->default_handler;
+        func = NULL;
+        for (i = 0; i < handler->msg_cnt; i++)
+        {
+            if (handler->msg_table[i].id == msg->id)
+            {
+                func = handler->msg_table[i].func;
+                break;
+            }
+            if (handler->msg_table[i].id == KE_MSG_DEFAULT_HANDLER &&
+                func == NULL)
+            {
+                func = handler->msg_table[i].func;
+            }
+        }
+        status = (func != NULL) ?
+                 func(msg->id, msg->param, msg->dest_id, msg->src_id) :
+                 KE_MSG_CONSUMED;
+        if (status != KE_MSG_NO_FREE)
+        {
+            free(msg);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Stack control and power modes
+ * ------------------------------------------------------------------------- */
+void BLE_InitNoTL(uint8_t error)
+{
+    app_device_param_t param;
+
+    memset(&param, 0, sizeof(param));
+    Device_Param_Prepare(&param);
+}
+
+void BLE_Reset(void)
+{
+    memset(&sim_adv, 0, sizeof(sim_adv));
+}
+
+bool BLE_Is_Awake(void)
+{
+    return (sim_now >= sim_awake_at);
+}
+
+void BLE_Is_Awake_Flag_Set(void)
+{
+}
+
+void BLE_LLD_Sleep_Params_Set(struct lld_sleep_params_t params)
+{
+    sim_twosc = params.twosc;
+}
+
+void BLE_Power_Mode_Enter(void *power_mode_env, uint8_t power_mode)
+{
+    /* The stack only sleeps with no message pending, while advertising */
+    if (!ke_sleep_check() || !sim_adv.active)
+    {
+        SIM_CHECK(++sim_refusals < SIM_REFUSALS_MAX, "sleep never "
+                  "possible");
+        return;
+    }
+    sim_refusals = 0;
+    longjmp(sim_sleep, 1);
+}
+
+uint8_t Device_Param_Read(uint8_t param_id, uint8_t *buf)
+{
+    /* No parameter in NVR3 */
+    return 1;
+}
+
+void LowPowerClock_Source_Set(uint8_t source)
+{
+}
+
+void RTCCLK_Period_Value_Set(float period)
+{
+}
+
+void Sys_PowerModes_Sleep_Init(struct sleep_mode_init_env_tag *init_env)
+{
+}
+
+void Sys_PowerModes_Wakeup(void)
+{
+}
+
+void Wakeup_From_Sleep_Application_asm(void)
+{
+    Wakeup_From_Sleep_Application();
+}
+
+/* ----------------------------------------------------------------------------
+ * Flash of the key/value store
+ * ------------------------------------------------------------------------- */
+uint32_t Flash_KV_Port_Read(uint32_t offset)
+{
+    uint32_t word;
+
+    memcpy(&word, &sim_kv_flash[offset], sizeof(word));
+    return word;
+}
+
+bool Flash_KV_Port_Write(uint32_t offset, uint32_t word0, uint32_t word1)
+{
+    uint32_t words[2] = { word0, word1 };
+    uint8_t *data = (uint8_t *)words;
+    uint8_t i;
+
+    /* Programming only clears bits */
+    for (i = 0; i < FLASH_KV_UNIT; i++)
+    {
+        sim_kv_flash[offset + i] &= data[i];
+    }
+    sim_flash_writes++;
+    Sim_Advance(sim_now + SIM_FLASH_WRITE_US);
+
+    return true;
+}
+
+bool Flash_KV_Port_Erase(uint8_t page)
+{
+    memset(&sim_kv_flash[page * FLASH_KV_PAGE_SIZE], 0xFF, FLASH_KV_PAGE_SIZE);
+    sim_flash_erases++;
+    Sim_Advance(sim_now + SIM_FLASH_ERASE_US);
+
+    return true;
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Window_End(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Check the wake window that ended with the sleep request,
+ *                 add its work to the windows of its set of jobs and
+ *                 account its advertising event
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The window was started with sim_window_count and
+ *                 sim_window_start
+ * ------------------------------------------------------------------------- */
+static void Sim_Window_End(void)
+{
+    struct sim_window_tag *window = &sim_window[app_env.jobs_due];
+    uint32_t count[SIM_CNT_NB];
+    uint32_t time = (uint32_t)(sim_now - sim_window_start);
+    uint8_t i;
+
+    Sim_Counters(count);
+    window->wakes++;
+    window->time_sum += time;
+    if (time > window->time_max)
+    {
+        window->time_max = time;
+    }
+    for (i = 0; i < SIM_CNT_NB; i++)
+    {
+        window->count[i] += count[i] - sim_window_count[i];
+    }
+
+    if (sim_adv.target != 0)
+    {
+        SIM_CHECK(sim_adv.updated, "no advertising data update");
+        SIM_CHECK(app_jobs_stats.late - sim_late_start ==
+                  count[SIM_CNT_LATE] - sim_window_count[SIM_CNT_LATE],
+                  "late commits counted by the application differ");
+
+        /* Event of the wake-up, then the events missed by the window */
+        sim_adv.events++;
+        sim_adv.next = sim_adv.target + sim_adv.interval;
+        while (sim_adv.next <= sim_now)
+        {
+            sim_adv.next += sim_adv.interval;
+            sim_adv.events++;
+            sim_adv.skipped++;
+        }
+    }
+    SIM_CHECK(i2c_env.error_count == 0, "I2C transaction failed");
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Window_Begin(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Sleep until the baseband wake-up before the next
+ *                 advertising event and start a wake window
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : Advertising has been started
+ * ------------------------------------------------------------------------- */
+static void Sim_Window_Begin(void)
+{
+    uint64_t wake;
+
+    wake = (sim_adv.next > sim_twosc) ? sim_adv.next - sim_twosc : 0;
+    if (wake < sim_now)
+    {
+        sim_overruns++;
+        wake = sim_now;
+    }
+    Sim_Advance(wake);
+
+    sim_awake_at = sim_now + TWOSC;
+    sim_adv.target = sim_adv.next;
+    sim_adv.updated = false;
+    sim_window_start = sim_now;
+    sim_late_start = app_jobs_stats.late;
+    Sim_Counters(sim_window_count);
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Jobs_Name(uint8_t due, char *name,
+ *                                           size_t size)
+ * ----------------------------------------------------------------------------
+ * Description   : Names of a set of periodic jobs
+ * Inputs        : - due        - Due job mask (app_env.jobs_due)
+ *                 - name       - Buffer of the names
+ *                 - size       - Size of the buffer
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Jobs_Name(uint8_t due, char *name, size_t size)
+{
+    static const struct
+    {
+        void (*start)(void);
+        const char *name;
+    } jobs[] =
+    {
+        { Sensor_Job, "sensor" },
+        { Battery_Measure_Start, "batt" },
+        { RC_Calibration_Job, "rc" },
+        { Notification_Job, "ntf" },
+        { Alarm_Process, "alarm" },
+        { Advertising_Job, "adv" },
+#if (HISTORY_ENABLE)
+        { History_Job, "hist" },
+#endif
+        { Retained_State_Persist, "persist" }
+    };
+    size_t length = 0;
+    uint8_t i;
+    uint8_t j;
+
+    name[0] = '\0';
+    for (i = 0; i < app_jobs.nb; i++)
+    {
+        if (!(due & (1U << i)))
+        {
+            continue;
+        }
+        for (j = 0; j < sizeof(jobs) / sizeof(jobs[0]); j++)
+        {
+            if (app_jobs.jobs[i].start == jobs[j].start)
+            {
+                length += snprintf(&name[length], size - length, "%s%s",
+                                   (length != 0) ? "+" : "", jobs[j].name);
+                break;
+            }
+        }
+        if (length >= size)
+        {
+            break;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Boot(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Run the application from reset to its first sleep
+ *                 request
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : None
+ * ------------------------------------------------------------------------- */
+static void Sim_Boot(void)
+{
+    if (setjmp(sim_sleep) == 0)
+    {
+        App_Main();
+    }
+}
+
+/* ----------------------------------------------------------------------------
+ * Function      : static void Sim_Wake(void)
+ * ----------------------------------------------------------------------------
+ * Description   : Run one wake cycle, from the baseband wake-up to the sleep
+ *                 request
+ * Inputs        : None
+ * Outputs       : None
+ * Assumptions   : The application has reached its first sleep request
+ * ------------------------------------------------------------------------- */
+static void Sim_Wake(void)
+{
+    Sim_Window_Begin();
+    if (setjmp(sim_sleep) == 0)
+    {
+        Wakeup_From_Sleep_Application_asm();
+    }
+    Sim_Window_End();
+}
+
+int main(int argc, char *argv[])
+{
+    struct timespec start;
+    struct timespec end;
+    uint32_t wakes = 10000;
+    uint32_t wake;
+    uint32_t total = 0;
+    double host;
+    char name[64];
+    uint16_t due;
+    uint8_t i;
+
+    if (argc > 1)
+    {
+        wakes = strtoul(argv[1], NULL, 0);
+    }
+
+    /* Supplies and oscillators ready, recovery DIO high, erased flash */
+    sim_test = "boot";
+    ACS_VDDRF_CTRL->READY_ALIAS = VDDRF_READY_BITBAND;
+    RF_REG39->ANALOG_INFO_CLK_DIG_READY_ALIAS =
+        ANALOG_INFO_CLK_DIG_READY_BITBAND;
+    ACS_XTAL32K_CTRL->READY_ALIAS = XTAL32K_OK_BITBAND;
+    DIO_DATA->ALIAS[RECOVERY_DIO] = 1;
+    I2C->DATA = 0xFFFFFFFF;
+    memset(sim_kv_flash, 0xFF, sizeof(sim_kv_flash));
+
+    /* NCT375 power-on reading */
+    sim_slave.reg[0][0] = (uint8_t)((SIM_TEMP_START << 4) >> 8);
+    sim_slave.reg[0][1] = (uint8_t)(SIM_TEMP_START << 4);
+
+    /* Reset until the first sleep request */
+    Sim_Boot();
+    SIM_CHECK(sim_adv.active, "advertising not started");
+    SIM_CHECK(i2c_env.error_count == 0, "I2C transaction failed");
+
+    sim_test = "wake cycle";
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (wake = 0; wake < wakes; wake++)
+    {
+        Sim_Wake();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    host = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("wake_sim: %u wake cycles, %.1f s simulated, %.3f s host "
+           "(%.0f wake cycles/s)\n", wakes, sim_now / 1e6, host,
+           (host > 0) ? wakes / host : 0.0);
+    printf("\nper wake cycle, by jobs run (window in us, work as mean "
+           "count)\n");
+    printf("%-28s %7s %7s %7s", "jobs", "wakes", "window", "max");
+    for (i = 0; i < SIM_CNT_NB; i++)
+    {
+        printf(" %6s", sim_count_name[i]);
+    }
+    printf("\n");
+    for (due = 0; due < (1U << JOB_SCHEDULE_MAX); due++)
+    {
+        struct sim_window_tag *window = &sim_window[due];
+
+        if (window->wakes == 0)
+        {
+            continue;
+        }
+        total += window->wakes;
+        Sim_Jobs_Name((uint8_t)due, name, sizeof(name));
+        printf("%-28s %7u %7.0f %7u", name, window->wakes,
+               (double)window->time_sum / window->wakes, window->time_max);
+        for (i = 0; i < SIM_CNT_NB; i++)
+        {
+            printf(" %6.2f", (double)window->count[i] / window->wakes);
+        }
+        printf("\n");
+    }
+
+    printf("\nadvertising events %u (%u without a wake-up), late updates "
+           "%u, wake-up overruns %u\n", sim_adv.events, sim_adv.skipped,
+           app_jobs_stats.late, sim_overruns);
+    printf("wake-up lead %u us, longest sensor job %u us, updates refused "
+           "before advertising %u\n", app_jobs_stats.lead,
+           app_jobs_stats.sensor_max, sim_refused);
+    printf("NCT375 one-shots %u, conversions %u; flash writes %u, erases "
+           "%u\n", sim_one_shots, sim_conversions, sim_flash_writes,
+           sim_flash_erases);
+    SIM_CHECK(total == wakes, "wake cycles lost");
+    printf("wake_sim: %u checks passed\n", sim_checks);
+
+    return 0;
+}